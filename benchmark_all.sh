@@ -5,6 +5,13 @@ GENOME_DIR="./genomes"
 BENCH_EXEC="./g_benchmark"
 OUTPUT_FILE="result_benchmarking.txt"
 
+# === Mesure du pic mémoire : "time -l" (macOS) ou "time -v" (GNU/Linux) ===
+if [ "$(uname)" = "Darwin" ]; then
+  TIME_CMD="/usr/bin/time -l"
+else
+  TIME_CMD="/usr/bin/time -v"
+fi
+
 # === Vider ou créer le fichier de sortie ===
 echo "== Résultats du benchmarking ==" > "$OUTPUT_FILE"
 echo "Date : $(date)" >> "$OUTPUT_FILE"
@@ -20,7 +27,7 @@ for genome in "$GENOME_DIR"/*.fasta; do
   echo "-----------------------------" >> "$OUTPUT_FILE"
 
   # Exécution avec redirection standard sortie et erreur
-  /usr/bin/time -l "$BENCH_EXEC" "$genome" >> "$OUTPUT_FILE" 2>&1
+  $TIME_CMD "$BENCH_EXEC" "$genome" >> "$OUTPUT_FILE" 2>&1
 
   echo "" >> "$OUTPUT_FILE"
 done
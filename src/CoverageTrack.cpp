@@ -0,0 +1,133 @@
+/**
+ * @file CoverageTrack.cpp
+ * @brief Implémentation des pistes de couverture calculées en flux.
+ */
+
+#include "CoverageTrack.hpp"
+#include <algorithm>
+#include <iostream>
+#include <utility>
+
+CoverageTrack::CoverageTrack(std::vector<Contig> contigs, std::size_t binWidth)
+    : contigs(std::move(contigs)), binWidth(std::max<std::size_t>(binWidth, 1)) {
+    if (this->contigs.empty()) {
+        // Longueur inconnue : la séquence s'étend jusqu'à la fin du dernier read
+        Contig genome;
+        genome.name = "genome";
+        this->contigs.push_back(genome);
+    } else {
+        const Contig& last = this->contigs.back();
+        referenceEnd = static_cast<std::int64_t>(last.start + last.length);
+    }
+    for (Contig& current : this->contigs) {
+        // Nom de piste : premier mot de l'en-tête FASTA (les champs du bedGraph sont séparés par des blancs)
+        current.name = current.name.substr(0, current.name.find_first_of(" \t"));
+    }
+    while (contig + 1 < this->contigs.size() && this->contigs[contig].length == 0) ++contig;
+    binStart = position = static_cast<std::int64_t>(this->contigs[contig].start);
+}
+
+bool CoverageTrack::open(const std::string& bedgraphPath, const std::string& binsPath) {
+    bedgraph.open(bedgraphPath);
+    if (!bedgraph.is_open()) {
+        std::cerr << "Error: Cannot open output file " << bedgraphPath << "\n";
+        return false;
+    }
+    bins.open(binsPath);
+    if (!bins.is_open()) {
+        std::cerr << "Error: Cannot open output file " << binsPath << "\n";
+        return false;
+    }
+    bedgraph << "track type=bedGraph name=\"coverage\"\n";
+    bins << "contig,bin_start,bin_end,mean_depth,covered_bases\n";
+    return true;
+}
+
+void CoverageTrack::add(std::int64_t start, std::int64_t end) {
+    if (referenceEnd == 0) {
+        Contig& genome = contigs.back();
+        genome.length = std::max<std::size_t>(genome.length, static_cast<std::size_t>(std::max<std::int64_t>(end, 0)));
+    } else {
+        end = std::min(end, referenceEnd); // read qui déborde de la fin de la référence
+    }
+    start = std::max(start, position);
+    if (end <= start) return;
+    advanceTo(start);
+    ends.push(end);
+}
+
+void CoverageTrack::advanceTo(std::int64_t target) {
+    while (!ends.empty() && ends.top() <= target) {
+        emitSegment(ends.top());
+        ends.pop();
+    }
+    emitSegment(target);
+}
+
+void CoverageTrack::emitSegment(std::int64_t end) {
+    const std::size_t depth = ends.size();
+    while (position < end && contig < contigs.size()) {
+        const Contig& current = contigs[contig];
+        const std::int64_t contigEnd = static_cast<std::int64_t>(current.start + current.length);
+        const std::int64_t binEnd = std::min(binStart + static_cast<std::int64_t>(binWidth), contigEnd);
+        const std::int64_t pieceEnd = std::min(end, binEnd);
+        const std::uint64_t bases = static_cast<std::uint64_t>(pieceEnd - position);
+
+        binDepth += depth * bases;
+        if (depth > 0) {
+            binCovered += bases;
+            if (depth != pendingDepth || pendingEnd != position) {
+                flushBedgraph();
+                pendingStart = position;
+                pendingDepth = depth;
+            }
+            pendingEnd = pieceEnd;
+        }
+        position = pieceEnd;
+
+        if (position == binEnd) {
+            flushBin();
+        }
+        if (position == contigEnd) {
+            // Les segments et les fenêtres ne franchissent pas la frontière entre deux séquences
+            flushBedgraph();
+            do {
+                ++contig;
+            } while (contig < contigs.size() && contigs[contig].length == 0);
+            binStart = position;
+        }
+    }
+}
+
+void CoverageTrack::flushBedgraph() {
+    if (pendingDepth == 0) return;
+    const Contig& current = contigs[contig];
+    bedgraph << current.name << "\t" << (pendingStart - static_cast<std::int64_t>(current.start)) << "\t"
+             << (pendingEnd - static_cast<std::int64_t>(current.start)) << "\t" << pendingDepth << "\n";
+    pendingDepth = 0;
+}
+
+void CoverageTrack::flushBin() {
+    const Contig& current = contigs[contig];
+    const std::int64_t width = position - binStart;
+    bins << current.name << "," << (binStart - static_cast<std::int64_t>(current.start)) << ","
+         << (position - static_cast<std::int64_t>(current.start)) << ","
+         << (width > 0 ? static_cast<double>(binDepth) / static_cast<double>(width) : 0.0) << ","
+         << binCovered << "\n";
+    binStart = position;
+    binDepth = 0;
+    binCovered = 0;
+}
+
+bool CoverageTrack::finish() {
+    const Contig& last = contigs.back();
+    advanceTo(static_cast<std::int64_t>(last.start + last.length));
+    flushBedgraph();
+    bedgraph.close();
+    bins.close();
+    if (bedgraph.fail() || bins.fail()) {
+        std::cerr << "Error: Cannot write coverage tracks.\n";
+        return false;
+    }
+    return true;
+}
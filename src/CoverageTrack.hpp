@@ -0,0 +1,96 @@
+/**
+ * @file CoverageTrack.hpp
+ * @brief Déclaration du calcul en flux de la profondeur de couverture (bedGraph et fenêtres fixes).
+ */
+
+#ifndef COVERAGETRACK_HPP
+#define COVERAGETRACK_HPP
+
+#include "KmerIndex.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <functional>
+#include <queue>
+#include <string>
+#include <vector>
+
+/**
+ * @class CoverageTrack
+ * @brief Profondeur par base et couverture par fenêtre, calculées en une passe sur des reads triés par position.
+ *
+ * Les intervalles des reads doivent arriver par début croissant (sortie d'un tri par position). Seules les fins
+ * des reads qui chevauchent la position courante sont gardées en mémoire. Les positions sont celles du texte
+ * concaténé de la référence ; les pistes sont écrites par séquence de référence (premier mot de son en-tête),
+ * en coordonnées locales :
+ * - bedGraph : segments de profondeur constante non nulle (début inclus, fin exclue, base 0) ;
+ * - CSV : profondeur moyenne et bases couvertes par fenêtre de binWidth bases, fenêtres vides comprises.
+ */
+class CoverageTrack {
+public:
+    /**
+     * @brief Constructeur
+     * @param contigs Séquences de la référence, dans l'ordre du texte (vide = une seule séquence "genome")
+     * @param binWidth Largeur des fenêtres de couverture en bases
+     */
+    CoverageTrack(std::vector<Contig> contigs, std::size_t binWidth);
+
+    /**
+     * @brief Ouvre les deux fichiers de sortie
+     * @param bedgraphPath Profondeur par base (bedGraph)
+     * @param binsPath Couverture par fenêtre (CSV)
+     * @return false si un fichier ne peut pas être créé
+     */
+    bool open(const std::string& bedgraphPath, const std::string& binsPath);
+
+    /**
+     * @brief Ajoute l'intervalle d'un read
+     * @param start Première position couverte (non décroissante d'un appel à l'autre)
+     * @param end Position qui suit la dernière couverte
+     */
+    void add(std::int64_t start, std::int64_t end);
+
+    /**
+     * @brief Termine les pistes jusqu'à la fin de la référence et ferme les fichiers
+     * @return false si une écriture a échoué
+     */
+    bool finish();
+
+private:
+    /**
+     * @brief Avance la position courante jusqu'à position en retirant les reads terminés
+     */
+    void advanceTo(std::int64_t position);
+
+    /**
+     * @brief Comptabilise le segment [position courante, end) à la profondeur courante
+     */
+    void emitSegment(std::int64_t end);
+
+    /**
+     * @brief Écrit le segment bedGraph en attente (s'il est couvert)
+     */
+    void flushBedgraph();
+
+    /**
+     * @brief Écrit la fenêtre courante et passe à la suivante
+     */
+    void flushBin();
+
+    std::vector<Contig> contigs;    /**< Séquences de la référence */
+    std::size_t binWidth;           /**< Largeur des fenêtres */
+    std::int64_t referenceEnd = 0;  /**< Fin du texte de la référence (0 = inconnue, déduite des reads) */
+    std::ofstream bedgraph;         /**< Sortie bedGraph */
+    std::ofstream bins;             /**< Sortie des fenêtres */
+    std::priority_queue<std::int64_t, std::vector<std::int64_t>, std::greater<std::int64_t>> ends; /**< Fins des reads en cours */
+    std::int64_t position = 0;      /**< Début du prochain segment */
+    std::size_t contig = 0;         /**< Séquence de la position courante */
+    std::int64_t binStart = 0;      /**< Début (global) de la fenêtre courante */
+    std::uint64_t binDepth = 0;     /**< Somme des profondeurs de la fenêtre courante */
+    std::uint64_t binCovered = 0;   /**< Bases couvertes de la fenêtre courante */
+    std::int64_t pendingStart = 0;  /**< Segment bedGraph en attente : début (global) */
+    std::int64_t pendingEnd = 0;    /**< Segment bedGraph en attente : fin (global) */
+    std::size_t pendingDepth = 0;   /**< Segment bedGraph en attente : profondeur */
+};
+
+#endif
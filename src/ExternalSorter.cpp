@@ -0,0 +1,195 @@
+/**
+ * @file ExternalSorter.cpp
+ * @brief Implémentation du tri externe : séries triées sur disque puis fusion k voies.
+ */
+
+#include "ExternalSorter.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <utility>
+
+namespace {
+
+/**
+ * @brief Lecture séquentielle d'une série : (clé, rang, valeur, longueur, texte) par ligne
+ */
+struct RunReader {
+    std::ifstream in;
+    std::int64_t key = 0;
+    std::uint64_t order = 0;
+    std::int64_t value = 0;
+    std::string row;
+
+    explicit RunReader(const std::string& path) : in(path, std::ios::binary) {}
+
+    /**
+     * @brief Lit la ligne suivante ; false en fin de série
+     */
+    bool next() {
+        std::uint32_t length = 0;
+        if (!in.read(reinterpret_cast<char*>(&key), sizeof(key))) return false;
+        in.read(reinterpret_cast<char*>(&order), sizeof(order));
+        in.read(reinterpret_cast<char*>(&value), sizeof(value));
+        in.read(reinterpret_cast<char*>(&length), sizeof(length));
+        row.resize(length);
+        return length == 0 ? static_cast<bool>(in) : static_cast<bool>(in.read(&row[0], length));
+    }
+};
+
+/**
+ * @brief Écrit une ligne dans une série
+ */
+void writeRecord(std::ofstream& out, std::int64_t key, std::uint64_t order, std::int64_t value,
+                 const char* row, std::uint32_t length) {
+    out.write(reinterpret_cast<const char*>(&key), sizeof(key));
+    out.write(reinterpret_cast<const char*>(&order), sizeof(order));
+    out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    out.write(reinterpret_cast<const char*>(&length), sizeof(length));
+    out.write(row, length);
+}
+
+} // namespace
+
+ExternalSorter::ExternalSorter(std::string tempPrefix, std::size_t memoryBytes)
+    : tempPrefix(std::move(tempPrefix)), memoryBytes(memoryBytes) {}
+
+ExternalSorter::~ExternalSorter() {
+    for (const auto& path : runs) {
+        std::remove(path.c_str());
+    }
+}
+
+bool ExternalSorter::add(std::int64_t key, std::int64_t value, const std::string& row) {
+    pending.push_back(Entry{key, added++, value, text.size(), static_cast<std::uint32_t>(row.size())});
+    text += row;
+    if (text.size() + pending.size() * sizeof(Entry) >= memoryBytes) {
+        return spill();
+    }
+    return true;
+}
+
+void ExternalSorter::sortPending() {
+    // Les rangs d'ajout croissent dans le tampon : un tri stable sur la clé suffit
+    std::stable_sort(pending.begin(), pending.end(), [](const Entry& a, const Entry& b) { return a.key < b.key; });
+}
+
+std::string ExternalSorter::nextRunPath() {
+    return tempPrefix + ".run" + std::to_string(runsWritten++) + ".tmp";
+}
+
+bool ExternalSorter::spill() {
+    if (pending.empty()) return true;
+    sortPending();
+    std::string path = nextRunPath();
+    std::ofstream out(path, std::ios::binary);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot create temporary sort file " << path << "\n";
+        return false;
+    }
+    runs.push_back(path);
+    for (const Entry& entry : pending) {
+        writeRecord(out, entry.key, entry.order, entry.value, text.data() + entry.offset, entry.length);
+    }
+    if (!out.flush()) {
+        std::cerr << "Error: Cannot write temporary sort file " << path << "\n";
+        return false;
+    }
+    pending.clear();
+    text.clear();
+    return true;
+}
+
+bool ExternalSorter::mergeRuns(const std::vector<std::string>& files,
+                               const std::function<bool(std::int64_t, std::uint64_t, std::int64_t,
+                                                        const std::string&)>& emit) {
+    std::vector<std::unique_ptr<RunReader>> readers;
+    for (const auto& path : files) {
+        readers.push_back(std::make_unique<RunReader>(path));
+        if (!readers.back()->in.is_open()) {
+            std::cerr << "Error: Cannot read temporary sort file " << path << "\n";
+            return false;
+        }
+    }
+
+    // Tas des séries par (clé, rang) de leur ligne courante
+    auto later = [&readers](std::size_t a, std::size_t b) {
+        const RunReader& x = *readers[a];
+        const RunReader& y = *readers[b];
+        return x.key != y.key ? x.key > y.key : x.order > y.order;
+    };
+    std::priority_queue<std::size_t, std::vector<std::size_t>, decltype(later)> heads(later);
+    for (std::size_t i = 0; i < readers.size(); ++i) {
+        if (readers[i]->next()) heads.push(i);
+    }
+    while (!heads.empty()) {
+        std::size_t i = heads.top();
+        heads.pop();
+        RunReader& reader = *readers[i];
+        if (!emit(reader.key, reader.order, reader.value, reader.row)) return false;
+        if (reader.next()) heads.push(i);
+    }
+    return true;
+}
+
+bool ExternalSorter::merge(const Emit& emit) {
+    bool ok = true;
+    if (runs.empty()) {
+        // Tout tient en mémoire : pas de fichier temporaire
+        sortPending();
+        std::string row;
+        for (const Entry& entry : pending) {
+            row.assign(text, entry.offset, entry.length);
+            if (!emit(entry.key, entry.value, row)) {
+                ok = false;
+                break;
+            }
+        }
+        pending.clear();
+        text.clear();
+        return ok;
+    }
+    if (!spill()) return false;
+
+    // Passes intermédiaires tant qu'il y a trop de séries pour les ouvrir toutes
+    while (ok && runs.size() > MAX_FAN_IN) {
+        std::vector<std::string> group(runs.begin(), runs.begin() + MAX_FAN_IN);
+        std::string path = nextRunPath();
+        std::ofstream out(path, std::ios::binary);
+        if (!out.is_open()) {
+            std::cerr << "Error: Cannot create temporary sort file " << path << "\n";
+            return false;
+        }
+        runs.erase(runs.begin(), runs.begin() + MAX_FAN_IN);
+        runs.push_back(path);
+        ok = mergeRuns(group, [&out](std::int64_t key, std::uint64_t order, std::int64_t value, const std::string& row) {
+            writeRecord(out, key, order, value, row.data(), static_cast<std::uint32_t>(row.size()));
+            return static_cast<bool>(out);
+        });
+        for (const auto& file : group) {
+            std::remove(file.c_str());
+        }
+        if (ok && !out.flush()) {
+            std::cerr << "Error: Cannot write temporary sort file " << path << "\n";
+            ok = false;
+        }
+    }
+
+    if (ok) {
+        ok = mergeRuns(runs, [&emit](std::int64_t key, std::uint64_t, std::int64_t value, const std::string& row) {
+            return emit(key, value, row);
+        });
+    }
+    for (const auto& path : runs) {
+        std::remove(path.c_str());
+    }
+    runs.clear();
+    return ok;
+}
+
+std::size_t ExternalSorter::runCount() const {
+    return runsWritten;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file ExternalSorter.hpp
+ * @brief Déclaration du tri externe de lignes de texte par clé, sous un plafond mémoire.
+ */
+
+#ifndef EXTERNALSORTER_HPP
+#define EXTERNALSORTER_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @class ExternalSorter
+ * @brief Trie des lignes par clé entière sans les garder toutes en mémoire.
+ *
+ * Les lignes ajoutées sont accumulées jusqu'au plafond mémoire, triées puis écrites dans un fichier temporaire
+ * (une « série »). merge fusionne ensuite les séries (k voies, au plus MAX_FAN_IN fichiers ouverts à la fois)
+ * et rend les lignes dans l'ordre des clés. Le tri est stable : à clé égale, l'ordre d'ajout est conservé.
+ * Chaque ligne porte une valeur entière libre, rendue avec elle. Si tout tient en mémoire, aucun fichier
+ * n'est écrit.
+ */
+class ExternalSorter {
+public:
+    /**
+     * @brief Fonction appelée pour chaque ligne, dans l'ordre : clé, valeur associée, ligne
+     */
+    using Emit = std::function<bool(std::int64_t key, std::int64_t value, const std::string& row)>;
+
+    static constexpr std::size_t MAX_FAN_IN = 64; /**< Séries fusionnées en une passe */
+
+    /**
+     * @brief Constructeur
+     * @param tempPrefix Préfixe des fichiers temporaires (ex. "results/mapping_results.csv")
+     * @param memoryBytes Mémoire maximale des lignes en attente (clés, valeurs et texte)
+     */
+    ExternalSorter(std::string tempPrefix, std::size_t memoryBytes);
+
+    /**
+     * @brief Supprime les fichiers temporaires restants
+     */
+    ~ExternalSorter();
+
+    ExternalSorter(const ExternalSorter&) = delete;
+    ExternalSorter& operator=(const ExternalSorter&) = delete;
+
+    /**
+     * @brief Ajoute une ligne ; écrit une série sur disque quand le plafond est atteint
+     * @return false si la série n'a pas pu être écrite
+     */
+    bool add(std::int64_t key, std::int64_t value, const std::string& row);
+
+    /**
+     * @brief Rend toutes les lignes triées, puis vide le trieur
+     * @param emit Appelée pour chaque ligne ; false interrompt la fusion
+     * @return false si une série est illisible ou si emit a renvoyé false
+     */
+    bool merge(const Emit& emit);
+
+    /**
+     * @brief Nombre de séries écrites sur disque (fusions intermédiaires comprises)
+     */
+    std::size_t runCount() const;
+
+private:
+    /**
+     * @struct Entry
+     * @brief Ligne en attente : clé, rang d'ajout et emplacement du texte dans le tampon.
+     */
+    struct Entry {
+        std::int64_t key;
+        std::uint64_t order;
+        std::int64_t value;
+        std::size_t offset;
+        std::uint32_t length;
+    };
+
+    /**
+     * @brief Trie les lignes en attente (clé puis rang d'ajout)
+     */
+    void sortPending();
+
+    /**
+     * @brief Trie les lignes en attente et les écrit dans une nouvelle série
+     */
+    bool spill();
+
+    /**
+     * @brief Fusionne des séries en appelant emit pour chaque ligne (clé, rang, valeur, texte)
+     */
+    bool mergeRuns(const std::vector<std::string>& files,
+                   const std::function<bool(std::int64_t, std::uint64_t, std::int64_t, const std::string&)>& emit);
+
+    /**
+     * @brief Chemin de la prochaine série
+     */
+    std::string nextRunPath();
+
+    std::string tempPrefix;          /**< Préfixe des fichiers temporaires */
+    std::size_t memoryBytes;         /**< Plafond mémoire des lignes en attente */
+    std::vector<Entry> pending;      /**< Lignes en attente */
+    std::string text;                /**< Texte des lignes en attente, bout à bout */
+    std::vector<std::string> runs;   /**< Séries sur disque, non encore fusionnées */
+    std::uint64_t added = 0;         /**< Lignes ajoutées (rang de la prochaine) */
+    std::size_t runsWritten = 0;     /**< Séries écrites depuis la construction */
+};
+
+#endif
@@ -0,0 +1,143 @@
+/**
+ * @file IndexCommand.cpp
+ * @brief Implémentation de la sous-commande "index".
+ */
+
+#include "IndexCommand.hpp"
+#include "IndexPlanner.hpp"
+#include "Mapper.hpp"
+#include "Options.hpp"
+#include "ReadFasta.hpp"
+#include <iostream>
+#include <string>
+
+namespace {
+
+/**
+ * @brief Charge un index enregistré (base et couche delta)
+ */
+bool loadIndexFile(const std::string& path, KmerIndex& index) {
+    if (!Mapper::isIndexFile(path)) {
+        std::cerr << "Error: " << path << " is not an index file (expected .kidx).\n";
+        return false;
+    }
+    return index.load(path);
+}
+
+/**
+ * @brief Affiche l'état d'un index : organisation, séquences et mises à jour en attente
+ */
+void printIndexInfo(const KmerIndex& index) {
+    std::cout << "k : " << index.getK() << "\n"
+              << "Organisation : " << index.getLayout().name() << "\n"
+              << "k-mers distincts : " << index.distinctKmers() << "\n"
+              << "Mémoire : " << formatBytes(index.memoryUsage()) << "\n"
+              << "Mises à jour en attente : " << (index.hasPendingUpdates() ? "oui" : "non") << "\n"
+              << "Séquences :\n";
+    for (const Contig& contig : index.getContigs()) {
+        std::cout << "  " << contig.name << " (début " << contig.start << ", longueur " << contig.length << ")"
+                  << (contig.removed ? " [retirée]" : "") << "\n";
+    }
+}
+
+int buildIndex(int argc, char* argv[]) {
+    if (argc != 6 && argc != 8) {
+        printUsage(std::cerr, argv[0]);
+        return 1;
+    }
+    const std::string reference = argv[3];
+    const std::string output = argv[5];
+    int k = 0;
+    try {
+        k = std::stoi(argv[4]);
+    } catch (const std::exception&) {
+        k = 0;
+    }
+    if (k <= 0 || k > KmerIndex::MAX_K) {
+        std::cerr << "Error: k-mer size must be between 1 and " << KmerIndex::MAX_K << ".\n";
+        return 1;
+    }
+    std::size_t maxIndexBytes = 0;
+    IndexLayout layout;
+    if (argc == 8) {
+        const std::string option = argv[6];
+        const bool valid = option == "--max-index-mem"
+                               ? parseByteSize(argv[7], maxIndexBytes) && maxIndexBytes > 0
+                               : option == "--index-layout" && IndexLayout::parse(argv[7], layout);
+        if (!valid) {
+            std::cerr << "Error: Invalid option " << argv[6] << " " << argv[7] << "\n";
+            return 1;
+        }
+    }
+    if (!Mapper::isIndexFile(output)) {
+        std::cerr << "Error: Output index must have the .kidx extension.\n";
+        return 1;
+    }
+
+    Mapper mapper(k);
+    mapper.getGenomeIndex().setLayout(layout);
+    if (!mapper.loadReference(reference, maxIndexBytes)) return 1;
+    if (!mapper.getGenomeIndex().save(output)) return 1;
+    std::cout << "Index enregistré dans : " << output << "\n";
+    return 0;
+}
+
+int appendToIndex(const std::string& path, const std::string& fasta) {
+    KmerIndex index(0);
+    if (!loadIndexFile(path, index)) return 1;
+
+    ReadFasta fastaReader(fasta);
+    fastaReader.load();
+    if (fastaReader.getSequences().empty()) {
+        std::cerr << "Error: No valid sequence in " << fasta << "\n";
+        return 1;
+    }
+    for (const auto& seq : fastaReader.getSequences()) {
+        if (!index.appendSequence(seq.getId(), seq.getSequence())) return 1;
+        std::cout << "Séquence ajoutée : " << seq.getId() << " (" << seq.getSequence().size() << " pb)\n";
+    }
+    return index.saveDelta(path) ? 0 : 1;
+}
+
+} // namespace
+
+int runIndexCommand(int argc, char* argv[]) {
+    const std::string action = argc > 2 ? argv[2] : "";
+    if (action == "build") {
+        return buildIndex(argc, argv);
+    }
+    if (argc < 4 || (action != "append" && action != "remove" && action != "compact" && action != "info") ||
+        (action == "append" && argc != 5) || ((action == "compact" || action == "info") && argc != 4)) {
+        printUsage(std::cerr, argv[0]);
+        return 1;
+    }
+
+    const std::string path = argv[3];
+    if (action == "append") {
+        return appendToIndex(path, argv[4]);
+    }
+
+    KmerIndex index(0);
+    if (!loadIndexFile(path, index)) return 1;
+
+    if (action == "remove") {
+        for (int i = 4; i < argc; ++i) {
+            if (!index.removeSequence(argv[i])) return 1;
+            std::cout << "Séquence retirée : " << argv[i] << "\n";
+        }
+        return index.saveDelta(path) ? 0 : 1;
+    }
+    if (action == "compact") {
+        if (!index.startCompaction()) {
+            std::cout << "Aucune mise à jour en attente.\n";
+            return 0;
+        }
+        index.finishCompaction(true);
+        if (!index.save(path)) return 1;
+        std::cout << "Index compacté : " << path << "\n";
+        return 0;
+    }
+
+    printIndexInfo(index);
+    return 0;
+}
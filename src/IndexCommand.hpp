@@ -0,0 +1,30 @@
+/**
+ * @file IndexCommand.hpp
+ * @brief Sous-commande "index" : construction, mise à jour incrémentale et compactage d'un index enregistré.
+ */
+
+#ifndef INDEXCOMMAND_HPP
+#define INDEXCOMMAND_HPP
+
+/**
+ * @brief Exécute la sous-commande "index".
+ *
+ * Formes acceptées :
+ * @code
+ * index build <reference.fasta> <k-mer size> <index.kidx> [--max-index-mem n]
+ * index append <index.kidx> <sequences.fasta>
+ * index remove <index.kidx> <sequence name>...
+ * index compact <index.kidx>
+ * index info <index.kidx>
+ * @endcode
+ *
+ * append et remove n'écrivent que la couche delta (index.kidx.delta) ; le fichier de base n'est réécrit
+ * que par build et compact.
+ *
+ * @param argc Nombre d'arguments
+ * @param argv Arguments (argv[1] vaut "index")
+ * @return 0 en cas de succès
+ */
+int runIndexCommand(int argc, char* argv[]);
+
+#endif
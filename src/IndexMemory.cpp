@@ -0,0 +1,132 @@
+/**
+ * @file IndexMemory.cpp
+ * @brief Implémentation de l'allocation des tableaux de l'index.
+ */
+
+#include "IndexMemory.hpp"
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <sstream>
+#include <unordered_set>
+#include <sys/mman.h>
+
+namespace {
+
+std::atomic<PagePolicy> currentPolicy{PagePolicy::Default};
+std::atomic<std::size_t> hugeTlbRefused{0};
+std::mutex hugeTlbMutex;                 // Protège les deux suivants (grands blocs seulement : appels rares)
+std::unordered_set<void*> hugeTlbBlocks; // Blocs projetés en pages hugetlbfs
+std::size_t hugeTlbInUse = 0;
+
+/**
+ * @brief Longueur réellement projetée pour un bloc : arrondie à HUGE_PAGE
+ */
+std::size_t mappedLength(std::size_t bytes) {
+    return (bytes + IndexMemory::HUGE_PAGE - 1) / IndexMemory::HUGE_PAGE * IndexMemory::HUGE_PAGE;
+}
+
+/**
+ * @brief Projection anonyme alignée sur HUGE_PAGE : on projette une page de plus et on rend les bords
+ */
+void* mapAligned(std::size_t length) {
+    const std::size_t padded = length + IndexMemory::HUGE_PAGE;
+    void* raw = mmap(nullptr, padded, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+    if (raw == MAP_FAILED) return nullptr;
+    const std::uintptr_t start = reinterpret_cast<std::uintptr_t>(raw);
+    const std::uintptr_t aligned = (start + IndexMemory::HUGE_PAGE - 1) / IndexMemory::HUGE_PAGE * IndexMemory::HUGE_PAGE;
+    if (aligned > start) munmap(raw, aligned - start);
+    const std::size_t tail = start + padded - (aligned + length);
+    if (tail > 0) munmap(reinterpret_cast<void*>(aligned + length), tail);
+    return reinterpret_cast<void*>(aligned);
+}
+
+} // namespace
+
+void IndexMemory::setPolicy(PagePolicy policy) {
+    currentPolicy.store(policy, std::memory_order_relaxed);
+}
+
+PagePolicy IndexMemory::policy() {
+    return currentPolicy.load(std::memory_order_relaxed);
+}
+
+bool IndexMemory::parse(const std::string& text, PagePolicy& policy) {
+    if (text == "off") {
+        policy = PagePolicy::Default;
+    } else if (text == "thp") {
+        policy = PagePolicy::TransparentHuge;
+    } else if (text == "hugetlb") {
+        policy = PagePolicy::HugeTlb;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* IndexMemory::name(PagePolicy policy) {
+    switch (policy) {
+        case PagePolicy::TransparentHuge: return "thp";
+        case PagePolicy::HugeTlb: return "hugetlb";
+        default: return "off";
+    }
+}
+
+void* IndexMemory::allocate(std::size_t bytes) {
+    if (bytes < LARGE_ALLOCATION) return ::operator new(bytes);
+
+    const std::size_t length = mappedLength(bytes);
+    const PagePolicy pages = policy();
+    if (pages == PagePolicy::HugeTlb) {
+        void* memory = mmap(nullptr, length, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB, -1, 0);
+        if (memory != MAP_FAILED) {
+            std::lock_guard<std::mutex> lock(hugeTlbMutex);
+            hugeTlbBlocks.insert(memory);
+            hugeTlbInUse += length;
+            return memory;
+        }
+        hugeTlbRefused.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void* memory = mapAligned(length);
+    if (memory == nullptr) throw std::bad_alloc();
+    if (pages != PagePolicy::Default) madvise(memory, length, MADV_HUGEPAGE);
+    return memory;
+}
+
+void IndexMemory::deallocate(void* memory, std::size_t bytes) noexcept {
+    if (memory == nullptr) return;
+    if (bytes < LARGE_ALLOCATION) {
+        ::operator delete(memory);
+        return;
+    }
+    const std::size_t length = mappedLength(bytes);
+    {
+        std::lock_guard<std::mutex> lock(hugeTlbMutex);
+        if (hugeTlbBlocks.erase(memory) != 0) hugeTlbInUse -= length;
+    }
+    munmap(memory, length);
+}
+
+std::size_t IndexMemory::hugeTlbBytes() {
+    std::lock_guard<std::mutex> lock(hugeTlbMutex);
+    return hugeTlbInUse;
+}
+
+std::size_t IndexMemory::hugeTlbFallbacks() {
+    return hugeTlbRefused.load(std::memory_order_relaxed);
+}
+
+std::size_t IndexMemory::transparentHugeBytes() {
+    std::ifstream in("/proc/self/smaps_rollup");
+    std::string line;
+    while (std::getline(in, line)) {
+        if (line.rfind("AnonHugePages:", 0) == 0) {
+            std::istringstream fields(line.substr(14));
+            std::size_t kilobytes = 0;
+            fields >> kilobytes;
+            return kilobytes * 1024;
+        }
+    }
+    return 0;
+}
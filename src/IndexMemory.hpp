@@ -0,0 +1,115 @@
+/**
+ * @file IndexMemory.hpp
+ * @brief Déclaration de l'allocation des tableaux de l'index, éventuellement en pages de 2 Mio.
+ *
+ * Les recherches dans l'index accèdent au hasard à des tables de plusieurs centaines de Mio : avec des pages
+ * de 4 Kio, presque chaque recherche manque le TLB. Les grands tableaux de l'index (table des k-mers, listes
+ * de positions) sont donc alloués par mmap, alignés sur 2 Mio, et peuvent être placés en pages de 2 Mio :
+ * pages transparentes demandées par madvise(MADV_HUGEPAGE), ou pages réservées (hugetlbfs, MAP_HUGETLB),
+ * avec repli sur les pages transparentes si la réserve est insuffisante.
+ */
+
+#ifndef INDEXMEMORY_HPP
+#define INDEXMEMORY_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <string>
+#include <vector>
+
+/**
+ * @enum PagePolicy
+ * @brief Pages utilisées pour les grands tableaux de l'index.
+ */
+enum class PagePolicy {
+    Default,         /**< Pages choisies par le système (off) */
+    TransparentHuge, /**< Pages transparentes de 2 Mio demandées par madvise (thp) */
+    HugeTlb          /**< Pages réservées de hugetlbfs, repli sur thp (hugetlb) */
+};
+
+/**
+ * @class IndexMemory
+ * @brief Politique de pages et allocation des grands tableaux de l'index (partagée par tout le processus).
+ */
+class IndexMemory {
+public:
+    static constexpr std::size_t HUGE_PAGE = std::size_t(2) << 20;    /**< Taille d'une grande page */
+    static constexpr std::size_t LARGE_ALLOCATION = HUGE_PAGE;        /**< Seuil d'allocation par mmap */
+
+    /**
+     * @brief Change la politique des allocations suivantes (les tableaux existants ne sont pas déplacés)
+     */
+    static void setPolicy(PagePolicy policy);
+
+    /**
+     * @brief Politique courante
+     */
+    static PagePolicy policy();
+
+    /**
+     * @brief Lit une politique : off, thp ou hugetlb
+     * @return false si le texte n'est pas reconnu
+     */
+    static bool parse(const std::string& text, PagePolicy& policy);
+
+    /**
+     * @brief Nom d'une politique (off, thp, hugetlb)
+     */
+    static const char* name(PagePolicy policy);
+
+    /**
+     * @brief Alloue bytes octets ; au-delà de LARGE_ALLOCATION, par mmap aligné sur HUGE_PAGE
+     * @throw std::bad_alloc si la mémoire manque
+     */
+    static void* allocate(std::size_t bytes);
+
+    /**
+     * @brief Libère un bloc obtenu par allocate avec la même taille
+     */
+    static void deallocate(void* memory, std::size_t bytes) noexcept;
+
+    /**
+     * @brief Octets actuellement alloués en pages hugetlbfs
+     */
+    static std::size_t hugeTlbBytes();
+
+    /**
+     * @brief Allocations hugetlbfs refusées (réserve insuffisante), servies en pages transparentes
+     */
+    static std::size_t hugeTlbFallbacks();
+
+    /**
+     * @brief Mémoire du processus effectivement en pages transparentes de 2 Mio (AnonHugePages), en octets
+     * @return 0 si /proc/self/smaps_rollup n'est pas lisible
+     */
+    static std::size_t transparentHugeBytes();
+};
+
+/**
+ * @brief Allocateur des tableaux de l'index (voir IndexMemory), sans état
+ */
+template <typename T>
+struct IndexAllocator {
+    using value_type = T;
+
+    IndexAllocator() = default;
+    template <typename U>
+    IndexAllocator(const IndexAllocator<U>&) {}
+
+    T* allocate(std::size_t count) { return static_cast<T*>(IndexMemory::allocate(count * sizeof(T))); }
+    void deallocate(T* memory, std::size_t count) noexcept { IndexMemory::deallocate(memory, count * sizeof(T)); }
+
+    template <typename U>
+    bool operator==(const IndexAllocator<U>&) const { return true; }
+    template <typename U>
+    bool operator!=(const IndexAllocator<U>&) const { return false; }
+};
+
+/**
+ * @brief Tableau de l'index alloué selon la politique de pages
+ */
+template <typename T>
+using IndexVector = std::vector<T, IndexAllocator<T>>;
+
+#endif
@@ -0,0 +1,163 @@
+/**
+ * @file IndexPlanner.cpp
+ * @brief Estimation de l'empreinte mémoire de l'index et choix de son organisation.
+ */
+
+#include "IndexPlanner.hpp"
+#include "KmerCodec.hpp"
+#include <algorithm>
+#include <array>
+#include <cctype>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <unordered_map>
+
+namespace {
+
+const int SAMPLING_STEPS[] = {1, 2, 4, 8, 16}; // Pas d'échantillonnage candidats, du plus rapide au plus économe
+constexpr std::size_t STEP_COUNT = sizeof(SAMPLING_STEPS) / sizeof(SAMPLING_STEPS[0]);
+constexpr std::size_t COUNTED_KMERS = std::size_t(1) << 16; // k-mers comptés exactement (ordre de grandeur)
+
+} // namespace
+
+HyperLogLog::HyperLogLog() : registers(std::size_t(1) << PRECISION, 0) {}
+
+void HyperLogLog::add(std::uint64_t hash) {
+    std::size_t index = static_cast<std::size_t>(hash >> (64 - PRECISION));
+    std::uint64_t rest = hash << PRECISION;
+    std::uint8_t rank = rest == 0 ? static_cast<std::uint8_t>(64 - PRECISION + 1)
+                                  : static_cast<std::uint8_t>(__builtin_clzll(rest) + 1);
+    if (rank > registers[index]) registers[index] = rank;
+}
+
+double HyperLogLog::estimate() const {
+    const double m = static_cast<double>(registers.size());
+    double sum = 0.0;
+    std::size_t zeros = 0;
+    for (std::uint8_t r : registers) {
+        sum += std::ldexp(1.0, -static_cast<int>(r));
+        if (r == 0) zeros++;
+    }
+    double estimate = (0.7213 / (1.0 + 1.079 / m)) * m * m / sum;
+    if (estimate <= 2.5 * m && zeros > 0) {
+        estimate = m * std::log(m / static_cast<double>(zeros)); // correction pour les petits effectifs
+    }
+    return estimate;
+}
+
+std::size_t estimateDistinctKmers(const std::string& genome, int k, int step) {
+    if (k < 1 || k > KmerIndex::MAX_K) return 0;
+    const std::size_t s = static_cast<std::size_t>(step > 1 ? step : 1);
+    HyperLogLog sketch;
+    withKmerSize(k, true, [&](auto kmerSize) {
+        forEachKmer(genome, kmerSize, [&](std::uint64_t code, std::size_t pos) {
+            if (pos % s == 0) sketch.add(hashKmer(code));
+        });
+    });
+    return static_cast<std::size_t>(std::ceil(sketch.estimate()));
+}
+
+std::vector<LayoutEstimate> estimateLayouts(const std::string& genome, int k) {
+    std::vector<LayoutEstimate> estimates;
+    if (k < 1 || k > KmerIndex::MAX_K) return estimates;
+
+    // Une seule passe sur le génome : un estimateur par pas d'échantillonnage, et les occurrences exactes
+    // d'un sous-ensemble de k-mers choisi par hachage (part des k-mers à occurrence unique, pour la compression)
+    std::vector<HyperLogLog> sketches(STEP_COUNT);
+    std::unordered_map<std::uint64_t, std::array<std::uint32_t, STEP_COUNT>> counted;
+    const std::uint64_t countEvery = std::max<std::uint64_t>(genome.size() / COUNTED_KMERS, 1);
+    forEachKmer(genome, k, [&](std::uint64_t code, std::size_t pos) {
+        std::uint64_t hash = hashKmer(code);
+        const bool count = (hash >> 16) % countEvery == 0;
+        for (std::size_t i = 0; i < STEP_COUNT; ++i) {
+            if (pos % static_cast<std::size_t>(SAMPLING_STEPS[i]) != 0) continue;
+            sketches[i].add(hash);
+            if (count) counted[code][i]++;
+        }
+    });
+
+    // À pas égal, la compression garde toutes les positions indexées : elle passe avant le pas suivant
+    for (std::size_t i = 0; i < STEP_COUNT; ++i) {
+        std::size_t present = 0, singletons = 0;
+        for (const auto& entry : counted) {
+            present += entry.second[i] > 0 ? 1 : 0;
+            singletons += entry.second[i] == 1 ? 1 : 0;
+        }
+        const double singletonFraction = present > 0 ? static_cast<double>(singletons) / present : 0.0;
+        for (bool compressed : {false, true}) {
+            LayoutEstimate estimate;
+            estimate.layout.step = SAMPLING_STEPS[i];
+            estimate.layout.compressed = compressed;
+            estimate.distinct_kmers = static_cast<std::size_t>(std::ceil(sketches[i].estimate()));
+            estimate.bytes = KmerIndex::estimateMemory(genome.length(), estimate.distinct_kmers, k, estimate.layout,
+                                                       singletonFraction);
+            estimates.push_back(estimate);
+        }
+    }
+    return estimates;
+}
+
+bool chooseLayout(const std::vector<LayoutEstimate>& estimates, std::size_t budget, LayoutEstimate& chosen) {
+    for (const auto& estimate : estimates) {
+        if (estimate.bytes <= budget) {
+            chosen = estimate;
+            return true;
+        }
+    }
+    return false;
+}
+
+void printLayoutEstimates(std::ostream& out, const std::vector<LayoutEstimate>& estimates, std::size_t budget) {
+    out << "Estimation mémoire de l'index (budget " << formatBytes(budget) << ") :\n";
+    for (const auto& estimate : estimates) {
+        out << "  " << estimate.layout.name() << " : " << formatBytes(estimate.bytes)
+            << " (" << estimate.distinct_kmers << " k-mers distincts)"
+            << (estimate.bytes <= budget ? "" : " -> dépasse le budget") << "\n";
+    }
+}
+
+bool parseByteSize(const std::string& text, std::size_t& bytes) {
+    if (text.empty()) return false;
+    std::size_t used = 0;
+    double value;
+    try {
+        value = std::stod(text, &used);
+    } catch (const std::exception&) {
+        return false;
+    }
+    if (!std::isfinite(value) || value < 0) return false; // stod accepte "nan" et "inf"
+
+    double multiplier = 1.0;
+    if (used < text.size()) {
+        switch (std::toupper(static_cast<unsigned char>(text[used]))) {
+            case 'K': multiplier = 1024.0; break;
+            case 'M': multiplier = 1024.0 * 1024.0; break;
+            case 'G': multiplier = 1024.0 * 1024.0 * 1024.0; break;
+            case 'T': multiplier = 1024.0 * 1024.0 * 1024.0 * 1024.0; break;
+            default: return false;
+        }
+        used++;
+        // Suffixes tolérés : "M", "MB", "MiB"
+        std::string rest = text.substr(used);
+        if (!rest.empty() && rest != "B" && rest != "b" && rest != "iB") return false;
+    }
+    // Conversion définie seulement en deçà de 2^64 (le maximum de size_t, arrondi en double, vaut 2^64)
+    const double scaled = value * multiplier;
+    if (scaled >= static_cast<double>(std::numeric_limits<std::size_t>::max())) return false;
+    bytes = static_cast<std::size_t>(scaled);
+    return true;
+}
+
+std::string formatBytes(std::size_t bytes) {
+    const char* units[] = {"B", "KiB", "MiB", "GiB", "TiB"};
+    double value = static_cast<double>(bytes);
+    int unit = 0;
+    while (value >= 1024.0 && unit < 4) {
+        value /= 1024.0;
+        unit++;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), unit == 0 ? "%.0f %s" : "%.1f %s", value, units[unit]);
+    return buffer;
+}
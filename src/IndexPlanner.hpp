@@ -0,0 +1,97 @@
+/**
+ * @file IndexPlanner.hpp
+ * @brief Choix de l'organisation de l'index sous contrainte mémoire (--max-index-mem).
+ */
+
+#ifndef INDEXPLANNER_HPP
+#define INDEXPLANNER_HPP
+
+#include "KmerIndex.hpp"
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @class HyperLogLog
+ * @brief Estimateur du nombre d'éléments distincts en mémoire constante (2^14 registres, erreur ~0,8 %).
+ */
+class HyperLogLog {
+public:
+    static constexpr int PRECISION = 14; /**< Nombre de bits de hachage utilisés pour choisir le registre */
+
+    HyperLogLog();
+
+    /**
+     * @brief Ajoute un élément à partir de son hachage 64 bits
+     */
+    void add(std::uint64_t hash);
+
+    /**
+     * @brief Estimation du nombre d'éléments distincts ajoutés
+     */
+    double estimate() const;
+
+private:
+    std::vector<std::uint8_t> registers; /**< Rang maximal observé par registre */
+};
+
+/**
+ * @brief Estime le nombre de k-mers distincts d'un génome sans construire l'index
+ * @param genome Séquence génomique
+ * @param k Taille des k-mers
+ * @param step Seules les positions multiples de step sont prises en compte (index échantillonné)
+ * @return Nombre estimé de k-mers distincts
+ */
+std::size_t estimateDistinctKmers(const std::string& genome, int k, int step = 1);
+
+/**
+ * @struct LayoutEstimate
+ * @brief Empreinte mémoire estimée d'une organisation de l'index.
+ */
+struct LayoutEstimate {
+    IndexLayout layout;           /**< Organisation évaluée */
+    std::size_t distinct_kmers;   /**< k-mers distincts estimés pour cette organisation */
+    std::size_t bytes;            /**< Empreinte estimée, en octets */
+};
+
+/**
+ * @brief Estime l'empreinte de chaque organisation disponible, de la plus rapide à la plus économe
+ *
+ * Les k-mers distincts sont estimés en une seule passe sur le génome pour tous les pas d'échantillonnage.
+ * Chaque pas est proposé sans puis avec compression des listes de positions.
+ *
+ * @param genome Séquence génomique
+ * @param k Taille des k-mers
+ * @return Les estimations, dans l'ordre de préférence
+ */
+std::vector<LayoutEstimate> estimateLayouts(const std::string& genome, int k);
+
+/**
+ * @brief Choisit la première organisation (la plus rapide) dont l'empreinte tient dans le budget
+ * @param estimates Estimations dans l'ordre de préférence
+ * @param budget Budget mémoire en octets
+ * @param chosen Variable de sortie : organisation retenue
+ * @return false si aucune organisation ne tient dans le budget
+ */
+bool chooseLayout(const std::vector<LayoutEstimate>& estimates, std::size_t budget, LayoutEstimate& chosen);
+
+/**
+ * @brief Affiche le tableau des estimations
+ */
+void printLayoutEstimates(std::ostream& out, const std::vector<LayoutEstimate>& estimates, std::size_t budget);
+
+/**
+ * @brief Convertit une taille lisible ("512M", "4G", "1500000") en octets
+ * @param text Taille, avec suffixe facultatif K, M, G ou T (puissances de 1024)
+ * @param bytes Variable de sortie
+ * @return false si la taille est invalide, non finie ou d'au moins 2^64 octets
+ */
+bool parseByteSize(const std::string& text, std::size_t& bytes);
+
+/**
+ * @brief Formate une taille en octets ("12.3 MiB")
+ */
+std::string formatBytes(std::size_t bytes);
+
+#endif
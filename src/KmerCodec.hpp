@@ -0,0 +1,245 @@
+/**
+ * @file KmerCodec.hpp
+ * @brief Codage des k-mers sur 2 bits par base (A=0, C=1, G=2, T=3) et fonctions associées.
+ */
+
+#ifndef KMERCODEC_HPP
+#define KMERCODEC_HPP
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+/**
+ * @struct BaseCodeTable
+ * @brief Table des codes 2 bits indexée par caractère, calculée à la compilation (-1 = pas une base).
+ */
+struct BaseCodeTable {
+    std::int8_t code[256]; /**< Code de chaque caractère */
+
+    constexpr BaseCodeTable() : code() {
+        for (int c = 0; c < 256; ++c) code[c] = -1;
+        code[static_cast<unsigned char>('A')] = 0; code[static_cast<unsigned char>('a')] = 0;
+        code[static_cast<unsigned char>('C')] = 1; code[static_cast<unsigned char>('c')] = 1;
+        code[static_cast<unsigned char>('G')] = 2; code[static_cast<unsigned char>('g')] = 2;
+        code[static_cast<unsigned char>('T')] = 3; code[static_cast<unsigned char>('t')] = 3;
+    }
+};
+
+inline constexpr BaseCodeTable BASE_CODES{}; /**< Table partagée par tous les codages */
+
+/**
+ * @brief Code 2 bits d'une base (insensible à la casse), ou -1 pour tout autre caractère
+ * @param base Caractère nucléotidique
+ */
+inline int baseCode(char base) {
+    return BASE_CODES.code[static_cast<unsigned char>(base)];
+}
+
+/**
+ * @brief Masque des 2k bits de poids faible
+ * @param k Taille des k-mers (1 à 32)
+ */
+constexpr std::uint64_t kmerMask(int k) {
+    return k >= 32 ? ~std::uint64_t(0) : (std::uint64_t(1) << (2 * k)) - 1;
+}
+
+/**
+ * @struct FixedK
+ * @brief Taille de k-mer connue à la compilation : masque et décalages sont des constantes,
+ * ce qui permet au compilateur de dérouler et simplifier les boucles de codage.
+ */
+template <int K>
+struct FixedK {
+    static_assert(K >= 1 && K <= 32, "k-mer size must be between 1 and 32");
+
+    /** Taille des k-mers */
+    static constexpr int size() { return K; }
+    /** Masque des 2K bits de poids faible */
+    static constexpr std::uint64_t mask() { return kmerMask(K); }
+};
+
+/**
+ * @struct DynamicK
+ * @brief Taille de k-mer connue à l'exécution (chemin générique), même interface que FixedK.
+ */
+struct DynamicK {
+    int k;               /**< Taille des k-mers */
+    std::uint64_t bits;  /**< Masque des 2k bits de poids faible */
+
+    explicit DynamicK(int k) : k(k), bits(kmerMask(k)) {}
+
+    int size() const { return k; }
+    std::uint64_t mask() const { return bits; }
+};
+
+/**
+ * @brief Appelle fn avec une taille de k-mer spécialisée à la compilation si k est une valeur courante
+ * (11, 15, 19, 21, 25 ou 31), sinon avec la taille générique DynamicK.
+ *
+ * @param k Taille des k-mers
+ * @param specialized false pour forcer le chemin générique (comparaisons de performance)
+ * @param fn Fonction générique appelée avec FixedK<K> ou DynamicK
+ * @return La valeur renvoyée par fn
+ */
+template <typename Fn>
+decltype(auto) withKmerSize(int k, bool specialized, Fn&& fn) {
+    if (specialized) {
+        switch (k) {
+            case 11: return fn(FixedK<11>());
+            case 15: return fn(FixedK<15>());
+            case 19: return fn(FixedK<19>());
+            case 21: return fn(FixedK<21>());
+            case 25: return fn(FixedK<25>());
+            case 31: return fn(FixedK<31>());
+            default: break;
+        }
+    }
+    return fn(DynamicK(k));
+}
+
+/**
+ * @brief Code un k-mer complet
+ * @param kmer Chaîne de longueur k
+ * @param k Taille attendue
+ * @param code Variable de sortie : k-mer codé
+ * @return false si la longueur ne vaut pas k ou si un caractère n'est pas A, C, G ou T
+ */
+inline bool encodeKmer(const std::string& kmer, int k, std::uint64_t& code) {
+    if (static_cast<int>(kmer.length()) != k) return false;
+    code = 0;
+    for (char c : kmer) {
+        int b = baseCode(c);
+        if (b < 0) return false;
+        code = (code << 2) | static_cast<std::uint64_t>(b);
+    }
+    return true;
+}
+
+/**
+ * @brief Décode un k-mer codé en chaîne (majuscules)
+ */
+inline std::string decodeKmer(std::uint64_t code, int k) {
+    static const char bases[4] = {'A', 'C', 'G', 'T'};
+    std::string kmer(k, 'A');
+    for (int i = k - 1; i >= 0; --i) {
+        kmer[i] = bases[code & 3];
+        code >>= 2;
+    }
+    return kmer;
+}
+
+/**
+ * @brief Complémentaire inverse d'un k-mer codé, sans allocation
+ *
+ * Le complément d'une base codée est 3 - b, soit l'inversion des deux bits ;
+ * l'ordre des bases est ensuite inversé par permutation des groupes de 2 bits.
+ */
+inline std::uint64_t reverseComplementCode(std::uint64_t code, int k) {
+    std::uint64_t x = ~code;
+    x = ((x >> 2) & 0x3333333333333333ULL) | ((x & 0x3333333333333333ULL) << 2);
+    x = ((x >> 4) & 0x0F0F0F0F0F0F0F0FULL) | ((x & 0x0F0F0F0F0F0F0F0FULL) << 4);
+    x = ((x >> 8) & 0x00FF00FF00FF00FFULL) | ((x & 0x00FF00FF00FF00FFULL) << 8);
+    x = ((x >> 16) & 0x0000FFFF0000FFFFULL) | ((x & 0x0000FFFF0000FFFFULL) << 16);
+    x = (x >> 32) | (x << 32);
+    return x >> (64 - 2 * k);
+}
+
+/**
+ * @brief Parcourt tous les k-mers valides d'un texte avec un codage glissant (une base par itération)
+ *
+ * Un caractère autre que A, C, G ou T remet la fenêtre à zéro : aucun k-mer le contenant n'est produit.
+ *
+ * @param text Texte à parcourir
+ * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+ * @param fn Fonction appelée avec (k-mer codé, position de départ)
+ */
+template <typename KSize, typename Fn>
+void forEachKmer(const std::string& text, KSize kmerSize, Fn&& fn) {
+    const int k = kmerSize.size();
+    const std::uint64_t mask = kmerSize.mask();
+    std::uint64_t code = 0;
+    int valid = 0;
+    const std::size_t length = text.length();
+    for (std::size_t i = 0; i < length; ++i) {
+        int b = baseCode(text[i]);
+        if (b < 0) {
+            valid = 0;
+            continue;
+        }
+        code = ((code << 2) | static_cast<std::uint64_t>(b)) & mask;
+        if (++valid >= k) {
+            fn(code, i + 1 - static_cast<std::size_t>(k));
+        }
+    }
+}
+
+/**
+ * @brief Variante de forEachKmer avec une taille de k-mer connue à l'exécution
+ * @param k Taille des k-mers (1 à 32)
+ */
+template <typename Fn>
+void forEachKmer(const std::string& text, int k, Fn&& fn) {
+    forEachKmer(text, DynamicK(k), std::forward<Fn>(fn));
+}
+
+/**
+ * @brief Parcourt les k-mers valides d'un texte en codant en même temps leur complémentaire inverse,
+ * jusqu'à ce que la fonction demande l'arrêt
+ *
+ * Le complémentaire inverse est mis à jour en glissant dans l'autre sens : la base complémentée
+ * entre par les bits de poids fort.
+ *
+ * @param text Texte à parcourir
+ * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+ * @param fn Fonction appelée avec (k-mer codé, complémentaire inverse codé, position de départ) ;
+ *        elle renvoie false pour arrêter le parcours
+ * @return false si le parcours a été arrêté par fn
+ */
+template <typename KSize, typename Fn>
+bool forEachKmerBothStrandsWhile(const std::string& text, KSize kmerSize, Fn&& fn) {
+    const int k = kmerSize.size();
+    const std::uint64_t mask = kmerSize.mask();
+    const int topShift = 2 * (k - 1);
+    std::uint64_t forward = 0, reverse = 0;
+    int valid = 0;
+    const std::size_t length = text.length();
+    for (std::size_t i = 0; i < length; ++i) {
+        int b = baseCode(text[i]);
+        if (b < 0) {
+            valid = 0;
+            continue;
+        }
+        forward = ((forward << 2) | static_cast<std::uint64_t>(b)) & mask;
+        reverse = (reverse >> 2) | (static_cast<std::uint64_t>(3 - b) << topShift);
+        if (++valid >= k && !fn(forward, reverse, i + 1 - static_cast<std::size_t>(k))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Parcourt tous les k-mers valides d'un texte en codant en même temps leur complémentaire inverse
+ * @param text Texte à parcourir
+ * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+ * @param fn Fonction appelée avec (k-mer codé, complémentaire inverse codé, position de départ)
+ */
+template <typename KSize, typename Fn>
+void forEachKmerBothStrands(const std::string& text, KSize kmerSize, Fn&& fn) {
+    forEachKmerBothStrandsWhile(text, kmerSize, [&fn](std::uint64_t forward, std::uint64_t reverse, std::size_t start) {
+        fn(forward, reverse, start);
+        return true;
+    });
+}
+
+/**
+ * @brief Mélange 64 bits (finaliseur de SplitMix64) utilisé comme fonction de hachage des k-mers
+ */
+inline std::uint64_t hashKmer(std::uint64_t code) {
+    code = (code ^ (code >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    code = (code ^ (code >> 27)) * 0x94D049BB133111EBULL;
+    return code ^ (code >> 31);
+}
+
+#endif
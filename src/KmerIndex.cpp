@@ -1,50 +1,850 @@
 #include "KmerIndex.hpp"
-#include "Utils.hpp"
+#include "KmerCodec.hpp"
+#include "IndexPlanner.hpp"
+#include "NumaTopology.hpp"
+#include "PositionCodec.hpp"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <fstream>
 #include <iostream>
 
-KmerIndex::KmerIndex(int k) : k(k) {}
+namespace {
 
-void KmerIndex::indexGenome(const std::string& sequence) {
-    genome = sequence;
-    int genome_length = genome.length();
-    for (int i = 0; i <= genome_length - k; i++) {
-        std::string kmer = genome.substr(i, k);
-        index[kmer].push_back(i);
+constexpr double MAX_LOAD = 0.7;        // Taux de remplissage maximal de la table
+constexpr double DISTINCT_MARGIN = 1.03; // Marge sur l'estimation HyperLogLog (~4 écarts-types)
+
+const char BASE_MAGIC[4] = {'K', 'I', 'D', 'X'};  // Fichier de base (.kidx)
+const char DELTA_MAGIC[4] = {'K', 'D', 'L', 'T'}; // Couche delta (.kidx.delta)
+const std::uint32_t FORMAT_VERSION = 2;        // 2 : organisation compressée et listes compressées
+const std::uint32_t OLDEST_FORMAT_VERSION = 1; // encore lisible
+
+// Tampon des positions fusionnées pour searchKmerWithStrand
+thread_local std::vector<int> searchScratch;
+
+/*
+ * Lecture et écriture binaires (ordre des octets de la machine) des fichiers d'index
+ */
+template <typename T>
+void writeValue(std::ostream& out, const T& value) {
+    out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+bool readValue(std::istream& in, T& value) {
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+template <typename T, typename Allocator>
+void writeVector(std::ostream& out, const std::vector<T, Allocator>& values) {
+    writeValue(out, static_cast<std::uint64_t>(values.size()));
+    out.write(reinterpret_cast<const char*>(values.data()), static_cast<std::streamsize>(values.size() * sizeof(T)));
+}
+
+/**
+ * @brief Vrai si le flux contient encore au moins count éléments de elementSize octets
+ * (longueur annoncée par un fichier, contrôlée avant d'allouer)
+ */
+bool remainingFits(std::istream& in, std::uint64_t count, std::size_t elementSize) {
+    const std::streampos here = in.tellg();
+    if (here < 0 || !in.seekg(0, std::ios::end)) return false;
+    const std::streampos end = in.tellg();
+    in.seekg(here);
+    if (end < here || !in) return false;
+    return count <= static_cast<std::uint64_t>(end - here) / elementSize;
+}
+
+template <typename T, typename Allocator>
+bool readVector(std::istream& in, std::vector<T, Allocator>& values) {
+    std::uint64_t size;
+    if (!readValue(in, size) || !remainingFits(in, size, sizeof(T))) return false;
+    values.resize(size);
+    return static_cast<bool>(in.read(reinterpret_cast<char*>(values.data()),
+                                     static_cast<std::streamsize>(size * sizeof(T))));
+}
+
+void writeString(std::ostream& out, const std::string& text) {
+    writeValue(out, static_cast<std::uint64_t>(text.size()));
+    out.write(text.data(), static_cast<std::streamsize>(text.size()));
+}
+
+bool readString(std::istream& in, std::string& text) {
+    std::uint64_t size;
+    if (!readValue(in, size) || !remainingFits(in, size, 1)) return false;
+    text.resize(size);
+    return static_cast<bool>(in.read(&text[0], static_cast<std::streamsize>(size)));
+}
+
+void writeContig(std::ostream& out, const Contig& contig) {
+    writeString(out, contig.name);
+    writeValue(out, static_cast<std::uint64_t>(contig.start));
+    writeValue(out, static_cast<std::uint64_t>(contig.length));
+}
+
+bool readContig(std::istream& in, Contig& contig) {
+    std::uint64_t start, length;
+    if (!readString(in, contig.name) || !readValue(in, start) || !readValue(in, length)) return false;
+    contig.start = start;
+    contig.length = length;
+    return true;
+}
+
+/**
+ * @brief Vrai si chaque séquence tient dans le texte de longueur textLength
+ */
+bool validContigs(const std::vector<Contig>& contigs, std::size_t textLength) {
+    for (const Contig& contig : contigs) {
+        if (contig.start > textLength || contig.length > textLength - contig.start) return false;
+    }
+    return true;
+}
+
+bool checkMagic(std::istream& in, const char (&magic)[4], std::uint32_t& version) {
+    char found[4];
+    return in.read(found, 4) && std::equal(found, found + 4, magic) && readValue(in, version) &&
+           version >= OLDEST_FORMAT_VERSION && version <= FORMAT_VERSION;
+}
+
+/**
+ * @brief Retire de positions celles qui tombent dans un intervalle retiré (tous deux triés)
+ */
+void removeFiltered(std::vector<int>& positions, const std::vector<std::pair<int, int>>& removed) {
+    std::size_t range = 0;
+    std::size_t kept = 0;
+    for (int pos : positions) {
+        while (range < removed.size() && removed[range].second <= pos) ++range;
+        if (range < removed.size() && removed[range].first <= pos) continue;
+        positions[kept++] = pos;
+    }
+    positions.resize(kept);
+}
+
+} // namespace
+
+const char* strandSymbol(Strand strand) {
+    switch (strand) {
+        case Strand::Forward: return "+";
+        case Strand::Reverse: return "-";
+        default: return "NA";
+    }
+}
+
+std::string IndexLayout::name() const {
+    std::string text = step <= 1 ? "full" : "sampled/" + std::to_string(step);
+    return compressed ? text + "+compressed" : text;
+}
+
+bool IndexLayout::parse(const std::string& text, IndexLayout& layout) {
+    const std::string suffix = "+compressed";
+    std::string kind = text;
+    IndexLayout parsed;
+    if (kind.size() > suffix.size() && kind.compare(kind.size() - suffix.size(), suffix.size(), suffix) == 0) {
+        parsed.compressed = true;
+        kind.resize(kind.size() - suffix.size());
+    }
+    if (kind != "full") {
+        const std::string prefix = "sampled/";
+        if (kind.compare(0, prefix.size(), prefix) != 0 || kind.size() == prefix.size()) return false;
+        std::size_t end = 0;
+        try {
+            parsed.step = std::stoi(kind.substr(prefix.size()), &end);
+        } catch (...) {
+            return false;
+        }
+        if (end != kind.size() - prefix.size() || parsed.step < 1) return false;
+    }
+    layout = parsed;
+    return true;
+}
+
+KmerIndex::KmerIndex(int k, const IndexLayout& layout) : k(k), layout(layout), mask(0) {
+    if (k >= 1 && k <= MAX_K) mask = kmerMask(k);
+}
+
+KmerIndex::~KmerIndex() {
+    if (compaction.valid()) compaction.wait(); // le compactage lit le texte de l'index
+}
+
+KmerIndex::KmerIndex(KmerIndex&& other) : k(other.k), layout(other.layout), mask(other.mask) {
+    *this = std::move(other);
+}
+
+KmerIndex& KmerIndex::operator=(KmerIndex&& other) {
+    if (this == &other) return *this;
+    // Le thread de compactage capture l'adresse de l'index : il doit finir avant que l'état ne change de place
+    finishCompaction(true);
+    other.finishCompaction(true);
+    k = other.k;
+    layout = other.layout;
+    mask = other.mask;
+    specializeK = other.specializeK;
+    base = std::move(other.base);
+    delta = std::move(other.delta);
+    replicas = std::move(other.replicas);
+    baseLength = other.baseLength;
+    contigs = std::move(other.contigs);
+    excludedFromBase = std::move(other.excludedFromBase);
+    removedRanges = std::move(other.removedRanges);
+    prefilterBits = other.prefilterBits;
+    prefilter = std::move(other.prefilter);
+    genome = std::move(other.genome);
+    return *this;
+}
+
+void KmerIndex::setLayout(const IndexLayout& newLayout) {
+    finishCompaction(true); // le compactage construit la base avec l'organisation actuelle
+    layout = newLayout;
+}
+
+const IndexLayout& KmerIndex::getLayout() const {
+    return layout;
+}
+
+int KmerIndex::getK() const {
+    return k;
+}
+
+void KmerIndex::setK(int newK) {
+    finishCompaction(true); // le compactage encode les k-mers avec la taille actuelle
+    k = newK;
+    mask = (k >= 1 && k <= MAX_K) ? kmerMask(k) : 0;
+}
+
+void KmerIndex::setKSpecialization(bool enabled) {
+    finishCompaction(true); // le compactage lit ce réglage dans buildLayer
+    specializeK = enabled;
+}
+
+std::size_t KmerIndex::capacityFor(std::size_t expected) {
+    std::size_t capacity = static_cast<std::size_t>(static_cast<double>(expected) * DISTINCT_MARGIN / MAX_LOAD) + 1;
+    return capacity < 16 ? 16 : capacity;
+}
+
+std::size_t KmerIndex::findSlot(const IndexVector<Slot>& table, std::uint64_t key) {
+    // Réduction multiplicative du hachage dans [0, capacité) : pas besoin d'une puissance de 2
+    const std::size_t capacity = table.size();
+    std::size_t slot = static_cast<std::size_t>(
+        (static_cast<unsigned __int128>(hashKmer(key)) * capacity) >> 64);
+    while (table[slot].count != 0 && table[slot].key != key) {
+        if (++slot == capacity) slot = 0;
+    }
+    return slot;
+}
+
+void KmerIndex::grow(Layer& layer) {
+    IndexVector<Slot> old;
+    old.swap(layer.table);
+    layer.table.assign(old.size() * 2, Slot());
+    for (const Slot& entry : old) {
+        if (entry.count != 0) layer.table[findSlot(layer.table, entry.key)] = entry;
+    }
+}
+
+void KmerIndex::indexGenome(std::string sequence, std::vector<Contig> sequenceContigs) {
+    finishCompaction(true);
+    genome = std::move(sequence);
+    contigs = std::move(sequenceContigs);
+    if (contigs.empty()) {
+        Contig whole;
+        whole.name = "genome";
+        whole.length = genome.size();
+        contigs.push_back(whole);
+    }
+    excludedFromBase.assign(contigs.size(), false);
+    removedRanges.clear();
+    base = Layer();
+    delta = Layer();
+    replicas.clear();
+    baseLength = genome.size();
+    if (k < 1 || k > MAX_K) {
+        std::cerr << "Error: k-mer size must be between 1 and " << MAX_K << ". Genome not indexed.\n";
+        return;
+    }
+
+    base = buildLayer(0, genome.size(), capacityFor(estimateDistinctKmers(genome, k, layout.step)));
+    rebuildPrefilter();
+}
+
+void KmerIndex::setPrefilter(double bitsPerKmer) {
+    finishCompaction(true);
+    prefilterBits = bitsPerKmer;
+    rebuildPrefilter();
+}
+
+const KmerPrefilter& KmerIndex::getPrefilter() const {
+    return prefilter;
+}
+
+void KmerIndex::rebuildPrefilter() {
+    if (prefilterBits <= 0 || base.table.empty()) {
+        prefilter = KmerPrefilter();
+        return;
+    }
+    prefilter.reset(base.distinct + delta.distinct, prefilterBits);
+    for (const Layer* layer : {&base, &delta}) {
+        for (const Slot& entry : layer->table) {
+            if (entry.count != 0) prefilter.insert(entry.key);
+        }
     }
 }
 
+KmerIndex::Layer KmerIndex::buildLayer(std::size_t from, std::size_t to, std::size_t capacity) const {
+    Layer layer;
+    layer.table.assign(capacity, Slot());
+    withKmerSize(k, specializeK, [&](auto kmerSize) { fillLayer(layer, from, to, kmerSize); });
+    if (layout.compressed && !compressLayer(layer)) {
+        std::cerr << "Warning: compressed position lists exceed 4 GiB, keeping them uncompressed.\n";
+    }
+    return layer;
+}
+
+bool KmerIndex::compressLayer(Layer& layer) {
+    // Taille exacte d'abord : les offsets des cases ne sont modifiés que si tout tient sur 32 bits
+    std::uint64_t bytes = 0;
+    for (const Slot& entry : layer.table) {
+        if (entry.count < 2) continue;
+        const int* list = layer.positions.data() + entry.offset;
+        bytes += (entry.count + 3) / 4; // octets de contrôle
+        std::uint32_t previous = 0;
+        for (std::uint32_t i = 0; i < entry.count; ++i) {
+            bytes += varintLength(static_cast<std::uint32_t>(list[i]) - previous);
+            previous = static_cast<std::uint32_t>(list[i]);
+        }
+    }
+    if (bytes > UINT32_MAX) return false;
+
+    IndexVector<std::uint8_t> packed;
+    packed.reserve(bytes + POSITION_PADDING);
+    for (Slot& entry : layer.table) {
+        if (entry.count == 0) continue;
+        const int* list = layer.positions.data() + entry.offset;
+        if (entry.count == 1) {
+            entry.offset = static_cast<std::uint32_t>(list[0]); // position unique rangée dans la case
+        } else {
+            entry.offset = static_cast<std::uint32_t>(packed.size());
+            encodePositions(list, entry.count, packed);
+        }
+    }
+    packed.insert(packed.end(), POSITION_PADDING, 0);
+    layer.packed = std::move(packed);
+    layer.positions = IndexVector<int>();
+    return true;
+}
+
+template <typename KSize>
+void KmerIndex::fillLayer(Layer& layer, std::size_t from, std::size_t to, KSize kmerSize) const {
+    const std::size_t step = static_cast<std::size_t>(layout.step > 1 ? layout.step : 1);
+
+    // Intervalles des séquences retirées : leurs k-mers ne sont pas indexés
+    std::vector<std::pair<std::size_t, std::size_t>> excluded;
+    for (const Contig& contig : contigs) {
+        if (contig.removed) excluded.emplace_back(contig.start, contig.start + contig.length);
+    }
+    // Vrai si la position (croissante d'un appel à l'autre au sein d'une passe) doit être indexée
+    std::size_t range = 0;
+    auto keep = [&](std::size_t pos) {
+        if (pos < from || pos >= to || pos % step != 0) return false;
+        while (range < excluded.size() && excluded[range].second <= pos) ++range;
+        return range == excluded.size() || pos < excluded[range].first;
+    };
+
+    // Le texte est parcouru à partir de from : une couche delta ne relit pas tout le génome
+    const std::string window = from == 0 ? std::string() : genome.substr(from, to + k - 1 - from);
+    const std::string& text = from == 0 ? genome : window;
+
+    // Passe 1 : comptage des occurrences de chaque k-mer
+    std::size_t total = 0;
+    forEachKmer(text, kmerSize, [&](std::uint64_t code, std::size_t offset) {
+        if (!keep(from + offset)) return;
+        std::size_t slot = findSlot(layer.table, code);
+        if (layer.table[slot].count == 0) {
+            if (static_cast<double>(layer.distinct + 1) > MAX_LOAD * static_cast<double>(layer.table.size())) {
+                grow(layer);
+                slot = findSlot(layer.table, code);
+            }
+            layer.table[slot].key = code;
+            layer.distinct++;
+        }
+        layer.table[slot].count++;
+        total++;
+    });
+
+    // Début de la liste de chaque k-mer ; count sert ensuite de curseur de remplissage
+    std::uint32_t offset = 0;
+    for (Slot& entry : layer.table) {
+        entry.offset = offset;
+        offset += entry.count;
+        entry.count = 0;
+    }
+
+    // Passe 2 : remplissage des positions (triées, puisque le génome est parcouru dans l'ordre)
+    layer.positions.resize(total);
+    range = 0;
+    forEachKmer(text, kmerSize, [&](std::uint64_t code, std::size_t offset) {
+        if (!keep(from + offset)) return;
+        Slot& entry = layer.table[findSlot(layer.table, code)];
+        layer.positions[entry.offset + entry.count++] = static_cast<int>(from + offset);
+    });
+}
+
+bool KmerIndex::appendSequence(const std::string& name, const std::string& sequence) {
+    finishCompaction(true);
+    if (k < 1 || k > MAX_K || base.table.empty()) {
+        std::cerr << "Error: Cannot append " << name << " to an index that was not built.\n";
+        return false;
+    }
+    for (const Contig& contig : contigs) {
+        if (contig.name == name) {
+            std::cerr << "Error: Sequence " << name << " is already in the index.\n";
+            return false;
+        }
+    }
+
+    Contig added;
+    added.name = name;
+    added.start = genome.size();
+    added.length = sequence.size();
+    contigs.push_back(added);
+    excludedFromBase.push_back(false);
+    genome += sequence;
+
+    // La couche delta couvre tous les k-mers absents de la base, y compris ceux
+    // à cheval sur la fin du texte de la base
+    std::size_t from = baseLength >= static_cast<std::size_t>(k - 1) ? baseLength - (k - 1) : 0;
+    std::size_t kmers = genome.size() - from;
+    delta = buildLayer(from, genome.size(), capacityFor(kmers / static_cast<std::size_t>(std::max(1, layout.step))));
+    rebuildPrefilter();
+    return true;
+}
+
+bool KmerIndex::removeSequence(const std::string& name) {
+    finishCompaction(true);
+    for (Contig& contig : contigs) {
+        if (contig.name == name && !contig.removed) {
+            contig.removed = true;
+            updateRemovedRanges();
+            return true;
+        }
+    }
+    std::cerr << "Error: Sequence " << name << " is not in the index.\n";
+    return false;
+}
+
+void KmerIndex::updateRemovedRanges() {
+    removedRanges.clear();
+    for (std::size_t i = 0; i < contigs.size(); ++i) {
+        if (contigs[i].removed && !excludedFromBase[i]) {
+            removedRanges.emplace_back(static_cast<int>(contigs[i].start),
+                                       static_cast<int>(contigs[i].start + contigs[i].length));
+        }
+    }
+}
+
+const std::vector<Contig>& KmerIndex::getContigs() const {
+    return contigs;
+}
+
+const std::string& KmerIndex::getGenome() const {
+    return genome;
+}
+
+bool KmerIndex::hasPendingUpdates() const {
+    return delta.distinct > 0 || !removedRanges.empty() || baseLength != genome.size();
+}
+
+void KmerIndex::compact() {
+    if (startCompaction()) finishCompaction(true);
+}
+
+bool KmerIndex::startCompaction() {
+    if (compaction.valid() || !hasPendingUpdates()) return false;
+    // Le thread lit le texte, les séquences et les réglages (k, organisation, spécialisation) : tout ce qui
+    // les modifie passe d'abord par finishCompaction
+    compaction = std::async(std::launch::async, [this]() {
+        return buildLayer(0, genome.size(), capacityFor(estimateDistinctKmers(genome, k, layout.step)));
+    });
+    return true;
+}
+
+bool KmerIndex::finishCompaction(bool wait) {
+    if (!compaction.valid()) return false;
+    if (!wait && compaction.wait_for(std::chrono::seconds(0)) != std::future_status::ready) return false;
+
+    base = compaction.get();
+    delta = Layer();
+    replicas.clear();
+    baseLength = genome.size();
+    for (std::size_t i = 0; i < contigs.size(); ++i) {
+        excludedFromBase[i] = contigs[i].removed;
+    }
+    removedRanges.clear();
+    rebuildPrefilter();
+    return true;
+}
+
+bool KmerIndex::save(const std::string& path) const {
+    std::ofstream out(path, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: Cannot open output file " << path << "\n";
+        return false;
+    }
+    out.write(BASE_MAGIC, 4);
+    writeValue(out, FORMAT_VERSION);
+    writeValue(out, static_cast<std::int32_t>(k));
+    writeValue(out, static_cast<std::int32_t>(layout.step));
+    writeValue(out, static_cast<std::uint8_t>(layout.compressed ? 1 : 0));
+    writeString(out, genome.substr(0, baseLength));
+
+    // Séquences couvertes par la base, avec leur état d'exclusion au moment de sa construction
+    std::uint64_t baseContigs = 0;
+    while (baseContigs < contigs.size() && contigs[baseContigs].start < baseLength) ++baseContigs;
+    writeValue(out, baseContigs);
+    for (std::size_t i = 0; i < baseContigs; ++i) {
+        writeContig(out, contigs[i]);
+        writeValue(out, static_cast<std::uint8_t>(excludedFromBase[i] ? 1 : 0));
+    }
+
+    writeValue(out, static_cast<std::uint64_t>(base.distinct));
+    writeVector(out, base.table);
+    writeVector(out, base.positions);
+    writeVector(out, base.packed);
+    if (!out) {
+        std::cerr << "Error: Cannot write index file " << path << "\n";
+        return false;
+    }
+    out.close();
+    return saveDelta(path);
+}
+
+bool KmerIndex::saveDelta(const std::string& path) const {
+    const std::string deltaPath = path + ".delta";
+    if (!hasPendingUpdates()) {
+        std::remove(deltaPath.c_str()); // plus rien à fusionner : la base suffit
+        return true;
+    }
+
+    std::ofstream out(deltaPath, std::ios::binary);
+    if (!out) {
+        std::cerr << "Error: Cannot open output file " << deltaPath << "\n";
+        return false;
+    }
+    out.write(DELTA_MAGIC, 4);
+    writeValue(out, FORMAT_VERSION);
+    writeValue(out, static_cast<std::uint64_t>(baseLength)); // contrôle de cohérence avec la base
+    writeString(out, genome.substr(baseLength));
+
+    std::uint64_t baseContigs = 0;
+    while (baseContigs < contigs.size() && contigs[baseContigs].start < baseLength) ++baseContigs;
+    writeValue(out, static_cast<std::uint64_t>(contigs.size() - baseContigs));
+    for (std::size_t i = baseContigs; i < contigs.size(); ++i) {
+        writeContig(out, contigs[i]);
+    }
+
+    // Séquences retirées depuis la construction de la base
+    std::vector<std::uint64_t> removed;
+    for (std::size_t i = 0; i < contigs.size(); ++i) {
+        if (contigs[i].removed && !excludedFromBase[i]) removed.push_back(i);
+    }
+    writeVector(out, removed);
+
+    writeValue(out, static_cast<std::uint64_t>(delta.distinct));
+    writeVector(out, delta.table);
+    writeVector(out, delta.positions);
+    writeVector(out, delta.packed);
+    if (!out) {
+        std::cerr << "Error: Cannot write index file " << deltaPath << "\n";
+        return false;
+    }
+    return true;
+}
+
+int KmerIndex::readK(const std::string& path) {
+    std::ifstream in(path, std::ios::binary);
+    std::int32_t fileK = 0;
+    std::uint32_t version;
+    if (!in || !checkMagic(in, BASE_MAGIC, version) || !readValue(in, fileK)) return 0;
+    return fileK;
+}
+
+bool KmerIndex::load(const std::string& path) {
+    finishCompaction(true);
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "Error: Cannot open file " << path << "\n";
+        return false;
+    }
+
+    KmerIndex loaded(0);
+    std::int32_t fileK, step;
+    std::uint8_t compressed = 0;
+    std::uint32_t version, deltaVersion;
+    std::uint64_t contigCount, distinct;
+    bool ok = checkMagic(in, BASE_MAGIC, version) && readValue(in, fileK) && readValue(in, step) &&
+              (version < 2 || readValue(in, compressed)) && readString(in, loaded.genome) &&
+              readValue(in, contigCount);
+    for (std::uint64_t i = 0; ok && i < contigCount; ++i) {
+        Contig contig;
+        std::uint8_t excluded;
+        ok = readContig(in, contig) && readValue(in, excluded);
+        contig.removed = excluded != 0;
+        loaded.contigs.push_back(contig);
+        loaded.excludedFromBase.push_back(excluded != 0);
+    }
+    ok = ok && readValue(in, distinct) && readVector(in, loaded.base.table) &&
+         readVector(in, loaded.base.positions) && (version < 2 || readVector(in, loaded.base.packed));
+    loaded.base.distinct = distinct;
+    if (!ok || fileK < 1 || fileK > MAX_K || step < 1 || !validLayer(loaded.base, false) ||
+        !validContigs(loaded.contigs, loaded.genome.size())) {
+        std::cerr << "Error: " << path << " is not a valid index file.\n";
+        return false;
+    }
+    loaded.baseLength = loaded.genome.size();
+
+    std::ifstream deltaIn(path + ".delta", std::ios::binary);
+    if (deltaIn) {
+        std::uint64_t deltaBase, added;
+        std::string text;
+        std::vector<std::uint64_t> removed;
+        ok = checkMagic(deltaIn, DELTA_MAGIC, deltaVersion) && readValue(deltaIn, deltaBase) &&
+             deltaBase == loaded.baseLength && readString(deltaIn, text) && readValue(deltaIn, added);
+        for (std::uint64_t i = 0; ok && i < added; ++i) {
+            Contig contig;
+            ok = readContig(deltaIn, contig);
+            loaded.contigs.push_back(contig);
+            loaded.excludedFromBase.push_back(false);
+        }
+        ok = ok && readVector(deltaIn, removed) && readValue(deltaIn, distinct) &&
+             readVector(deltaIn, loaded.delta.table) && readVector(deltaIn, loaded.delta.positions) &&
+             (deltaVersion < 2 || readVector(deltaIn, loaded.delta.packed));
+        for (std::uint64_t i : removed) {
+            if (!ok || i >= loaded.contigs.size()) {
+                ok = false;
+                break;
+            }
+            loaded.contigs[i].removed = true;
+        }
+        loaded.delta.distinct = distinct;
+        if (!ok || !validLayer(loaded.delta, true) ||
+            !validContigs(loaded.contigs, loaded.baseLength + text.size())) {
+            std::cerr << "Error: " << path << ".delta does not match " << path << ".\n";
+            return false;
+        }
+        loaded.genome += text;
+    }
+
+    k = fileK;
+    mask = kmerMask(k);
+    layout.step = step;
+    layout.compressed = compressed != 0;
+    base = std::move(loaded.base);
+    replicas.clear();
+    delta = std::move(loaded.delta);
+    baseLength = loaded.baseLength;
+    contigs = std::move(loaded.contigs);
+    excludedFromBase = std::move(loaded.excludedFromBase);
+    genome = std::move(loaded.genome);
+    updateRemovedRanges();
+    rebuildPrefilter();
+    return true;
+}
+
+bool KmerIndex::validLayer(const Layer& layer, bool allowEmpty) {
+    if (layer.table.empty()) {
+        return allowEmpty && layer.distinct == 0 && layer.positions.empty() && layer.packed.empty();
+    }
+    const bool compressed = !layer.packed.empty();
+    if (compressed && (layer.packed.size() < POSITION_PADDING || !layer.positions.empty())) return false;
+    const std::size_t packedBytes = compressed ? layer.packed.size() - POSITION_PADDING : 0;
+
+    std::size_t occupied = 0;
+    for (const Slot& entry : layer.table) {
+        if (entry.count == 0) continue;
+        ++occupied;
+        if (!compressed) {
+            if (std::uint64_t(entry.offset) + entry.count > layer.positions.size()) return false;
+        } else if (entry.count > 1) {
+            // Longueur de la liste lue dans ses octets de contrôle : le décodage ne doit pas sortir du tampon
+            std::uint64_t at = entry.offset;
+            for (std::uint32_t group = 0; group < entry.count; group += 4) {
+                if (at >= packedBytes) return false;
+                const std::uint8_t control = layer.packed[at++];
+                for (std::uint32_t i = group; i < entry.count && i < group + 4; ++i) {
+                    at += ((control >> (2 * (i - group))) & 3) + 1;
+                }
+            }
+            if (at > packedBytes) return false;
+        }
+    }
+    // Une case au moins doit rester vide : findSlot s'arrête sur la première case vide
+    return occupied == layer.distinct && occupied < layer.table.size();
+}
+
 std::string KmerIndex::getKmerAtPosition(int i) const {
-    if (i >= 0 && i <= genome.size() - k) {
+    if (i >= 0 && static_cast<std::size_t>(i) + k <= genome.size()) {
         return genome.substr(i, k); // extrait le k-mer à la position i
     }
     return ""; // si position invalide
 }
 
-std::vector<int> KmerIndex::searchKmerWithStrand(const std::string& kmer, std::string& strand) const {
-    auto it = index.find(kmer);
-    if (it != index.end()) {
-        strand = "+"; // trouvé dans le sens direct
-        return it->second;
+PositionSpan KmerIndex::searchKmerWithStrand(const std::string& kmer, Strand& strand) const {
+    std::uint64_t code;
+    if (base.table.empty() || !encodeKmer(kmer, k, code)) {
+        strand = Strand::None;
+        return PositionSpan();
+    }
+
+    PositionSpan found;
+    if (mayContain(code)) found = lookup(code, searchScratch);
+    if (!found.empty()) {
+        strand = Strand::Forward; // trouvé dans le sens direct
+        return found;
     }
 
     // Chercher le brin complémentaire inversé
-    std::string rc = reverseComplement(kmer);
-    it = index.find(rc);
-    if (it != index.end()) {
-        strand = "-"; // trouvé sur le brin inverse
-        return it->second;
+    std::uint64_t reverse = reverseComplementCode(code, k);
+    if (mayContain(reverse)) found = lookup(reverse, searchScratch);
+    strand = found.empty() ? Strand::None : Strand::Reverse;
+    return found;
+}
+
+const KmerIndex::Slot* KmerIndex::findEntry(const Layer& layer, std::uint64_t code) {
+    if (layer.table.empty()) return nullptr;
+    const Slot& entry = layer.table[findSlot(layer.table, code)];
+    return entry.count != 0 ? &entry : nullptr;
+}
+
+PositionSpan KmerIndex::positionsOf(const Layer& layer, const Slot* entry, std::vector<int>& scratch) {
+    PositionSpan found;
+    if (entry == nullptr) return found;
+    found.count = entry->count;
+    if (layer.packed.empty()) {
+        found.first = layer.positions.data() + entry->offset;
+    } else if (entry->count == 1) {
+        found.first = reinterpret_cast<const int*>(&entry->offset); // position rangée dans la case
+    } else {
+        scratch.resize(entry->count);
+        decodePositions(layer.packed.data() + entry->offset, entry->count, scratch.data());
+        found.first = scratch.data();
+    }
+    return found;
+}
+
+void KmerIndex::appendPositions(const Layer& layer, const Slot* entry, std::vector<int>& out) {
+    if (entry == nullptr) return;
+    if (layer.packed.empty() || entry->count == 1) {
+        std::vector<int> unused;
+        PositionSpan span = positionsOf(layer, entry, unused);
+        out.insert(out.end(), span.begin(), span.end());
+        return;
     }
+    const std::size_t size = out.size();
+    out.resize(size + entry->count);
+    decodePositions(layer.packed.data() + entry->offset, entry->count, out.data() + size);
+}
 
-    strand = "NA"; // non trouvé
-    return {};
+const KmerIndex::Layer& KmerIndex::localBase() const {
+    if (replicas.empty()) return base;
+    const std::size_t node = static_cast<std::size_t>(NumaTopology::currentNode());
+    return node > 0 && node < replicas.size() ? replicas[node] : base;
+}
+
+PositionSpan KmerIndex::lookup(std::uint64_t code, std::vector<int>& scratch) const {
+    const Layer& home = localBase();
+    const Slot* inBase = findEntry(home, code);
+    if (delta.distinct == 0 && removedRanges.empty()) {
+        return positionsOf(home, inBase, scratch); // cas courant : aucune copie sans compression
+    }
+
+    const Slot* inDelta = findEntry(delta, code);
+    if (removedRanges.empty()) {
+        if (inDelta == nullptr) return positionsOf(home, inBase, scratch);
+        if (inBase == nullptr) return positionsOf(delta, inDelta, scratch);
+    }
+
+    // Les positions de la couche delta suivent toutes celles de la base : la concaténation reste triée
+    scratch.clear();
+    appendPositions(home, inBase, scratch);
+    appendPositions(delta, inDelta, scratch);
+    removeFiltered(scratch, removedRanges);
+    PositionSpan merged;
+    merged.first = scratch.data();
+    merged.count = scratch.size();
+    return merged;
 }
 
 void KmerIndex::printIndex() const {
-    for (const auto& [kmer, positions] : index) {
-        std::cout << kmer << " -> ";
-        for (int pos : positions) {
-            std::cout << pos << " ";
+    std::vector<int> decoded;
+    for (const Layer* layer : {&base, &delta}) {
+        for (const Slot& entry : layer->table) {
+            if (entry.count == 0) continue;
+            std::cout << decodeKmer(entry.key, k) << " -> ";
+            for (int pos : positionsOf(*layer, &entry, decoded)) {
+                std::cout << pos << " ";
+            }
+            std::cout << "\n";
         }
-        std::cout << "\n";
     }
-}
\ No newline at end of file
+}
+
+std::size_t KmerIndex::distinctKmers() const {
+    return base.distinct + delta.distinct;
+}
+
+std::size_t KmerIndex::memoryUsage() const {
+    std::size_t bytes = sizeof(KmerIndex) + genome.capacity();
+    for (const Layer* layer : {&base, &delta}) {
+        bytes += layer->table.capacity() * sizeof(Slot) + layer->positions.capacity() * sizeof(int) + layer->packed.capacity();
+    }
+    for (const Layer& replica : replicas) {
+        bytes += replica.table.capacity() * sizeof(Slot) + replica.positions.capacity() * sizeof(int) + replica.packed.capacity();
+    }
+    return bytes;
+}
+
+int KmerIndex::replicateBase(const NumaTopology& topology) {
+    replicas.clear();
+    if (topology.nodeCount() < 2 || base.table.empty()) return 0;
+
+    // Chaque copie est écrite par un thread du nœud qui la lira (premier accès) ; la base devient la copie du nœud 0
+    replicas.resize(static_cast<std::size_t>(topology.nodeCount()));
+    for (int node = 0; node < topology.nodeCount(); ++node) {
+        topology.runOnNode(node, [this, node] { replicas[static_cast<std::size_t>(node)] = base; });
+    }
+    base = std::move(replicas[0]);
+    replicas[0] = Layer();
+    return topology.nodeCount();
+}
+
+int KmerIndex::replicaCount() const {
+    return static_cast<int>(replicas.size());
+}
+
+std::size_t KmerIndex::positionListBytes() const {
+    return (base.positions.size() + delta.positions.size()) * sizeof(int) + base.packed.size() + delta.packed.size();
+}
+
+std::size_t KmerIndex::estimateMemory(std::size_t genome_length, std::size_t distinct_kmers,
+                                      int k, const IndexLayout& layout, double singleton_fraction) {
+    std::size_t step = static_cast<std::size_t>(layout.step > 1 ? layout.step : 1);
+    std::size_t kmers = genome_length >= static_cast<std::size_t>(k) ? genome_length - k + 1 : 0;
+    std::size_t indexed = (kmers + step - 1) / step;
+    std::size_t sampled_distinct = distinct_kmers < indexed ? distinct_kmers : indexed;
+    std::size_t fixed = sizeof(KmerIndex) + genome_length + capacityFor(sampled_distinct) * sizeof(Slot);
+    if (!layout.compressed) return fixed + indexed * sizeof(int);
+
+    // Compression : les k-mers à occurrence unique sont rangés dans la case (au moins 2 * distinct - indexed) ;
+    // les autres positions coûtent l'écart moyen entre occurrences d'une même liste, plus 1/4 d'octet de contrôle
+    std::size_t singletons = 2 * sampled_distinct > indexed ? 2 * sampled_distinct - indexed : 0;
+    singletons = std::max(singletons, static_cast<std::size_t>(singleton_fraction * sampled_distinct));
+    // Chaque liste restante contient au moins deux positions
+    if (sampled_distinct > singletons && 2 * (sampled_distinct - singletons) > indexed - singletons) {
+        singletons = 2 * sampled_distinct - indexed;
+    }
+    std::size_t lists = sampled_distinct - singletons;
+    std::size_t repeated = indexed - singletons;
+    if (repeated == 0 || lists == 0) return fixed + POSITION_PADDING;
+    std::size_t gap = genome_length / std::max<std::size_t>(repeated / lists, 1);
+    int gapBytes = varintLength(static_cast<std::uint32_t>(std::min<std::size_t>(gap, UINT32_MAX)));
+    return fixed + repeated * gapBytes + (repeated + 3 * lists) / 4 + lists + POSITION_PADDING;
+}
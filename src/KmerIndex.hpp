@@ -6,10 +6,86 @@
 #ifndef KMERINDEX_HPP
 #define KMERINDEX_HPP
 
-#include <unordered_map>
+#include "IndexMemory.hpp"
+#include "KmerPrefilter.hpp"
+#include <cstdint>
+#include <future>
 #include <vector>
 #include <string>
 
+class NumaTopology;
+
+/**
+ * @struct IndexLayout
+ * @brief Organisation mémoire de l'index.
+ *
+ * - "full" : toutes les positions du génome sont indexées ;
+ * - "sampled" : seule une position sur @c step est indexée. Un read de longueur L >= k + step - 1
+ *   contient toujours au moins un k-mer démarrant sur une position échantillonnée, et les votes
+ *   restent cohérents puisque chaque k-mer retrouvé vote pour la même position de départ.
+ *
+ * Avec @c compressed (suffixe "+compressed"), les listes de positions sont compressées (voir PositionCodec.hpp)
+ * et décodées à la recherche ; une position unique est rangée dans la case de la table, sans liste.
+ */
+struct IndexLayout {
+    int step = 1;             /**< Pas d'échantillonnage des positions (1 = index complet) */
+    bool compressed = false;  /**< Listes de positions compressées */
+
+    /**
+     * @brief Nom lisible de l'organisation ("full", "sampled/4", "full+compressed", ...)
+     */
+    std::string name() const;
+
+    /**
+     * @brief Lit une organisation à partir de son nom (forme renvoyée par name)
+     * @param text Nom de l'organisation
+     * @param layout Variable de sortie
+     * @return false si le nom est invalide
+     */
+    static bool parse(const std::string& text, IndexLayout& layout);
+};
+
+/**
+ * @enum Strand
+ * @brief Brin sur lequel un k-mer (ou un read) a été retrouvé.
+ */
+enum class Strand {
+    Forward, /**< Brin direct ('+') */
+    Reverse, /**< Brin complémentaire inverse ('-') */
+    None     /**< Non trouvé ou brins incohérents ("NA") */
+};
+
+/**
+ * @brief Symbole d'un brin tel qu'exporté dans les résultats : "+", "-" ou "NA"
+ */
+const char* strandSymbol(Strand strand);
+
+/**
+ * @struct PositionSpan
+ * @brief Vue non propriétaire sur les positions d'un k-mer dans l'index (valide tant que l'index n'est pas modifié).
+ */
+struct PositionSpan {
+    const int* first = nullptr; /**< Première position */
+    std::size_t count = 0;      /**< Nombre de positions */
+
+    const int* begin() const { return first; }
+    const int* end() const { return first + count; }
+    std::size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    int operator[](std::size_t i) const { return first[i]; }
+};
+
+/**
+ * @struct Contig
+ * @brief Séquence de référence (enregistrement FASTA) et son emplacement dans le texte indexé.
+ */
+struct Contig {
+    std::string name;        /**< Nom de la séquence (en-tête FASTA) */
+    std::size_t start = 0;   /**< Début dans le texte concaténé */
+    std::size_t length = 0;  /**< Longueur */
+    bool removed = false;    /**< Marquée comme retirée : ses k-mers ne sont plus renvoyés */
+};
+
 /**
  * @class KmerIndex
  * @brief Structure permettant d'indexer des mots de longueur fixe (k-mers) dans un texte génomique.
@@ -17,29 +93,212 @@
  * Cette classe permet :
  * - d'indexer un génome pour retrouver rapidement les occurrences d'un k-mer,
  * - de rechercher un k-mer ou son brin complémentaire inversé,
- * - de récupérer le k-mer présent à une position donnée du texte.
+ * - de récupérer le k-mer présent à une position donnée du texte,
+ * - d'ajouter ou de retirer des séquences sans tout réindexer, et d'enregistrer l'index sur disque.
+ *
+ * Les k-mers (k <= 32) sont codés sur 2 bits par base dans un entier 64 bits. L'index est une table
+ * à adressage ouvert (clé, début, nombre) et un tableau unique de positions : son empreinte mémoire
+ * ne dépend que du nombre de positions indexées et du nombre de k-mers distincts (voir estimateMemory).
+ * Les bases sont indexées sans distinction de casse ; un k-mer contenant une autre lettre n'est pas indexé.
+ *
+ * Mises à jour incrémentales : les séquences ajoutées sont indexées dans une couche delta, et les
+ * séquences retirées sont filtrées à la recherche. Les recherches fusionnent la couche de base et la couche
+ * delta jusqu'à un compactage, qui reconstruit la base (éventuellement en arrière-plan). Les positions sont
+ * celles du texte concaténé et restent stables : le texte d'une séquence retirée est conservé.
  */
 class KmerIndex {
 public:
+    static constexpr int MAX_K = 32; /**< Plus grande taille de k-mer représentable sur 64 bits */
+
     /**
      * @brief Constructeur
-     * @param k Taille des k-mers à indexer
+     * @param k Taille des k-mers à indexer (1 à 32)
+     * @param layout Organisation mémoire de l'index
+     */
+    KmerIndex(int k, const IndexLayout& layout = IndexLayout());
+
+    /**
+     * @brief Attend la fin d'un éventuel compactage en arrière-plan
+     */
+    ~KmerIndex();
+
+    /**
+     * @brief Déplacement : le compactage en cours de l'index source est d'abord installé
+     * (son thread écrit dans l'objet source et ne doit pas lui survivre)
+     */
+    KmerIndex(KmerIndex&& other);
+
+    /**
+     * @brief Affectation par déplacement : les compactages en cours des deux index sont d'abord installés
+     */
+    KmerIndex& operator=(KmerIndex&& other);
+
+    /**
+     * @brief Change l'organisation utilisée par le prochain appel à indexGenome (après le compactage en cours)
+     * @param layout Nouvelle organisation
+     */
+    void setLayout(const IndexLayout& layout);
+
+    /**
+     * @brief Organisation actuelle de l'index
+     */
+    const IndexLayout& getLayout() const;
+
+    /**
+     * @brief Taille des k-mers
+     */
+    int getK() const;
+
+    /**
+     * @brief Change la taille des k-mers utilisée par le prochain appel à indexGenome (après le compactage en cours)
+     * @param newK Nouvelle taille (1 à MAX_K)
+     */
+    void setK(int newK);
+
+    /**
+     * @brief Active ou désactive les versions de la construction spécialisées à la compilation
+     * pour les tailles de k-mer courantes (activées par défaut), après le compactage en cours
+     * @param enabled false pour toujours utiliser le chemin générique
+     */
+    void setKSpecialization(bool enabled);
+
+    /**
+     * @brief Active (ou désactive) le filtre d'appartenance placé devant les recherches (voir mayContain)
+     *
+     * Le filtre est reconstruit à partir des k-mers des couches de base et delta à chaque modification
+     * de l'index ; il n'est pas enregistré avec l'index.
+     *
+     * @param bitsPerKmer Bits de filtre par k-mer distinct (0 = pas de filtre)
+     */
+    void setPrefilter(double bitsPerKmer);
+
+    /**
+     * @brief Filtre d'appartenance courant (vide s'il est désactivé)
+     */
+    const KmerPrefilter& getPrefilter() const;
+
+    /**
+     * @brief Test rapide à faire avant lookup : false si le k-mer codé est absent à coup sûr
+     *
+     * Toujours vrai sans filtre. Un k-mer d'une séquence retirée peut passer le filtre jusqu'au compactage
+     * (lookup ne renvoie alors rien), jamais l'inverse.
+     */
+    bool mayContain(std::uint64_t code) const { return prefilter.empty() || prefilter.mayContain(code); }
+
+    /**
+     * @brief Indexe tous les k-mers d'un génome donné (remplace tout le contenu de l'index)
+     * @param genome Séquence génomique à indexer (conservée par l'index)
+     * @param contigs Séquences qui composent le génome, dans l'ordre (vide = une seule séquence "genome")
+     */
+    void indexGenome(std::string genome, std::vector<Contig> contigs = {});
+
+    /**
+     * @brief Ajoute une séquence à la fin du texte et indexe ses k-mers dans la couche delta
+     *
+     * Les k-mers à cheval sur la jonction avec la séquence précédente sont indexés, comme lors d'une
+     * reconstruction complète.
+     *
+     * @param name Nom de la séquence (doit être unique)
+     * @param sequence Séquence nucléotidique
+     * @return false si le nom existe déjà ou si l'index n'est pas construit
+     */
+    bool appendSequence(const std::string& name, const std::string& sequence);
+
+    /**
+     * @brief Marque une séquence comme retirée : ses k-mers ne sont plus renvoyés par les recherches
+     * @param name Nom de la séquence
+     * @return false si la séquence est inconnue ou déjà retirée
      */
-    KmerIndex(int k);
+    bool removeSequence(const std::string& name);
 
     /**
-     * @brief Indexe tous les k-mers d'un génome donné
-     * @param genome Séquence génomique à indexer
+     * @brief Séquences de l'index, dans l'ordre du texte
      */
-    void indexGenome(const std::string& genome);
+    const std::vector<Contig>& getContigs() const;
 
     /**
-     * @brief Recherche un k-mer ou son brin complémentaire inversé
+     * @brief Texte génomique indexé (séquences concaténées, séquences retirées comprises)
+     */
+    const std::string& getGenome() const;
+
+    /**
+     * @brief Indique si des mises à jour attendent un compactage (couche delta ou séquences retirées)
+     */
+    bool hasPendingUpdates() const;
+
+    /**
+     * @brief Reconstruit la couche de base en y intégrant la couche delta et les retraits (bloquant)
+     */
+    void compact();
+
+    /**
+     * @brief Lance le compactage dans un thread d'arrière-plan ; les recherches continuent sur les couches actuelles
+     * @return false si aucune mise à jour n'est en attente ou si un compactage est déjà en cours
+     */
+    bool startCompaction();
+
+    /**
+     * @brief Point sûr : installe le résultat d'un compactage terminé
+     *
+     * Ne doit pas être appelé pendant des recherches concurrentes. Les modifications de l'index
+     * (ajout, retrait, indexation, chargement) passent par ce point et attendent le compactage en cours.
+     *
+     * @param wait true pour attendre la fin du compactage, false pour n'installer qu'un résultat déjà prêt
+     * @return true si un compactage a été installé
+     */
+    bool finishCompaction(bool wait);
+
+    /**
+     * @brief Enregistre l'index complet (fichier de base) et, si besoin, sa couche delta (fichier path + ".delta")
+     * @param path Chemin du fichier d'index (.kidx)
+     * @return false en cas d'erreur d'écriture
+     */
+    bool save(const std::string& path) const;
+
+    /**
+     * @brief Enregistre seulement la couche delta (ajouts et retraits) à côté d'un fichier de base existant
+     * @param path Chemin du fichier d'index de base (.kidx), inchangé
+     * @return false en cas d'erreur d'écriture
+     */
+    bool saveDelta(const std::string& path) const;
+
+    /**
+     * @brief Charge un index enregistré par save (et sa couche delta si le fichier path + ".delta" existe)
+     * @param path Chemin du fichier d'index (.kidx)
+     * @return false si un fichier est illisible ou incohérent (l'index est alors vide)
+     */
+    bool load(const std::string& path);
+
+    /**
+     * @brief Lit la taille des k-mers d'un fichier d'index sans le charger
+     * @param path Chemin du fichier d'index (.kidx)
+     * @return La taille des k-mers, ou 0 si le fichier n'est pas un index valide
+     */
+    static int readK(const std::string& path);
+
+    /**
+     * @brief Recherche un k-mer ou son brin complémentaire inversé, sans copie des positions
+     *
+     * Si l'index a des mises à jour en attente, les positions fusionnées sont placées dans un tampon
+     * du thread appelant, valide jusqu'au prochain appel.
+     *
      * @param kmer Le k-mer à rechercher
-     * @param strand Variable de sortie : "+", "-" ou "NA"
-     * @return Vecteur de positions du k-mer trouvé
+     * @param strand Variable de sortie : Forward, Reverse ou None
+     * @return Les positions du k-mer trouvé (vide si absent)
      */
-    std::vector<int> searchKmerWithStrand(const std::string& kmer, std::string& strand) const;
+    PositionSpan searchKmerWithStrand(const std::string& kmer, Strand& strand) const;
+
+    /**
+     * @brief Recherche un k-mer déjà codé sur 2 bits
+     *
+     * Sans mise à jour en attente, la vue pointe directement dans l'index. Sinon, les positions de la base
+     * (hors séquences retirées) puis celles de la couche delta sont fusionnées dans scratch.
+     *
+     * @param code k-mer codé (voir KmerCodec.hpp)
+     * @param scratch Tampon réutilisable de l'appelant
+     * @return Les positions triées du k-mer (vide si absent)
+     */
+    PositionSpan lookup(std::uint64_t code, std::vector<int>& scratch) const;
 
     /**
      * @brief Récupère le k-mer présent à la position i dans le génome indexé
@@ -53,10 +312,163 @@ public:
      */
     void printIndex() const;
 
+    /**
+     * @brief Nombre de k-mers distincts indexés (somme des couches de base et delta)
+     */
+    std::size_t distinctKmers() const;
+
+    /**
+     * @brief Mémoire occupée par l'index (génome, tables et positions, copies NUMA comprises), en octets
+     */
+    std::size_t memoryUsage() const;
+
+    /**
+     * @brief Copie la couche de base sur chaque nœud NUMA (index lu par des threads de plusieurs nœuds)
+     *
+     * Chaque copie est écrite par un thread épinglé sur son nœud, qui en reçoit donc les pages ; un thread
+     * épinglé (voir NumaTopology::pinCurrentThread) lit ensuite la copie de son nœud, les autres la base,
+     * elle aussi recopiée sur le nœud 0. Les copies sont abandonnées dès que la base est reconstruite
+     * (indexGenome, load, compactage). Sans effet sur une machine à un seul nœud.
+     *
+     * @param topology Topologie de la machine
+     * @return Nombre de nœuds servis par une copie locale (0 si l'index n'est pas répliqué)
+     */
+    int replicateBase(const NumaTopology& topology);
+
+    /**
+     * @brief Nombre de nœuds servis par une copie locale de la base (0 = pas de copies)
+     */
+    int replicaCount() const;
+
+    /**
+     * @brief Mémoire occupée par les listes de positions seules (compressées ou non), en octets
+     */
+    std::size_t positionListBytes() const;
+
+    /**
+     * @brief Estime l'empreinte mémoire de l'index avant sa construction
+     * @param genome_length Longueur du génome
+     * @param distinct_kmers Nombre (estimé) de k-mers distincts du génome complet
+     * @param k Taille des k-mers
+     * @param layout Organisation envisagée
+     * @param singleton_fraction Part (estimée) des k-mers distincts indexés qui n'ont qu'une occurrence,
+     *        pour une organisation compressée (0 = inconnue : borne basse déduite des effectifs)
+     * @return L'empreinte estimée, en octets
+     */
+    static std::size_t estimateMemory(std::size_t genome_length, std::size_t distinct_kmers,
+                                      int k, const IndexLayout& layout, double singleton_fraction = 0.0);
+
 private:
-    int k;  /**< Taille des k-mers */
-    std::unordered_map<std::string, std::vector<int>> index; /**< Table d'indexation des k-mers */
-    std::string genome; /**< Texte génomique complet utilisé pour l'indexation */
+    /**
+     * @struct Slot
+     * @brief Case de la table : k-mer codé, début de sa liste dans positions et nombre d'occurrences.
+     *
+     * Dans une couche compressée, offset est le début de la liste dans packed, ou la position elle-même
+     * si le k-mer n'a qu'une occurrence.
+     */
+    struct Slot {
+        std::uint64_t key = 0;     /**< k-mer codé sur 2 bits par base */
+        std::uint32_t offset = 0;  /**< Début de la liste dans positions (ou dans packed, ou position unique) */
+        std::uint32_t count = 0;   /**< Nombre d'occurrences (0 = case vide) */
+    };
+
+    /**
+     * @struct Layer
+     * @brief Couche de l'index (base ou delta) : table des k-mers distincts et positions regroupées par k-mer.
+     */
+    struct Layer {
+        IndexVector<Slot> table;      /**< Table à adressage ouvert des k-mers distincts */
+        IndexVector<int> positions;   /**< Positions de tous les k-mers, regroupées par k-mer et triées */
+        IndexVector<std::uint8_t> packed; /**< Listes compressées, à la place de positions (vide sinon) */
+        std::size_t distinct = 0;     /**< Nombre de cases occupées */
+    };
+
+    /**
+     * @brief Case contenant le k-mer codé, ou case vide où l'insérer
+     */
+    static std::size_t findSlot(const IndexVector<Slot>& table, std::uint64_t key);
+
+    /**
+     * @brief Couche de base à utiliser depuis le thread appelant : la copie de son nœud NUMA s'il en a une
+     */
+    const Layer& localBase() const;
+
+    /**
+     * @brief Case d'un k-mer dans une couche, ou nullptr s'il est absent
+     */
+    static const Slot* findEntry(const Layer& layer, std::uint64_t code);
+
+    /**
+     * @brief Positions d'une case (nullptr = aucune) ; une liste compressée est décodée dans scratch
+     */
+    static PositionSpan positionsOf(const Layer& layer, const Slot* entry, std::vector<int>& scratch);
+
+    /**
+     * @brief Ajoute à out les positions d'une case (nullptr = aucune), décodées si besoin
+     */
+    static void appendPositions(const Layer& layer, const Slot* entry, std::vector<int>& out);
+
+    /**
+     * @brief Remplace les listes de positions d'une couche par leur forme compressée
+     * @return false si les listes compressées dépassent 4 Gio (la couche reste alors non compressée)
+     */
+    static bool compressLayer(Layer& layer);
+
+    /**
+     * @brief Contrôle une couche lue dans un fichier : nombre de cases occupées égal à distinct, au moins
+     * une case vide, et listes de chaque case contenues dans positions (ou dans packed hors remplissage)
+     * @param allowEmpty true si la couche peut n'avoir aucune table (couche delta)
+     */
+    static bool validLayer(const Layer& layer, bool allowEmpty);
+
+    /**
+     * @brief Nombre de cases pour un nombre donné de k-mers distincts
+     */
+    static std::size_t capacityFor(std::size_t distinct);
+
+    /**
+     * @brief Reconstruit la table d'une couche avec une capacité plus grande (phase de comptage)
+     */
+    static void grow(Layer& layer);
+
+    /**
+     * @brief Construit une couche avec les k-mers commençant dans [from, to), hors séquences retirées
+     * @param capacity Capacité initiale de la table
+     */
+    Layer buildLayer(std::size_t from, std::size_t to, std::size_t capacity) const;
+
+    /**
+     * @brief Corps de buildLayer pour une taille de k-mer donnée (comptage puis remplissage)
+     * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+     */
+    template <typename KSize>
+    void fillLayer(Layer& layer, std::size_t from, std::size_t to, KSize kmerSize) const;
+
+    /**
+     * @brief Reconstruit le filtre d'appartenance à partir des couches actuelles (s'il est activé)
+     */
+    void rebuildPrefilter();
+
+    /**
+     * @brief Recalcule les intervalles à filtrer à partir des séquences retirées depuis le dernier compactage
+     */
+    void updateRemovedRanges();
+
+    int k;                        /**< Taille des k-mers */
+    IndexLayout layout;           /**< Organisation mémoire */
+    std::uint64_t mask;           /**< Masque des 2k bits de poids faible */
+    bool specializeK = true;      /**< Utiliser les constructions spécialisées pour les k courants */
+    Layer base;                   /**< Couche de base (construite ou compactée) */
+    Layer delta;                  /**< Séquences ajoutées depuis le dernier compactage */
+    std::vector<Layer> replicas;  /**< Copies de la base par nœud NUMA (la base sert le nœud 0 ; vide = aucune) */
+    std::size_t baseLength = 0;   /**< Longueur du texte couvert par la couche de base */
+    std::vector<Contig> contigs;  /**< Séquences du texte, dans l'ordre */
+    std::vector<bool> excludedFromBase; /**< Séquences déjà exclues de la couche de base (par contig) */
+    std::vector<std::pair<int, int>> removedRanges; /**< Intervalles [début, fin) retirés depuis le compactage */
+    std::future<Layer> compaction; /**< Compactage en cours en arrière-plan */
+    double prefilterBits = 0;     /**< Bits du filtre par k-mer (0 = pas de filtre) */
+    KmerPrefilter prefilter;      /**< Filtre d'appartenance des k-mers des deux couches */
+    std::string genome;           /**< Texte génomique complet utilisé pour l'indexation */
 };
 
 #endif
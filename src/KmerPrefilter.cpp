@@ -0,0 +1,47 @@
+/**
+ * @file KmerPrefilter.cpp
+ * @brief Implémentation du filtre de Bloom par blocs sur les k-mers.
+ */
+
+#include "KmerPrefilter.hpp"
+#include <algorithm>
+#include <cmath>
+
+void KmerPrefilter::reset(std::size_t expected, double bitsPerKmer) {
+    std::size_t bits = static_cast<std::size_t>(std::ceil(static_cast<double>(std::max<std::size_t>(expected, 1)) * bitsPerKmer));
+    blocks.assign(std::max<std::size_t>((bits + BLOCK_BITS - 1) / BLOCK_BITS, 1), Block());
+    // Nombre optimal de bits par k-mer : ln(2) * bits par k-mer
+    hashes = std::clamp(static_cast<int>(std::lround(bitsPerKmer * 0.6931)), 1, 16);
+    inserted = 0;
+}
+
+void KmerPrefilter::insert(std::uint64_t code) {
+    std::uint64_t hash = hashKmer(code ^ SEED);
+    Block& block = blocks[blockOf(hash)];
+    std::uint32_t h1 = static_cast<std::uint32_t>(hash);
+    std::uint32_t h2 = static_cast<std::uint32_t>((hash * MIX) >> 32) | 1;
+    for (int i = 0; i < hashes; ++i) {
+        std::uint32_t bit = (h1 + static_cast<std::uint32_t>(i) * h2) % BLOCK_BITS;
+        block.words[bit / 64] |= std::uint64_t(1) << (bit % 64);
+    }
+    inserted++;
+}
+
+int KmerPrefilter::hashCount() const {
+    return hashes;
+}
+
+double KmerPrefilter::bitsPerKmer() const {
+    return inserted > 0 ? static_cast<double>(blocks.size() * BLOCK_BITS) / static_cast<double>(inserted) : 0.0;
+}
+
+double KmerPrefilter::expectedFalsePositiveRate() const {
+    // Formule du filtre de Bloom classique : les blocs la dépassent légèrement (remplissage inégal des blocs)
+    if (inserted == 0) return 0.0;
+    double filled = 1.0 - std::exp(-static_cast<double>(hashes) / bitsPerKmer());
+    return std::pow(filled, hashes);
+}
+
+std::size_t KmerPrefilter::memoryUsage() const {
+    return blocks.capacity() * sizeof(Block);
+}
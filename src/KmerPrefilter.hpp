@@ -0,0 +1,105 @@
+/**
+ * @file KmerPrefilter.hpp
+ * @brief Déclaration du filtre d'appartenance (Bloom par blocs) placé devant les recherches dans l'index.
+ */
+
+#ifndef KMERPREFILTER_HPP
+#define KMERPREFILTER_HPP
+
+#include "KmerCodec.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+/**
+ * @class KmerPrefilter
+ * @brief Filtre de Bloom par blocs sur les k-mers codés : répond "absent" (certain) ou "peut-être présent".
+ *
+ * Chaque k-mer est affecté à un bloc de 512 bits (une ligne de cache) dans lequel sont placés tous ses bits :
+ * un test ne coûte qu'un accès mémoire, là où une recherche infructueuse dans la table de l'index en coûte
+ * au moins un, plus le sondage linéaire. Avec quelques bits par k-mer, le filtre tient en cache pour des
+ * génomes de taille moyenne et écarte presque tous les k-mers absents de la référence.
+ */
+class KmerPrefilter {
+public:
+    static constexpr std::size_t BLOCK_BITS = 512; /**< Taille d'un bloc, en bits (une ligne de cache) */
+
+    /**
+     * @brief Vide le filtre et le dimensionne pour un nombre de k-mers donné
+     * @param expected Nombre de k-mers distincts qui seront insérés
+     * @param bitsPerKmer Bits de filtre par k-mer (plus de bits = moins de faux positifs)
+     */
+    void reset(std::size_t expected, double bitsPerKmer);
+
+    /**
+     * @brief Ajoute un k-mer codé au filtre
+     */
+    void insert(std::uint64_t code);
+
+    /**
+     * @brief Teste l'appartenance d'un k-mer codé
+     * @return false si le k-mer est absent à coup sûr, true s'il est peut-être présent
+     */
+    bool mayContain(std::uint64_t code) const {
+        std::uint64_t hash = hashKmer(code ^ SEED);
+        const Block& block = blocks[blockOf(hash)];
+        std::uint32_t h1 = static_cast<std::uint32_t>(hash);
+        // Les bits de poids fort ont choisi le bloc : le pas du double hachage vient d'un second mélange
+        std::uint32_t h2 = static_cast<std::uint32_t>((hash * MIX) >> 32) | 1;
+        for (int i = 0; i < hashes; ++i) {
+            std::uint32_t bit = (h1 + static_cast<std::uint32_t>(i) * h2) % BLOCK_BITS;
+            if ((block.words[bit / 64] & (std::uint64_t(1) << (bit % 64))) == 0) return false;
+        }
+        return true;
+    }
+
+    /**
+     * @brief Indique si le filtre est vide (non dimensionné)
+     */
+    bool empty() const { return blocks.empty(); }
+
+    /**
+     * @brief Nombre de bits testés par k-mer
+     */
+    int hashCount() const;
+
+    /**
+     * @brief Bits de filtre par k-mer inséré (taille réelle, après arrondi au bloc)
+     */
+    double bitsPerKmer() const;
+
+    /**
+     * @brief Taux de faux positifs attendu pour le nombre de k-mers insérés
+     */
+    double expectedFalsePositiveRate() const;
+
+    /**
+     * @brief Mémoire occupée par le filtre, en octets
+     */
+    std::size_t memoryUsage() const;
+
+private:
+    /**
+     * @struct Block
+     * @brief Bloc de 512 bits aligné sur une ligne de cache.
+     */
+    struct alignas(64) Block {
+        std::uint64_t words[BLOCK_BITS / 64] = {}; /**< Bits du bloc */
+    };
+
+    static constexpr std::uint64_t SEED = 0x9E3779B97F4A7C15ULL; /**< Décorrèle le hachage de celui de la table */
+    static constexpr std::uint64_t MIX = 0xFF51AFD7ED558CCDULL;  /**< Multiplicateur du second hachage */
+
+    /**
+     * @brief Bloc d'un k-mer : réduction multiplicative des 32 bits de poids fort du hachage
+     */
+    std::size_t blockOf(std::uint64_t hash) const {
+        return static_cast<std::size_t>(((hash >> 32) * blocks.size()) >> 32);
+    }
+
+    std::vector<Block> blocks;   /**< Blocs du filtre */
+    int hashes = 0;              /**< Nombre de bits placés par k-mer */
+    std::size_t inserted = 0;    /**< Nombre de k-mers insérés */
+};
+
+#endif
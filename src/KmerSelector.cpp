@@ -0,0 +1,266 @@
+/**
+ * @file KmerSelector.cpp
+ * @brief Implémentation du choix automatique de la taille des k-mers.
+ */
+
+#include "KmerSelector.hpp"
+#include "IndexPlanner.hpp"
+#include "KmerCodec.hpp"
+#include "KmerIndex.hpp"
+#include "QualityHistogram.hpp"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <unordered_map>
+
+namespace {
+
+const int CANDIDATE_KS[] = {11, 13, 15, 17, 19, 21, 23, 25, 27, 29, 31}; // Tailles essayées, croissantes
+constexpr std::size_t SAMPLED_POSITIONS = std::size_t(1) << 16; // Positions dont le k-mer est compté exactement, par taille
+
+/**
+ * @brief Taux d'erreur moyen par base d'une chaîne de qualité Phred+33
+ */
+double qualityErrorRate(const std::string& quality) {
+    static const std::array<double, QualityHistogram::BINS> errorOf = [] {
+        std::array<double, QualityHistogram::BINS> table{};
+        for (int q = 0; q < QualityHistogram::BINS; ++q) table[q] = std::pow(10.0, -q / 10.0);
+        return table;
+    }();
+    if (quality.empty()) return 0.0;
+    double sum = 0.0;
+    for (char c : quality) {
+        sum += errorOf[std::min(std::max(c - 33, 0), QualityHistogram::BINS - 1)];
+    }
+    return sum / static_cast<double>(quality.size());
+}
+
+/**
+ * @brief Indique si un read garde assez de k-mers sans erreur attendus : une part MIN_CLEAN_KMER_SHARE
+ *        et au moins MIN_EXPECTED_SEEDS graines
+ */
+bool enoughSeeds(std::size_t length, double errorRate, int k) {
+    if (length < static_cast<std::size_t>(k)) return false;
+    const double clean = std::pow(1.0 - errorRate, k);
+    return clean >= KmerSelector::MIN_CLEAN_KMER_SHARE &&
+           static_cast<double>(length - k + 1) * clean >= KmerSelector::MIN_EXPECTED_SEEDS;
+}
+
+} // namespace
+
+void KmerPlan::print(std::ostream& out) const {
+    out << "Choix automatique de k (" << sampled_reads << " reads échantillonnés, " << on_target_reads
+        << " retrouvés sur la référence) :\n"
+        << "  k de référence (unicité)  : " << reference_k << " (plus petit k admis : " << smallest_k << ")\n"
+        << "  divergence des reads      : " << read_error_rate * 100.0 << " % par base";
+    if (quality_error_rate >= 0.0) out << " (qualités : " << quality_error_rate * 100.0 << " %)";
+    out << "\n  index principal           : k = " << primary_k << " (" << formatBytes(primary_bytes) << ")\n";
+    if (secondary_k > 0) {
+        out << "  second index              : k = " << secondary_k << " (" << formatBytes(secondary_bytes) << ", "
+            << secondary_reads << " reads de l'échantillon)\n";
+    } else {
+        out << "  second index              : aucun\n";
+    }
+    out << "  reads avec assez de graines : " << planned_sensitivity * 100.0 << " % (index principal seul : "
+        << primary_only_sensitivity * 100.0 << " %)\n";
+}
+
+void KmerSelector::profileReference(const std::string& genome) {
+    curve.clear();
+    const std::size_t stride = std::max<std::size_t>(genome.size() / SAMPLED_POSITIONS, 1);
+    for (int k : CANDIDATE_KS) {
+        if (genome.size() < static_cast<std::size_t>(k)) break;
+        // Première passe : k-mers distincts, et k-mers d'un échantillon régulier de positions ;
+        // seconde passe : occurrences de ces k-mers dans toute la référence
+        HyperLogLog sketch;
+        std::unordered_map<std::uint64_t, std::uint32_t> counted;
+        std::vector<std::uint64_t> sampled;
+        std::size_t positions = 0;
+        withKmerSize(k, true, [&](auto kmerSize) {
+            forEachKmer(genome, kmerSize, [&](std::uint64_t code, std::size_t position) {
+                sketch.add(hashKmer(code));
+                positions++;
+                if (position % stride == 0) {
+                    sampled.push_back(code);
+                    counted.emplace(code, 0);
+                }
+            });
+            forEachKmer(genome, kmerSize, [&](std::uint64_t code, std::size_t) {
+                auto found = counted.find(code);
+                if (found != counted.end()) found->second++;
+            });
+        });
+
+        // Moyennes sur les positions échantillonnées : un k-mer répété est tiré proportionnellement à ses occurrences
+        std::uint64_t uniquePositions = 0, occurrences = 0;
+        for (std::uint64_t code : sampled) {
+            const std::uint32_t count = counted[code];
+            uniquePositions += count == 1 ? 1 : 0;
+            occurrences += count;
+        }
+        UniquenessPoint point;
+        point.k = k;
+        point.unique_fraction = sampled.empty() ? 0.0 : static_cast<double>(uniquePositions) / sampled.size();
+        point.mean_occurrences = sampled.empty() ? 0.0 : static_cast<double>(occurrences) / sampled.size();
+        point.distinct_kmers = std::min(positions, static_cast<std::size_t>(std::ceil(sketch.estimate())));
+        point.index_bytes = KmerIndex::estimateMemory(genome.size(), point.distinct_kmers, k, IndexLayout());
+        curve.push_back(point);
+    }
+}
+
+const KmerPlan& KmerSelector::choose(const std::vector<Sequence>& reads, const std::string& genome) {
+    plan = KmerPlan();
+    qualityOffset = 0.0;
+    if (curve.empty()) return plan;
+
+    // k de référence : l'unicité ne gagne presque plus rien au-delà ; plus petit k : elle perd encore peu
+    const double best = curve.back().unique_fraction;
+    for (auto it = curve.rbegin(); it != curve.rend(); ++it) {
+        if (it->unique_fraction >= best - UNIQUENESS_TOLERANCE) plan.reference_k = it->k;
+        if (it->unique_fraction >= best - MAX_UNIQUENESS_LOSS) plan.smallest_k = it->k;
+        if (it->unique_fraction < best - MAX_UNIQUENESS_LOSS) break;
+    }
+
+    // Échantillon régulier des reads
+    std::vector<const Sequence*> sample;
+    const std::size_t stride = std::max<std::size_t>(reads.size() / SAMPLE_READS, 1);
+    for (std::size_t i = 0; i < reads.size() && sample.size() < SAMPLE_READS; i += stride) {
+        sample.push_back(&reads[i]);
+    }
+    plan.sampled_reads = sample.size();
+
+    // Sonde au plus petit k admis (les reads bruités y gardent des k-mers retrouvés) : k-mers canoniques de
+    // l'échantillon, marqués en une passe sur la référence
+    const DynamicK probeK(plan.smallest_k);
+    std::unordered_map<std::uint64_t, bool> probed;
+    for (const Sequence* read : sample) {
+        forEachKmerBothStrands(read->getSequence(), probeK, [&](std::uint64_t forward, std::uint64_t reverse, std::size_t) {
+            probed.emplace(std::min(forward, reverse), false);
+        });
+    }
+    forEachKmerBothStrands(genome, probeK, [&](std::uint64_t forward, std::uint64_t reverse, std::size_t) {
+        auto found = probed.find(std::min(forward, reverse));
+        if (found != probed.end()) found->second = true;
+    });
+
+    // Probabilité qu'un k-mer quelconque soit retrouvé par hasard (l'un des deux brins parmi les k-mers distincts)
+    double randomHit = 0.0;
+    for (const UniquenessPoint& point : curve) {
+        if (point.k == plan.smallest_k) {
+            randomHit = std::min(1.0, 2.0 * point.distinct_kmers / std::pow(4.0, point.k));
+        }
+    }
+
+    // Divergence des reads sur la cible : une part h de k-mers retrouvés (hors hasard) donne 1 - h^(1/k) par base
+    double divergence = 0.0, qualityRate = 0.0;
+    bool allQualities = !sample.empty();
+    std::vector<double> classSum(LENGTH_CLASSES, 0.0);
+    std::vector<std::size_t> classCount(LENGTH_CLASSES, 0);
+    for (const Sequence* read : sample) {
+        std::size_t kmers = 0, hits = 0;
+        forEachKmerBothStrands(read->getSequence(), probeK, [&](std::uint64_t forward, std::uint64_t reverse, std::size_t) {
+            kmers++;
+            hits += probed[std::min(forward, reverse)] ? 1 : 0;
+        });
+        if (read->getQuality().empty()) {
+            allQualities = false;
+        } else {
+            qualityRate += qualityErrorRate(read->getQuality());
+        }
+        // Hors cible (pas plus de k-mers retrouvés que le hasard n'en donne) : ne renseigne pas sur les erreurs
+        const double chance = static_cast<double>(kmers) * randomHit;
+        if (kmers == 0 || static_cast<double>(hits) <= chance + 3.0 * std::sqrt(chance)) continue;
+        const double share = std::max(0.0, (static_cast<double>(hits) / kmers - randomHit) / (1.0 - randomHit));
+        const double rate = 1.0 - std::pow(share, 1.0 / plan.smallest_k);
+        const int lengthBin = lengthClass(read->getSequence().size());
+        plan.on_target_reads++;
+        divergence += rate;
+        classSum[lengthBin] += rate;
+        classCount[lengthBin]++;
+    }
+    if (plan.on_target_reads > 0) plan.read_error_rate = divergence / plan.on_target_reads;
+    rateByLength.assign(LENGTH_CLASSES, -1.0);
+    for (int c = 0; c < LENGTH_CLASSES; ++c) {
+        if (classCount[c] > 0) rateByLength[c] = classSum[c] / classCount[c];
+    }
+    if (allQualities) {
+        plan.quality_error_rate = qualityRate / sample.size();
+        qualityOffset = std::max(0.0, plan.read_error_rate - plan.quality_error_rate);
+    }
+
+    // k idéal de chaque read : le médian pour l'index principal, le 5e centile pour le second
+    std::vector<int> ideal;
+    for (const Sequence* read : sample) {
+        ideal.push_back(idealK(read->getSequence().size(), readErrorRate(*read)));
+    }
+    std::vector<int> sorted = ideal;
+    std::sort(sorted.begin(), sorted.end());
+    plan.primary_k = sorted.empty() ? plan.reference_k : sorted[sorted.size() / 2];
+    const int lowK = sorted.empty() ? plan.primary_k : sorted[sorted.size() * 5 / 100];
+    const std::size_t needing = static_cast<std::size_t>(
+        std::count_if(ideal.begin(), ideal.end(), [&](int k) { return k < plan.primary_k; }));
+    if (lowK < plan.primary_k && needing >= MIN_SECONDARY_SHARE * sample.size()) {
+        plan.secondary_k = lowK;
+        plan.secondary_reads = needing;
+    }
+
+    // Bénéfice : reads qui gardent assez de graines attendues, avec et sans le second index
+    std::size_t primaryOnly = 0, planned = 0;
+    for (std::size_t i = 0; i < sample.size(); ++i) {
+        const std::size_t length = sample[i]->getSequence().size();
+        const double rate = readErrorRate(*sample[i]);
+        const int k = plan.secondary_k > 0 && ideal[i] < plan.primary_k ? plan.secondary_k : plan.primary_k;
+        primaryOnly += enoughSeeds(length, rate, plan.primary_k) ? 1 : 0;
+        planned += enoughSeeds(length, rate, k) ? 1 : 0;
+    }
+    if (!sample.empty()) {
+        plan.primary_only_sensitivity = static_cast<double>(primaryOnly) / sample.size();
+        plan.planned_sensitivity = static_cast<double>(planned) / sample.size();
+    }
+
+    // Coût : empreinte estimée des index
+    for (const UniquenessPoint& point : curve) {
+        if (point.k == plan.primary_k) plan.primary_bytes = point.index_bytes;
+        if (point.k == plan.secondary_k) plan.secondary_bytes = point.index_bytes;
+    }
+    return plan;
+}
+
+bool KmerSelector::useSecondary(const Sequence& read) const {
+    return plan.secondary_k > 0 && idealK(read.getSequence().size(), readErrorRate(read)) < plan.primary_k;
+}
+
+int KmerSelector::idealK(std::size_t length, double errorRate) const {
+    for (auto it = std::rbegin(CANDIDATE_KS); it != std::rend(CANDIDATE_KS); ++it) {
+        if (*it > plan.reference_k) continue;
+        if (*it < plan.smallest_k) break;
+        if (enoughSeeds(length, errorRate, *it)) return *it;
+    }
+    return plan.smallest_k;
+}
+
+double KmerSelector::readErrorRate(const Sequence& read) const {
+    if (plan.quality_error_rate >= 0.0 && !read.getQuality().empty()) {
+        return qualityErrorRate(read.getQuality()) + qualityOffset;
+    }
+    const std::size_t lengthBin = static_cast<std::size_t>(lengthClass(read.getSequence().size()));
+    if (lengthBin < rateByLength.size() && rateByLength[lengthBin] >= 0.0) return rateByLength[lengthBin];
+    return plan.read_error_rate;
+}
+
+int KmerSelector::lengthClass(std::size_t length) {
+    int bits = 0;
+    while (length > 0 && bits < LENGTH_CLASSES - 1) {
+        length >>= 1;
+        ++bits;
+    }
+    return bits;
+}
+
+const std::vector<UniquenessPoint>& KmerSelector::getCurve() const {
+    return curve;
+}
+
+const KmerPlan& KmerSelector::getPlan() const {
+    return plan;
+}
@@ -0,0 +1,137 @@
+/**
+ * @file KmerSelector.hpp
+ * @brief Déclaration du choix automatique de la taille des k-mers (un ou deux index selon les reads).
+ */
+
+#ifndef KMERSELECTOR_HPP
+#define KMERSELECTOR_HPP
+
+#include "Sequence.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct UniquenessPoint
+ * @brief Point de la courbe d'unicité de la référence pour une taille de k-mers.
+ */
+struct UniquenessPoint {
+    int k = 0;                      /**< Taille des k-mers */
+    double unique_fraction = 0.0;   /**< Part des positions dont le k-mer n'apparaît qu'une fois */
+    double mean_occurrences = 0.0;  /**< Occurrences moyennes d'un k-mer retrouvé (votes par graine) */
+    std::size_t distinct_kmers = 0; /**< k-mers distincts estimés */
+    std::size_t index_bytes = 0;    /**< Empreinte estimée de l'index complet */
+};
+
+/**
+ * @struct KmerPlan
+ * @brief Tailles de k-mers retenues, avec les indicateurs qui ont guidé le choix.
+ */
+struct KmerPlan {
+    int reference_k = 0;               /**< Plus petit k dont l'unicité est proche de celle de k = 31 */
+    int smallest_k = 0;                /**< Plus petit k admis (unicité à moins de MAX_UNIQUENESS_LOSS de k = 31) */
+    int primary_k = 0;                 /**< k de l'index principal */
+    int secondary_k = 0;               /**< k du second index, plus petit (0 = un seul index) */
+    double read_error_rate = 0.0;      /**< Divergence estimée des reads (erreurs et variants) par base */
+    double quality_error_rate = -1.0;  /**< Taux d'erreur déduit des qualités (-1 = reads sans qualités) */
+    std::size_t sampled_reads = 0;     /**< Reads de l'échantillon */
+    std::size_t on_target_reads = 0;   /**< Reads de l'échantillon retrouvés sur la référence par la sonde */
+    std::size_t secondary_reads = 0;   /**< Reads de l'échantillon confiés au second index */
+    double primary_only_sensitivity = 0.0; /**< Part des reads avec assez de graines attendues au seul k principal */
+    double planned_sensitivity = 0.0;  /**< Même part avec la répartition entre les deux index */
+    std::size_t primary_bytes = 0;     /**< Empreinte estimée de l'index principal */
+    std::size_t secondary_bytes = 0;   /**< Empreinte estimée du second index */
+
+    /**
+     * @brief Affiche le choix et ses indicateurs
+     * @param out Flux de sortie
+     */
+    void print(std::ostream& out) const;
+};
+
+/**
+ * @class KmerSelector
+ * @brief Choisit la taille des k-mers à partir de la référence et d'un échantillon des reads.
+ *
+ * - Référence : pour chaque k candidat, deux passes estiment les k-mers distincts (HyperLogLog) et la part des
+ *   positions à k-mer unique (occurrences exactes des k-mers d'un échantillon régulier de positions). En dessous
+ *   de reference_k, les graines deviennent répétées et multiplient les votes ; en dessous de smallest_k, le coût
+ *   n'est plus acceptable même pour une partie des reads.
+ * - Reads : un échantillon régulier de SAMPLE_READS reads est comparé à la référence à smallest_k ; la part de
+ *   k-mers retrouvés h d'un read sur la cible, corrigée des rencontres dues au hasard, donne sa divergence
+ *   1 - h^(1/k), moyennée par classe de longueur (puissances de 2). Les qualités, si elles existent, donnent le
+ *   taux de chaque read.
+ * - Choix : le k idéal d'un read est le plus grand k de [smallest_k, reference_k] dont au moins
+ *   MIN_CLEAN_KMER_SHARE des k-mers sont attendus sans erreur ((1 - e)^k, comme le seuil "error" du Mapper), avec
+ *   au moins MIN_EXPECTED_SEEDS graines ((L - k + 1)(1 - e)^k). L'index principal prend le k idéal médian ; un
+ *   second index au 5e centile est ajouté si au moins MIN_SECONDARY_SHARE des reads en ont besoin.
+ */
+class KmerSelector {
+public:
+    static constexpr std::size_t SAMPLE_READS = 2000;    /**< Taille de l'échantillon de reads */
+    static constexpr double MIN_EXPECTED_SEEDS = 4.0;    /**< k-mers sans erreur attendus par read */
+    static constexpr double MIN_CLEAN_KMER_SHARE = 0.5;  /**< Part des k-mers d'un read attendus sans erreur */
+    static constexpr double UNIQUENESS_TOLERANCE = 0.01; /**< Écart toléré à l'unicité de k = 31 (reference_k) */
+    static constexpr double MAX_UNIQUENESS_LOSS = 0.1;   /**< Écart maximal à l'unicité de k = 31 (smallest_k) */
+    static constexpr double MIN_SECONDARY_SHARE = 0.01;  /**< Part minimale de reads justifiant un second index */
+
+    /**
+     * @brief Calcule la courbe d'unicité de la référence pour les k candidats
+     * @param genome Texte concaténé de la référence
+     */
+    void profileReference(const std::string& genome);
+
+    /**
+     * @brief Estime la divergence d'un échantillon des reads et choisit les tailles de k-mers
+     * @param reads Reads à mapper
+     * @param genome Texte concaténé de la référence (le même que pour profileReference)
+     * @return Le choix
+     */
+    const KmerPlan& choose(const std::vector<Sequence>& reads, const std::string& genome);
+
+    /**
+     * @brief Indique si un read doit être mappé avec le second index
+     */
+    bool useSecondary(const Sequence& read) const;
+
+    /**
+     * @brief Plus grand k candidat de [smallest_k, reference_k] qui laisse assez de k-mers sans erreur attendus
+     * @param length Longueur du read
+     * @param errorRate Divergence par base
+     * @return Le k, ou smallest_k si aucun ne suffit
+     */
+    int idealK(std::size_t length, double errorRate) const;
+
+    /**
+     * @brief Courbe d'unicité, par k croissant
+     */
+    const std::vector<UniquenessPoint>& getCurve() const;
+
+    /**
+     * @brief Dernier choix
+     */
+    const KmerPlan& getPlan() const;
+
+private:
+    /**
+     * @brief Divergence d'un read : par ses qualités (plus l'écart constaté par la sonde), sinon celle de sa classe
+     *        de longueur dans l'échantillon, sinon celle de tout l'échantillon
+     */
+    double readErrorRate(const Sequence& read) const;
+
+    /**
+     * @brief Classe de longueur d'un read : nombre de bits de sa longueur
+     */
+    static int lengthClass(std::size_t length);
+
+    static constexpr int LENGTH_CLASSES = 64; /**< Nombre de classes de longueur */
+
+    std::vector<UniquenessPoint> curve; /**< Courbe d'unicité */
+    KmerPlan plan;                      /**< Choix courant */
+    double qualityOffset = 0.0;         /**< Divergence non expliquée par les qualités (variants) */
+    std::vector<double> rateByLength;   /**< Divergence moyenne par classe de longueur (-1 = classe absente) */
+};
+
+#endif
@@ -7,100 +7,501 @@
 #include "ReadFasta.hpp"
 #include "ReadFastq.hpp"
 #include "Utils.hpp"
+#include "QualityHistogram.hpp"
+#include "RunStats.hpp"
+#include "IndexPlanner.hpp"
+#include "KmerCodec.hpp"
+#include "ShardedMapper.hpp"
+#include "ExternalSorter.hpp"
+#include "CoverageTrack.hpp"
+#include "Pileup.hpp"
+#include "ReadSampler.hpp"
 #include <iostream>
+#include <filesystem>
 #include <fstream>
-#include <unordered_map>
-#include <map>
 #include <algorithm>
-#include <numeric>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <limits>
+#include <sstream>
+
+namespace {
+
+/**
+ * @struct MappingScratch
+ * @brief Tampons de travail de l'analyse d'un read, propres à chaque thread et réutilisés d'un read à l'autre :
+ * une fois leur capacité atteinte, l'analyse ne fait plus aucune allocation.
+ */
+struct MappingScratch {
+    std::vector<int> votes;   /**< Position de départ estimée pour chaque occurrence de k-mer retrouvée */
+    std::vector<int> lookup;  /**< Positions fusionnées (couche delta) ou décodées (listes compressées) d'un k-mer */
+    std::vector<KmerHit> hits; /**< k-mers du read retrouvés dans l'index */
+};
+
+thread_local MappingScratch scratch;
+
+/**
+ * @struct IndexProber
+ * @brief Recherche des k-mers codés d'un read dans l'index, précédée du test du filtre d'appartenance
+ * s'il est activé. Les compteurs sont locaux au read et publiés une seule fois (voir publish).
+ */
+struct IndexProber {
+    const KmerIndex& index;   /**< Index interrogé */
+    const bool instrumented;  /**< Instrumentation active ? */
+    const bool filtered;      /**< Filtre d'appartenance présent ? */
+    std::uint64_t probes = 0, fallbacks = 0;
+    std::uint64_t filterQueries = 0, filterRejections = 0, filterFalsePositives = 0;
+
+    IndexProber(const KmerIndex& index, bool instrumented)
+        : index(index), instrumented(instrumented), filtered(!index.getPrefilter().empty()) {}
+
+    /**
+     * @brief Positions d'un k-mer codé (vide si absent ou écarté par le filtre)
+     */
+    PositionSpan probe(std::uint64_t code) {
+        if (!index.mayContain(code)) {
+            if (instrumented) {
+                filterQueries++;
+                filterRejections++;
+            }
+            return PositionSpan();
+        }
+        PositionSpan found = index.lookup(code, scratch.lookup);
+        if (instrumented) {
+            probes++;
+            filterQueries += filtered ? 1 : 0;
+            filterFalsePositives += filtered && found.empty() ? 1 : 0;
+        }
+        return found;
+    }
+
+    /**
+     * @brief Ajoute les compteurs du read aux compteurs globaux
+     */
+    void publish(RunStats& stats) const {
+        stats.add(Counter::IndexProbes, probes);
+        stats.add(Counter::ReverseComplementFallbacks, fallbacks);
+        if (filtered) {
+            stats.add(Counter::PrefilterQueries, filterQueries);
+            stats.add(Counter::PrefilterRejections, filterRejections);
+            stats.add(Counter::PrefilterFalsePositives, filterFalsePositives);
+        }
+    }
+};
+
+/**
+ * @brief Transmet un à un les reads valides des fichiers FASTA/FASTQ d'un répertoire, sans les accumuler
+ */
+void streamReadsFromDirectory(const std::string& dirPath, const std::function<void(Sequence&&)>& onRead) {
+    std::vector<std::string> files = listFilesInDirectory(dirPath);
+
+    for (const auto& file : files) {
+        std::string format = detectFileFormat(file);
+        std::cout << "Fichier : " << file << " | Format détecté : " << format << "\n";
+        if (format != "fasta" && format != "fastq") {
+            std::cerr << "Error: Unknown format for " << file << ". Ignored.\n";
+            continue;
+        }
+
+        std::ifstream in(file);
+        if (!in) {
+            std::cerr << "Error: Cannot open file " << file << std::endl;
+        }
+        std::size_t valid = 0;
+        auto counted = [&](Sequence&& read) {
+            valid++;
+            onRead(std::move(read));
+        };
+        if (format == "fasta") {
+            ReadFasta(file).stream(in, counted);
+        } else {
+            ReadFastq(file).stream(in, counted);
+        }
+        if (valid == 0) {
+            std::cerr << "Warning: No valid reads in " << file << ". Ignored.\n";
+        }
+    }
+}
+
+} // namespace
 
 Mapper::Mapper(int k) : k(k), genomeIndex(k) {}
 
-std::vector<Sequence> Mapper::getReads() const {
+const std::vector<Sequence>& Mapper::getReads() const {
     return reads;
 }
 
-void Mapper::loadReference(const std::string& filename) {
-    ReadFasta fastaReader(filename);
-    fastaReader.load();
+const std::vector<MappingResult>& Mapper::getResults() const {
+    return results;
+}
+
+bool Mapper::loadReference(const std::string& filename, std::size_t maxIndexBytes) {
+    if (isIndexFile(filename)) {
+        return loadIndex(filename);
+    }
 
-    std::cout << "Indexing genome...\n";
     std::string genome;
+    std::vector<Contig> contigs;
+    parseReference(filename, genome, contigs);
+    return indexReference(std::move(genome), std::move(contigs), maxIndexBytes);
+}
+
+void Mapper::parseReference(const std::string& filename, std::string& genome, std::vector<Contig>& contigs) {
+    ScopedStageTimer timer(Stage::ReferenceParse);
+    ReadFasta fastaReader(filename);
+    fastaReader.load();
     for (const auto& seq : fastaReader.getSequences()) {
+        Contig contig;
+        contig.name = seq.getId();
+        contig.start = genome.size();
+        contig.length = seq.getSequence().size();
+        contigs.push_back(contig);
         genome += seq.getSequence();
     }
-    genomeIndex.indexGenome(genome);
+}
+
+bool Mapper::indexReference(std::string genome, std::vector<Contig> contigs, std::size_t maxIndexBytes) {
+    RunStats& stats = RunStats::instance();
+    if (maxIndexBytes > 0) {
+        // Choix de l'organisation avant toute construction : on échoue tôt si rien ne tient
+        std::vector<LayoutEstimate> estimates = estimateLayouts(genome, k);
+        printLayoutEstimates(std::cout, estimates, maxIndexBytes);
+        LayoutEstimate chosen;
+        if (!chooseLayout(estimates, maxIndexBytes, chosen)) {
+            std::cerr << "Error: No index layout fits in --max-index-mem " << formatBytes(maxIndexBytes);
+            if (!estimates.empty()) {
+                std::cerr << " (smallest: " << estimates.back().layout.name() << ", "
+                          << formatBytes(estimates.back().bytes) << ")";
+            }
+            std::cerr << ". Increase the budget.\n";
+            return false;
+        }
+        genomeIndex.setLayout(chosen.layout);
+        std::cout << "Organisation de l'index retenue : " << chosen.layout.name()
+                  << " (estimation " << formatBytes(chosen.bytes) << ")\n";
+        if (stats.isEnabled()) {
+            stats.setInfo("index_memory_budget_bytes", static_cast<double>(maxIndexBytes));
+            stats.setInfo("index_estimated_bytes", static_cast<double>(chosen.bytes));
+        }
+    }
+
+    std::cout << "Indexing genome...\n";
+    {
+        ScopedStageTimer timer(Stage::IndexBuild);
+        genomeIndex.indexGenome(std::move(genome), std::move(contigs));
+    }
+    recordIndexInfo();
+    return true;
+}
+
+bool Mapper::isIndexFile(const std::string& filename) {
+    const std::string extension = ".kidx";
+    return filename.size() > extension.size() &&
+           filename.compare(filename.size() - extension.size(), extension.size(), extension) == 0;
+}
+
+bool Mapper::loadIndex(const std::string& filename) {
+    int fileK = KmerIndex::readK(filename);
+    if (fileK != 0 && fileK != k) {
+        std::cerr << "Error: " << filename << " was built with k=" << fileK << ", not k=" << k << ".\n";
+        return false;
+    }
+
+    std::cout << "Chargement de l'index " << filename << "...\n";
+    {
+        ScopedStageTimer timer(Stage::IndexBuild);
+        if (!genomeIndex.load(filename)) return false;
+    }
+    if (genomeIndex.hasPendingUpdates()) {
+        std::cout << "Mises à jour en attente de compactage : recherches fusionnées base + delta\n";
+    }
+
+    if (RunStats::instance().isEnabled()) RunStats::instance().setInfo("index_file", filename);
+    recordIndexInfo();
+    return true;
+}
+
+void Mapper::setK(int newK) {
+    k = newK;
+    genomeIndex.setK(newK);
+}
+
+void Mapper::setPrefilter(double bitsPerKmer) {
+    genomeIndex.setPrefilter(bitsPerKmer);
+}
+
+void Mapper::recordIndexInfo() const {
+    const KmerPrefilter& prefilter = genomeIndex.getPrefilter();
+    if (!prefilter.empty()) {
+        std::cout << "Filtre d'appartenance : " << formatBytes(prefilter.memoryUsage()) << ", "
+                  << prefilter.bitsPerKmer() << " bits/k-mer, " << prefilter.hashCount()
+                  << " bits testés, faux positifs attendus " << prefilter.expectedFalsePositiveRate() * 100 << "%\n";
+    }
+
+    RunStats& stats = RunStats::instance();
+    if (!stats.isEnabled()) return;
+    stats.setInfo("index_layout", genomeIndex.getLayout().name());
+    stats.setInfo("index_bytes", static_cast<double>(genomeIndex.memoryUsage()));
+    stats.setInfo("distinct_kmers", static_cast<double>(genomeIndex.distinctKmers()));
+    if (!prefilter.empty()) {
+        stats.setInfo("prefilter_bytes", static_cast<double>(prefilter.memoryUsage()));
+        stats.setInfo("prefilter_bits_per_kmer", prefilter.bitsPerKmer());
+        stats.setInfo("prefilter_hashes", static_cast<double>(prefilter.hashCount()));
+        stats.setInfo("prefilter_expected_false_positive_rate", prefilter.expectedFalsePositiveRate());
+    }
 }
 
 void Mapper::loadReadsFromDirectory(const std::string& dirPath) {
-    std::vector<std::string> files = listFilesInDirectory(dirPath);
+    ScopedStageTimer timer(Stage::ReadIngestion);
+    streamReadsFromDirectory(dirPath, [this](Sequence&& read) { reads.push_back(std::move(read)); });
+}
 
-    for (const auto& file : files) {
-        std::string format = detectFileFormat(file);
-        std::cout << "Fichier : " << file << " | Format détecté : " << format << "\n";
+std::uint64_t Mapper::sampleReadsFromDirectory(const std::string& dirPath, std::size_t sampleSize,
+                                               std::uint64_t seed) {
+    ScopedStageTimer timer(Stage::ReadIngestion);
+    ReadSampler sampler(sampleSize, seed);
+    streamReadsFromDirectory(dirPath, [&sampler](Sequence&& read) { sampler.offer(std::move(read)); });
+    reads = sampler.takeSample();
+    results.clear();
+    return sampler.seen();
+}
 
-        if (format == "fasta") {
-            ReadFasta fastaReader(file);
-            fastaReader.load();
-            std::vector<Sequence> validReads = fastaReader.getSequences();
-            if (!validReads.empty()) {
-                reads.insert(reads.end(), validReads.begin(), validReads.end());
-            } else {
-                std::cerr << "Warning: No valid reads in " << file << ". Ignored.\n";
-            }
+void Mapper::addReads(const std::vector<Sequence>& newReads) {
+    reads.insert(reads.end(), newReads.begin(), newReads.end());
+}
 
-        } else if (format == "fastq") {
-            ReadFastq fastqReader(file);
-            fastqReader.load();
-            std::vector<Sequence> validReads = fastqReader.getReads();
-            if (!validReads.empty()) {
-                reads.insert(reads.end(), validReads.begin(), validReads.end());
-            } else {
-                std::cerr << "Warning: No valid reads in " << file << ". Ignored.\n";
-            }
+ReadFilterReport Mapper::filterReads(const ReadFilterParams& params) {
+    ScopedStageTimer timer(Stage::ReadFilter);
+    ReadFilter filter(params);
+    filter.apply(reads);
+    return filter.getReport();
+}
 
-        } else {
-            std::cerr << "Error: Unknown format for " << file << ". Ignored.\n";
+void Mapper::mapReads(ThreadPool* pool) {
+    ScopedStageTimer timer(Stage::Mapping);
+    genomeIndex.finishCompaction(false); // point sûr : aucune recherche en cours
+
+    // analyzeRead est const et sans état partagé : les reads peuvent être analysés en parallèle
+    results.assign(reads.size(), MappingResult());
+    auto analyzeRange = [this](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            results[i] = analyzeRead(reads[i]);
         }
+    };
+    if (pool != nullptr && pool->size() > 1) {
+        pool->parallelFor(reads.size(), analyzeRange);
+    } else {
+        analyzeRange(0, reads.size());
     }
 }
 
-void Mapper::mapReads() {
-    for (const auto& read : reads) {
-        MappingResult result = analyzeRead(read);
-        mappings[read.getId()] = {result.start_pos};
-        strandInfo[read.getId()] = result.strand;
-        variations[read.getId()] = result.variation;
-        mappingResults[read.getId()] = result;
+std::size_t Mapper::mapReadsDispatched(const Mapper& secondary,
+                                       const std::function<bool(const Sequence&)>& toSecondary, ThreadPool* pool) {
+    ScopedStageTimer timer(Stage::Mapping);
+    genomeIndex.finishCompaction(false);
+    secondaryK = secondary.k;
+
+    // Le choix de l'index est fait read par read, dans la même passe parallèle que mapReads
+    results.assign(reads.size(), MappingResult());
+    std::vector<std::uint8_t> dispatched(reads.size(), 0);
+    auto analyzeRange = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            dispatched[i] = toSecondary(reads[i]) ? 1 : 0;
+            results[i] = dispatched[i] ? secondary.analyzeRead(reads[i]) : analyzeRead(reads[i]);
+        }
+    };
+    if (pool != nullptr && pool->size() > 1) {
+        pool->parallelFor(reads.size(), analyzeRange);
+    } else {
+        analyzeRange(0, reads.size());
     }
+    return static_cast<std::size_t>(std::count(dispatched.begin(), dispatched.end(), 1));
+}
+
+bool Mapper::mapReadsSharded(ShardedMapper& shards) {
+    ScopedStageTimer timer(Stage::Mapping);
+    return shards.mapReads(*this, reads, results);
 }
 
 void Mapper::exportMappingsToCSV(const std::string& filename) const {
+    ScopedStageTimer timer(Stage::Export);
     std::ofstream out(filename);
     if (!out.is_open()) {
         std::cerr << "Error: Cannot open output file " << filename << "\n";
         return;
     }
 
+    writeCsvSummary(out);
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        writeMappingRow(out, reads[i], i < results.size() ? results[i] : MappingResult());
+    }
+
+    out.close();
+}
+
+bool Mapper::exportSampleSummary(const std::string& filename, std::uint64_t population) const {
+    ScopedStageTimer timer(Stage::Export);
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open output file " << filename << "\n";
+        return false;
+    }
+
+    const std::uint64_t sampled = reads.size();
+    std::uint64_t mapped = 0, forward = 0;
+    const char* const variations[] = {"none", "mutation", "error"};
+    std::uint64_t variationCounts[3] = {0, 0, 0};
+    QualityHistogram qualities_all, qualities_mapped;
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        const bool aligned = i < results.size() && results[i].aligned;
+        if (aligned) {
+            mapped++;
+            forward += results[i].strand == Strand::Forward ? 1 : 0;
+            for (int v = 0; v < 3; ++v) {
+                if (std::strcmp(results[i].variation, variations[v]) == 0) variationCounts[v]++;
+            }
+        }
+        if (!reads[i].getQuality().empty()) {
+            int median = medianQuality(reads[i].getQuality());
+            qualities_all.add(median);
+            if (aligned) qualities_mapped.add(median);
+        }
+    }
+    // Population des reads alignés : estimée à partir de la proportion observée
+    const std::uint64_t mappedPopulation =
+        sampled > 0 ? static_cast<std::uint64_t>(static_cast<double>(population) * mapped / sampled + 0.5) : 0;
+
+    auto row = [&](const std::string& name, const SampleEstimate& estimate, double scale) {
+        out << name << ",";
+        if (estimate.defined) {
+            out << estimate.value * scale << "," << estimate.low * scale << "," << estimate.high * scale << "\n";
+        } else {
+            out << "NA,NA,NA\n";
+        }
+    };
+
+    out << "k-mer size," << k;
+    if (secondaryK > 0) out << "," << secondaryK;
+    out << "\n";
+    out << "input reads," << population << "\n";
+    out << "sampled reads," << sampled << "\n";
+    out << "\n";
+    out << "metric,estimate,ci95_low,ci95_high\n";
+    const SampleEstimate mappedRate = proportionEstimate(mapped, sampled, population);
+    row("mapped reads (%)", mappedRate, 100.0);
+    row("unmapped reads (%)", proportionEstimate(sampled - mapped, sampled, population), 100.0);
+    row("forward strand (% of mapped)", proportionEstimate(forward, mapped, mappedPopulation), 100.0);
+    row("reverse strand (% of mapped)", proportionEstimate(mapped - forward, mapped, mappedPopulation), 100.0);
+    for (int v = 0; v < 3; ++v) {
+        row(std::string("variation ") + variations[v] + " (% of mapped)",
+            proportionEstimate(variationCounts[v], mapped, mappedPopulation), 100.0);
+    }
+    if (qualities_all.count() > 0) {
+        row("median read quality (all reads)", medianEstimate(qualities_all, population), 1.0);
+        row("median read quality (mapped reads)", medianEstimate(qualities_mapped, mappedPopulation), 1.0);
+        row("mean read quality (mapped reads)", meanEstimate(qualities_mapped, mappedPopulation), 1.0);
+    }
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Error: Cannot write " << filename << "\n";
+        return false;
+    }
+
+    if (mappedRate.defined) {
+        std::cout << "Reads alignés (estimation sur " << sampled << " reads sur " << population << ") : "
+                  << mappedRate.value * 100.0 << " % [IC 95 % : " << mappedRate.low * 100.0 << " - "
+                  << mappedRate.high * 100.0 << " %]\n";
+    }
+    return true;
+}
+
+bool Mapper::exportSortedMappingsToCSV(const std::string& filename, std::size_t sortMemory,
+                                       CoverageTrack* coverage) const {
+    ScopedStageTimer timer(Stage::Export);
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open output file " << filename << "\n";
+        return false;
+    }
+    writeCsvSummary(out);
+
+    // Clé de tri : position de départ ; les reads non alignés passent après tous les autres
+    const std::int64_t unaligned = std::numeric_limits<std::int64_t>::max();
+    ExternalSorter sorter(filename, sortMemory);
+    std::ostringstream row;
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        MappingResult result = i < results.size() ? results[i] : MappingResult();
+        row.str("");
+        writeMappingRow(row, reads[i], result);
+        std::int64_t key = result.aligned ? result.start_pos : unaligned;
+        if (!sorter.add(key, result.end_pos + 1, row.str())) return false;
+    }
+
+    bool ok = sorter.merge([&](std::int64_t key, std::int64_t end, const std::string& line) {
+        if (coverage != nullptr && key != unaligned) {
+            coverage->add(key, end);
+        }
+        out << line;
+        return static_cast<bool>(out);
+    });
+    out.close();
+    if (!ok || out.fail()) {
+        std::cerr << "Error: Cannot write sorted results to " << filename << "\n";
+        return false;
+    }
+
+    RunStats& stats = RunStats::instance();
+    if (stats.isEnabled()) {
+        stats.setInfo("sort_memory_bytes", static_cast<double>(sortMemory));
+        stats.setInfo("sort_runs", static_cast<double>(sorter.runCount()));
+    }
+    return true;
+}
+
+bool Mapper::exportVariants(const std::string& filename, const PileupParams& params, ThreadPool* pool) const {
+    Pileup pileup(params);
+    {
+        ScopedStageTimer timer(Stage::Pileup);
+        pileup.run(genomeIndex.getGenome(), reads, results, pool);
+    }
+    pileup.getReport().print(std::cout);
+
+    RunStats& stats = RunStats::instance();
+    if (stats.isEnabled()) {
+        stats.setInfo("pileup_min_depth", params.min_depth);
+        stats.setInfo("pileup_min_allele_frequency", params.min_allele_frequency);
+        stats.setInfo("pileup_bases", static_cast<double>(pileup.getReport().bases));
+        stats.setInfo("pileup_covered_positions", static_cast<double>(pileup.getReport().covered_positions));
+        stats.setInfo("variant_sites", static_cast<double>(pileup.getReport().sites));
+    }
+
+    ScopedStageTimer timer(Stage::Export);
+    return pileup.writeCsv(filename, genomeIndex.getContigs());
+}
+
+void Mapper::writeCsvSummary(std::ostream& out) const {
     // Écriture des paramètres d'analyse
-    out << "k-mer size," << k << "\n";
+    out << "k-mer size," << k;
+    if (secondaryK > 0) out << "," << secondaryK;
+    out << "\n";
 
     // Statistiques globales
     int total_reads = static_cast<int>(reads.size());
     int mapped_reads = 0;
-    std::vector<int> qualities_all, qualities_mapped;
-
-    for (const auto& read : reads) {
+    // Histogrammes des qualités médianes par read : une seule passe, sans tri
+    QualityHistogram qualities_all, qualities_mapped;
 
-        const std::string& id = read.getId();
-        if (mappingResults.find(id) != mappingResults.end() && mappingResults.at(id).aligned) {
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        const Sequence& read = reads[i];
+        bool mapped = i < results.size() && results[i].aligned;
+        if (mapped) {
             mapped_reads++;
-            if (!read.getQuality().empty()) {
-                qualities_mapped.push_back(medianQuality(read.getQuality()));
-            }
         }
         if (!read.getQuality().empty()) {
-            qualities_all.push_back(medianQuality(read.getQuality()));
+            int median = medianQuality(read.getQuality());
+            qualities_all.add(median);
+            if (mapped) qualities_mapped.add(median);
         }
     }
 
@@ -113,107 +514,289 @@ void Mapper::exportMappingsToCSV(const std::string& filename) const {
     out << "unmapped reads," << unmapped_reads << "," << unmapped_percent << "%\n";
 
     // Statistiques de qualité si FASTQ
-    if (!qualities_all.empty()) {
-        std::sort(qualities_all.begin(), qualities_all.end());
-        std::sort(qualities_mapped.begin(), qualities_mapped.end());
-
-        int median_all = qualities_all[qualities_all.size() / 2];
-        int median_mapped = qualities_mapped.empty() ? -1 : qualities_mapped[qualities_mapped.size() / 2];
-        double mean_mapped = qualities_mapped.empty() ? 0.0 :
-            std::accumulate(qualities_mapped.begin(), qualities_mapped.end(), 0.0) / qualities_mapped.size();
-
-        out << "median read quality (all reads)," << median_all << "\n";
-        out << "median read quality (mapped reads)," << median_mapped << "\n";
-        out << "mean read quality (mapped reads)," << mean_mapped << "\n";
+    if (qualities_all.count() > 0) {
+        out << "median read quality (all reads)," << qualities_all.median() << "\n";
+        out << "median read quality (mapped reads)," << qualities_mapped.median() << "\n";
+        out << "mean read quality (mapped reads)," << qualities_mapped.mean() << "\n";
     }
 
     out << "\n";
 
     // En-tête du CSV
-    out << "read_id,sequence,alignment_percentage,start_position,variation_type,variation_position\n";
-
-    for (const auto& read : reads) {
-        const std::string& id = read.getId();
-        const std::string& seq = read.getSequence();
-        const MappingResult& result = mappingResults.at(id);
-
-        int total_kmers = static_cast<int>(seq.length()) - k + 1;
-        int aligned_kmers = static_cast<int>(result.aligned_kmer_indices.size());
-        double alignment_percentage = (total_kmers > 0) ? 100.0 * aligned_kmers / total_kmers : 0.0;
-
-        int variation_position = -1;
-        for (int i = 0; i <= static_cast<int>(seq.length()) - k; ++i) {
-            if (std::find(result.aligned_kmer_indices.begin(), result.aligned_kmer_indices.end(), i) == result.aligned_kmer_indices.end()) {
-                variation_position = i;
-                break;
-            }
-        }
+    out << CSV_HEADER << "\n";
+}
 
-        out << id << ","
-            << seq << ","
-            << alignment_percentage << ","
-            << result.start_pos << ","
-            << result.variation << ","
-            << variation_position << "\n";
-    }
+const char* const Mapper::CSV_HEADER =
+    "read_id,sequence,alignment_percentage,start_position,variation_type,variation_position,strand";
 
-    out.close();
+void Mapper::writeMappingRow(std::ostream& out, const Sequence& read, const MappingResult& result) const {
+    const std::string& id = read.getId();
+    const std::string& seq = read.getSequence();
+
+    const int kmerSize = result.kmer_size > 0 ? result.kmer_size : k;
+    int total_kmers = static_cast<int>(seq.length()) - kmerSize + 1;
+    double alignment_percentage = (total_kmers > 0) ? 100.0 * result.aligned_kmers / total_kmers : 0.0;
+
+    out << id << ","
+        << seq << ","
+        << alignment_percentage << ","
+        << result.start_pos << ","
+        << result.variation << ","
+        << result.first_unaligned_kmer << ","
+        << strandSymbol(result.strand) << "\n";
+}
+
+int Mapper::getK() const {
+    return k;
 }
 
 KmerIndex& Mapper::getGenomeIndex() {
     return genomeIndex;
 }
 
-MappingResult Mapper::analyzeRead(const Sequence& read) {
-    MappingResult result;
-    std::string seq = read.getSequence();
-    int read_length = seq.length();
-    if (read_length < k) return result;
+void Mapper::setKSpecialization(bool enabled) {
+    specializeK = enabled;
+    genomeIndex.setKSpecialization(enabled);
+}
+
+MappingResult Mapper::analyzeRead(const Sequence& read) const {
+    return withKmerSize(k, specializeK, [this, &read](auto kmerSize) {
+        return analyzeReadWith(read, kmerSize);
+    });
+}
+
+template <typename KSize>
+MappingResult Mapper::analyzeReadWith(const Sequence& read, KSize kmerSize) const {
+    if (static_cast<int>(read.getSequence().length()) < kmerSize.size()) return MappingResult();
+    // Les tampons du thread sont réutilisés d'un read à l'autre
+    seedReadWith(read, 0, kmerSize, scratch.hits, scratch.votes);
+    return resolveRead(read, scratch.hits, scratch.votes);
+}
+
+void Mapper::seedRead(const Sequence& read, int positionOffset, std::vector<KmerHit>& hits, std::vector<int>& votes) const {
+    withKmerSize(k, specializeK, [&](auto kmerSize) {
+        seedReadWith(read, positionOffset, kmerSize, hits, votes);
+    });
+}
 
-    std::map<int, int> positionVotes;
-    std::string globalStrand = "";
-    int consistentHits = 0;
+template <typename KSize>
+void Mapper::seedReadWith(const Sequence& read, int positionOffset, KSize kmerSize,
+                          std::vector<KmerHit>& hits, std::vector<int>& votes) const {
+    const int k = kmerSize.size(); // constante à la compilation pour FixedK
+    const std::string& seq = read.getSequence();
+    const int read_length = static_cast<int>(seq.length());
+    hits.clear();
+    votes.clear();
+
+    // Instrumentation : compteurs locaux, publiés une seule fois à la fin du read
+    RunStats& stats = RunStats::instance();
+    const bool instrumented = stats.isEnabled();
+    std::chrono::steady_clock::time_point seedingStart;
+    if (instrumented) seedingStart = std::chrono::steady_clock::now();
+    IndexProber prober(genomeIndex, instrumented);
+
+    // k-mers du read et leurs complémentaires inverses codés en une passe glissante ;
+    // un k-mer contenant une base invalide n'est pas produit et ne vote pas
+    forEachKmerBothStrands(seq, kmerSize, [&](std::uint64_t forward, std::uint64_t reverse, std::size_t start) {
+        const int i = static_cast<int>(start);
+        Strand strand = Strand::Forward;
+        PositionSpan positions = prober.probe(forward);
+        if (positions.empty()) {
+            // Chercher le brin complémentaire inversé
+            strand = Strand::Reverse;
+            positions = prober.probe(reverse);
+            prober.fallbacks++;
+        }
+        if (positions.empty()) return;
+
+        // Un vote = une position de départ estimée. Sur le brin inverse, le k-mer d'indice i du read
+        // correspond au k-mer d'indice (read_length - k - i) du complémentaire inverse, qui est la séquence
+        // présente dans le génome
+        int offset = (strand == Strand::Reverse ? read_length - k - i : i) - positionOffset;
+        for (int pos : positions) {
+            votes.push_back(pos - offset);
+        }
+        KmerHit hit;
+        hit.kmer = i;
+        hit.strand = strand;
+        hit.votes = static_cast<std::uint32_t>(positions.size());
+        hits.push_back(hit);
+    });
+
+    if (instrumented) {
+        stats.addTime(Stage::Seeding, std::chrono::steady_clock::now() - seedingStart);
+        prober.publish(stats);
+    }
+}
 
-    for (int i = 0; i <= read_length - k; ++i) {
-        std::string kmer = seq.substr(i, k);
-        std::string strand;
-        std::vector<int> positions = genomeIndex.searchKmerWithStrand(kmer, strand);
+MappingResult Mapper::resolveRead(const Sequence& read, const std::vector<KmerHit>& hits, std::vector<int>& votes) const {
+    MappingResult result;
+    const int read_length = static_cast<int>(read.getSequence().length());
+    if (read_length < k) return result;
+    result.kmer_size = k;
+
+    RunStats& stats = RunStats::instance();
+    const bool instrumented = stats.isEnabled();
+    std::chrono::steady_clock::time_point votingStart;
+    if (instrumented) votingStart = std::chrono::steady_clock::now();
+
+    // Premier k-mer non aligné : premier indice absent des k-mers retrouvés (absent de l'index ou invalide)
+    int nextKmer = 0;
+    for (const KmerHit& hit : hits) {
+        if (hit.kmer != nextKmer) break;
+        ++nextKmer;
+    }
+    if (nextKmer <= read_length - k) result.first_unaligned_kmer = nextKmer;
+    result.aligned_kmers = static_cast<int>(hits.size());
+
+    // Brin dominant : celui de tous les k-mers retrouvés, "NA" s'ils ne sont pas cohérents
+    Strand globalStrand = hits.empty() ? Strand::None : hits.front().strand;
+    for (const KmerHit& hit : hits) {
+        if (hit.strand != globalStrand) {
+            globalStrand = Strand::None;
+            break;
+        }
+    }
 
-        if (!positions.empty()) {
-            for (int pos : positions) {
-                int estimatedStart = pos - i;
-                positionVotes[estimatedStart]++;
+    // Décompte des votes par tri : la position la plus soutenue l'emporte,
+    // la plus petite en cas d'égalité
+    std::size_t candidates = 0;
+    if (!votes.empty()) {
+        std::sort(votes.begin(), votes.end());
+        int bestPosition = votes[0];
+        std::size_t bestVotes = 0;
+        for (std::size_t run = 0; run < votes.size();) {
+            std::size_t end = run + 1;
+            while (end < votes.size() && votes[end] == votes[run]) ++end;
+            if (end - run > bestVotes) {
+                bestVotes = end - run;
+                bestPosition = votes[run];
             }
-            if (globalStrand.empty()) globalStrand = strand;
-            else if (globalStrand != strand) globalStrand = "NA";
-            result.aligned_kmer_indices.push_back(i);
-            ++consistentHits;
-        }
-    }
-
-    if (!positionVotes.empty()) {
-        /**
-        * lambda fonction utilisée pour comparer deux paires (clé, valeur) (ici, a et b).
-        * Elle retourne true si a.second < b.second, ce qui signifie qu’on veut le plus grand nombre de votes
-        */
-        auto best = std::max_element(positionVotes.begin(), positionVotes.end(),
-            [](const auto& a, const auto& b) {
-                return a.second < b.second;
-            });
-        result.start_pos = best->first;
+            ++candidates;
+            run = end;
+        }
+
+        result.start_pos = bestPosition;
         result.end_pos = result.start_pos + read_length - 1;
         result.strand = globalStrand;
         result.aligned = true;
 
         int totalKmers = read_length - k + 1;
-        int alignedCount = result.aligned_kmer_indices.size();
-
-        if (alignedCount < totalKmers * 0.5) {
+        if (result.aligned_kmers < totalKmers * 0.5) {
             result.variation = "error";
-        } else if (alignedCount < totalKmers) {
+        } else if (result.aligned_kmers < totalKmers) {
             result.variation = "mutation";
         }
     }
 
+    if (instrumented) {
+        stats.addTime(Stage::Voting, std::chrono::steady_clock::now() - votingStart);
+        stats.add(Counter::ReadsAnalyzed, 1);
+        stats.add(Counter::ReadsAligned, result.aligned ? 1 : 0);
+        stats.add(Counter::VotesCast, votes.size());
+        stats.add(Counter::CandidatePositions, candidates);
+        stats.updateMax(Counter::MaxCandidatesPerRead, candidates);
+    }
+
+    return result;
+}
+
+ScreenReport Mapper::screenReads(const ScreenParams& params, ThreadPool* pool) {
+    ScopedStageTimer timer(Stage::Mapping);
+    genomeIndex.finishCompaction(false); // point sûr : aucune recherche en cours
+
+    screenResults.assign(reads.size(), ScreenResult());
+    auto screenRange = [this, &params](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            screenResults[i] = screenRead(reads[i], params);
+        }
+    };
+    if (pool != nullptr && pool->size() > 1) {
+        pool->parallelFor(reads.size(), screenRange);
+    } else {
+        screenRange(0, reads.size());
+    }
+
+    ScreenReport report;
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        int length = static_cast<int>(reads[i].getSequence().length());
+        report.add(screenResults[i], length >= k ? static_cast<std::uint64_t>(length - k + 1) : 0);
+    }
+    return report;
+}
+
+ScreenResult Mapper::screenRead(const Sequence& read, const ScreenParams& params) const {
+    return withKmerSize(k, specializeK, [this, &read, &params](auto kmerSize) {
+        return screenReadWith(read, params, kmerSize);
+    });
+}
+
+template <typename KSize>
+ScreenResult Mapper::screenReadWith(const Sequence& read, const ScreenParams& params, KSize kmerSize) const {
+    ScreenResult result;
+    const int k = kmerSize.size();
+    const std::string& seq = read.getSequence();
+    const int lastKmer = static_cast<int>(seq.length()) - k; // indice du dernier k-mer du read
+
+    RunStats& stats = RunStats::instance();
+    const bool instrumented = stats.isEnabled();
+    IndexProber prober(genomeIndex, instrumented);
+
+    if (lastKmer >= 0) {
+        int misses = 0;
+        forEachKmerBothStrandsWhile(seq, kmerSize, [&](std::uint64_t forward, std::uint64_t reverse, std::size_t start) {
+            result.kmers_tested++;
+            bool hit = !prober.probe(forward).empty();
+            if (!hit) {
+                hit = !prober.probe(reverse).empty();
+                prober.fallbacks++;
+            }
+            if (hit && ++result.hits >= params.min_hits) {
+                result.on_target = true;
+                return false;
+            }
+            misses += hit ? 0 : 1;
+            // Hors cible dès que les k-mers restants ne peuvent plus atteindre min_hits
+            int remaining = lastKmer - static_cast<int>(start);
+            return !(params.max_misses > 0 && misses >= params.max_misses) && result.hits + remaining >= params.min_hits;
+        });
+    }
+
+    if (instrumented) {
+        stats.add(Counter::ReadsAnalyzed, 1);
+        stats.add(Counter::ReadsAligned, result.on_target ? 1 : 0);
+        prober.publish(stats);
+    }
     return result;
-}
\ No newline at end of file
+}
+
+bool Mapper::exportScreenedReads(const std::string& outputDir, const ScreenReport& report) const {
+    ScopedStageTimer timer(Stage::Export);
+    const std::filesystem::path dir(outputDir);
+
+    // Un fichier par classe et par format, ouvert au premier read qui le concerne
+    std::ofstream outputs[2][2]; // [sur la cible][FASTQ]
+    for (std::size_t i = 0; i < reads.size() && i < screenResults.size(); ++i) {
+        const bool onTarget = screenResults[i].on_target;
+        const bool fastq = !reads[i].getQuality().empty();
+        std::ofstream& out = outputs[onTarget][fastq];
+        if (!out.is_open()) {
+            std::string name = std::string(onTarget ? "on_target" : "off_target") + (fastq ? ".fastq" : ".fasta");
+            out.open(dir / name);
+            if (!out.is_open()) {
+                std::cerr << "Error: Cannot open output file " << (dir / name).string() << "\n";
+                return false;
+            }
+        }
+        reads[i].write(out);
+    }
+
+    std::ofstream summary(dir / "screen_summary.csv");
+    if (!summary.is_open()) {
+        std::cerr << "Error: Cannot open output file " << (dir / "screen_summary.csv").string() << "\n";
+        return false;
+    }
+    summary << "k-mer size," << k << "\n";
+    report.writeCsv(summary);
+    return true;
+}
@@ -8,21 +8,41 @@
 
 #include "KmerIndex.hpp"
 #include "Sequence.hpp"
+#include "ReadFilter.hpp"
+#include "ReadScreen.hpp"
+#include "ThreadPool.hpp"
+#include <functional>
+#include <ostream>
 #include <vector>
-#include <unordered_map>
 #include <string>
 
+class CoverageTrack;
+struct PileupParams;
+class ShardedMapper;
+
 /**
  * @struct MappingResult
  * @brief Contient les résultats d'analyse d'un read : position, brin, cohérence et variation potentielle.
  */
 struct MappingResult {
     bool aligned = false;                          /**< Le read est-il aligné de façon cohérente ? */
-    std::string strand = "NA";                     /**< Brin détecté pour l'alignement : '+', '-' ou 'NA' */
+    Strand strand = Strand::None;                  /**< Brin détecté pour l'alignement : '+', '-' ou 'NA' */
     int start_pos = -1;                            /**< Position de départ estimée du read sur le génome */
     int end_pos = -1;                              /**< Position de fin estimée du read sur le génome */
-    std::vector<int> aligned_kmer_indices;         /**< Indices des k-mers du read qui ont été trouvés dans l'index */
-    std::string variation = "none";                /**< Type de variation détectée : 'none', 'mutation', ou 'error' */
+    int aligned_kmers = 0;                         /**< Nombre de k-mers du read trouvés dans l'index */
+    int first_unaligned_kmer = -1;                 /**< Indice du premier k-mer du read absent de l'index (-1 si aucun) */
+    const char* variation = "none";                /**< Type de variation détectée : 'none', 'mutation', ou 'error' */
+    int kmer_size = 0;                             /**< Taille des k-mers de l'index qui a analysé le read (0 = aucun) */
+};
+
+/**
+ * @struct KmerHit
+ * @brief k-mer d'un read retrouvé dans l'index : indice dans le read, brin et nombre de votes qu'il apporte.
+ */
+struct KmerHit {
+    int kmer = 0;                  /**< Indice du k-mer dans le read */
+    Strand strand = Strand::None;  /**< Brin sur lequel il a été retrouvé */
+    std::uint32_t votes = 0;       /**< Nombre de votes apportés (consécutifs dans le tableau des votes) */
 };
 
 /**
@@ -47,9 +67,52 @@ public:
 
     /**
      * @brief Charge un fichier FASTA et indexe le génome pour les k-mers.
-     * @param filename chemin vers le fichier FASTA du génome de référence
+     *
+     * Si un budget mémoire est fourni, l'empreinte de chaque organisation de l'index est estimée
+     * avant la construction (longueur du génome et nombre de k-mers distincts) et la plus rapide
+     * qui tient dans le budget est retenue.
+     *
+     * Un fichier d'index enregistré (.kidx, voir KmerIndex::save) est chargé directement, avec sa couche delta.
+     *
+     * @param filename chemin vers le fichier FASTA du génome de référence, ou vers un index .kidx
+     * @param maxIndexBytes budget mémoire de l'index en octets (0 = pas de limite, index complet)
+     * @return false si aucune organisation ne tient dans le budget (l'index n'est alors pas construit)
+     */
+    bool loadReference(const std::string& filename, std::size_t maxIndexBytes = 0);
+
+    /**
+     * @brief Lit un FASTA de référence : séquences concaténées et bornes des contigs
+     * @param filename chemin vers le fichier FASTA
+     * @param genome Sortie : texte concaténé
+     * @param contigs Sortie : contigs dans l'ordre du fichier
+     */
+    static void parseReference(const std::string& filename, std::string& genome, std::vector<Contig>& contigs);
+
+    /**
+     * @brief Indexe une référence déjà lue (seconde moitié de loadReference pour un FASTA)
+     * @param genome Texte concaténé de la référence
+     * @param contigs Contigs de la référence
+     * @param maxIndexBytes budget mémoire de l'index en octets (0 = pas de limite, index complet)
+     * @return false si aucune organisation ne tient dans le budget
      */
-    void loadReference(const std::string& filename);
+    bool indexReference(std::string genome, std::vector<Contig> contigs, std::size_t maxIndexBytes = 0);
+
+    /**
+     * @brief Change la taille des k-mers (avant l'indexation de la référence)
+     * @param newK Nouvelle taille
+     */
+    void setK(int newK);
+
+    /**
+     * @brief Active le filtre d'appartenance des k-mers, testé avant chaque recherche dans l'index.
+     *
+     * Utile quand la plupart des k-mers des reads sont absents de la référence (échantillons contaminés
+     * ou dominés par l'hôte) : un k-mer absent est écarté en un accès mémoire. Peut être appelé avant
+     * ou après loadReference ; les résultats du mapping sont identiques.
+     *
+     * @param bitsPerKmer Bits de filtre par k-mer distinct (0 = pas de filtre)
+     */
+    void setPrefilter(double bitsPerKmer);
 
     /**
      * @brief Charge tous les reads valides à partir d'un répertoire contenant des fichiers FASTA/FASTQ.
@@ -57,10 +120,60 @@ public:
      */
     void loadReadsFromDirectory(const std::string& dirPath);
 
+    /**
+     * @brief Parcourt en flux les fichiers de reads d'un répertoire et ne garde qu'un échantillon uniforme
+     *
+     * Seul l'échantillon est conservé en mémoire (voir ReadSampler) ; il remplace les reads déjà chargés,
+     * dans l'ordre des fichiers.
+     *
+     * @param dirPath chemin vers le dossier contenant les fichiers de reads
+     * @param sampleSize nombre de reads conservés
+     * @param seed graine de l'échantillonnage
+     * @return nombre de reads valides parcourus
+     */
+    std::uint64_t sampleReadsFromDirectory(const std::string& dirPath, std::size_t sampleSize, std::uint64_t seed);
+
+    /**
+     * @brief Ajoute des reads déjà en mémoire (reads simulés, benchmarks).
+     * @param newReads Reads à ajouter
+     */
+    void addReads(const std::vector<Sequence>& newReads);
+
+    /**
+     * @brief Pré-filtre les reads chargés : découpe adaptateurs et extrémités 3' de faible qualité,
+     *        puis retire les reads trop courts ou de qualité insuffisante avant toute recherche dans l'index.
+     * @param params Seuils du filtre
+     * @return Les compteurs par étape
+     */
+    ReadFilterReport filterReads(const ReadFilterParams& params);
+
     /**
      * @brief Effectue le mapping de tous les reads valides sur le génome indexé.
+     * @param pool pool de threads utilisé pour analyser les reads en parallèle (nullptr = séquentiel)
+     */
+    void mapReads(ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Effectue le mapping de tous les reads sur une référence répartie entre plusieurs processus
+     *        (à la place de loadReference et mapReads) ; les résultats sont ceux d'un index unique.
+     * @param shards index répartis, déjà chargés
+     * @return false si un processus de travail a cessé de répondre
+     */
+    bool mapReadsSharded(ShardedMapper& shards);
+
+    /**
+     * @brief Effectue le mapping de tous les reads en confiant certains reads à un second index (k automatique)
+     *
+     * Chaque read est analysé par cet index, ou par celui de secondary si toSecondary le désigne ;
+     * les résultats restent dans l'ordre des reads et portent la taille de k-mers utilisée.
+     *
+     * @param secondary Mapper dont l'index, à un autre k, est déjà construit sur la même référence
+     * @param toSecondary Choix de l'index pour un read (appelé depuis plusieurs threads)
+     * @param pool pool de threads utilisé pour analyser les reads en parallèle (nullptr = séquentiel)
+     * @return Nombre de reads confiés au second index
      */
-    void mapReads();
+    std::size_t mapReadsDispatched(const Mapper& secondary, const std::function<bool(const Sequence&)>& toSecondary,
+                                   ThreadPool* pool = nullptr);
 
     /**
      * @brief Analyse un read pour déterminer sa position la plus probable dans le génome de référence.
@@ -73,7 +186,8 @@ public:
      * Le système de votes permet d'estimer, par consensus, la position la plus probable du read dans le génome :
      * plus une position reçoit de votes (soutien de plusieurs k-mers alignés de manière cohérente), plus elle est crédible.
      *
-     * Le mapping est également effectué sur le brin complémentaire inverse si nécessaire.
+     * Le mapping est également effectué sur le brin complémentaire inverse si nécessaire :
+     * un k-mer retrouvé sur le brin inverse vote pour la position du complémentaire inverse du read.
      * Le strand dominant est conservé sauf incohérence détectée.
      *
      * Une variation est annotée dans le résultat si :
@@ -84,7 +198,65 @@ public:
      * @return Un objet MappingResult contenant la position estimée, le brin, les indices des k-mers alignés,
      *         ainsi qu'un indicateur d'alignement réussi et un éventuel type de variation détectée.
      */
-    MappingResult analyzeRead(const Sequence& read);
+    MappingResult analyzeRead(const Sequence& read) const;
+
+    /**
+     * @brief Première moitié de analyzeRead : recherche des k-mers du read dans l'index, sans décision.
+     *
+     * Utilisée telle quelle par les fragments d'un index réparti (voir ShardedMapper) : les votes de plusieurs
+     * fragments peuvent être fusionnés avant d'appeler resolveRead.
+     *
+     * @param read Le read à analyser
+     * @param positionOffset Décalage ajouté aux positions de l'index (début du fragment dans la référence complète)
+     * @param hits Sortie : k-mers retrouvés, par indice croissant
+     * @param votes Sortie : positions de départ votées par chaque k-mer retrouvé, dans l'ordre de hits
+     */
+    void seedRead(const Sequence& read, int positionOffset, std::vector<KmerHit>& hits, std::vector<int>& votes) const;
+
+    /**
+     * @brief Seconde moitié de analyzeRead : position la plus soutenue, brin et variation à partir des k-mers retrouvés.
+     * @param read Le read analysé
+     * @param hits k-mers retrouvés, par indice croissant
+     * @param votes Votes correspondants (triés en place)
+     * @return Le résultat du mapping du read
+     */
+    MappingResult resolveRead(const Sequence& read, const std::vector<KmerHit>& hits, std::vector<int>& votes) const;
+
+    /**
+     * @brief Classe un read sur la cible ou hors cible, sans calculer de position.
+     *
+     * Les k-mers du read (et leurs complémentaires inverses) sont recherchés dans le même index que pour
+     * le mapping, sans votes ni variations ; le test s'arrête dès que la règle de params décide la classe.
+     *
+     * @param read Le read à cribler
+     * @param params Règle d'arrêt (min_hits doit être positif)
+     * @return La classe du read et le nombre de k-mers testés
+     */
+    ScreenResult screenRead(const Sequence& read, const ScreenParams& params) const;
+
+    /**
+     * @brief Crible tous les reads chargés (mode --screen), à la place de mapReads.
+     * @param params Règle d'arrêt
+     * @param pool pool de threads utilisé pour cribler les reads en parallèle (nullptr = séquentiel)
+     * @return Les compteurs du criblage
+     */
+    ScreenReport screenReads(const ScreenParams& params, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Écrit les reads criblés dans leur format d'origine, séparés selon leur classe :
+     * on_target.fastq / off_target.fastq (ou .fasta pour les reads sans qualité), et le résumé screen_summary.csv.
+     * @param outputDir dossier de sortie (existant)
+     * @param report compteurs renvoyés par screenReads
+     * @return false si un fichier n'a pas pu être écrit
+     */
+    bool exportScreenedReads(const std::string& outputDir, const ScreenReport& report) const;
+
+    /**
+     * @brief Active ou désactive les versions de l'indexation et de l'analyse spécialisées à la compilation
+     * pour les tailles de k-mer courantes (11, 15, 19, 21, 25, 31). Activées par défaut ; les résultats sont identiques.
+     * @param enabled false pour toujours utiliser le chemin générique
+     */
+    void setKSpecialization(bool enabled);
 
     /**
      * @brief Accès à l'index des k-mers du génome de référence.
@@ -95,25 +267,126 @@ public:
     /**
      * @brief Exporte tous les résultats du mapping dans un fichier CSV.
      * Le fichier contient : paramètres, ID du read, séquence, pourcentage d'alignement,
-     * position estimée, type de variation, position de la variation.
+     * position estimée, type de variation, position de la variation, brin.
      * @param filename chemin du fichier CSV de sortie
      */
     void exportMappingsToCSV(const std::string& filename) const;
 
+    /**
+     * @brief Exporte le résumé du mapping d'un échantillon de reads, avec des intervalles de confiance à 95 %
+     *
+     * Mêmes indicateurs que l'en-tête de exportMappingsToCSV, plus la répartition des brins et des types de
+     * variation parmi les reads alignés. Les proportions ont un intervalle de Wilson, la médiane un intervalle
+     * de statistiques d'ordre et la moyenne un intervalle normal, tous corrigés pour la population finie.
+     *
+     * @param filename chemin du fichier CSV de sortie
+     * @param population nombre de reads dont les reads chargés sont un échantillon
+     * @return false si le fichier ne peut pas être écrit
+     */
+    bool exportSampleSummary(const std::string& filename, std::uint64_t population) const;
+
+    /**
+     * @brief Exporte les résultats triés par position de départ (reads non alignés à la fin), par tri externe.
+     *
+     * Les lignes sont triées par séries d'au plus sortMemory octets, écrites dans des fichiers temporaires
+     * à côté du CSV, puis fusionnées. Pendant la fusion, les reads alignés alimentent les pistes de couverture.
+     * À position égale, l'ordre des reads est conservé.
+     *
+     * @param filename chemin du fichier CSV de sortie (mêmes colonnes que exportMappingsToCSV)
+     * @param sortMemory mémoire maximale des lignes en attente de tri
+     * @param coverage pistes de couverture à alimenter, déjà ouvertes (nullptr = aucune)
+     * @return false si un fichier n'a pas pu être écrit ou relu
+     */
+    bool exportSortedMappingsToCSV(const std::string& filename, std::size_t sortMemory, CoverageTrack* coverage) const;
+
+    /**
+     * @brief Empile les reads alignés sur la référence et exporte les sites variants (voir Pileup)
+     * @param filename chemin du fichier CSV des sites
+     * @param params seuils de profondeur et de fréquence allélique
+     * @param pool pool de threads utilisé pour empiler les tranches du génome en parallèle (nullptr = séquentiel)
+     * @return false si le fichier n'a pas pu être écrit
+     */
+    bool exportVariants(const std::string& filename, const PileupParams& params, ThreadPool* pool = nullptr) const;
+
+    /**
+     * @brief En-tête des lignes de résultats du CSV (sans retour à la ligne)
+     */
+    static const char* const CSV_HEADER;
+
+    /**
+     * @brief Écrit la ligne CSV de résultat d'un read (utilisée par l'export et par le serveur)
+     * @param out flux de sortie
+     * @param read le read analysé
+     * @param result le résultat de son analyse
+     */
+    void writeMappingRow(std::ostream& out, const Sequence& read, const MappingResult& result) const;
+
+    /**
+     * @brief Taille des k-mers utilisés
+     */
+    int getK() const;
+
     /**
     * @brief Retourne la liste des reads chargés
     * @return Vecteur de reads
     */
-    std::vector<Sequence> getReads() const;
+    const std::vector<Sequence>& getReads() const;
+
+    /**
+     * @brief Résultats du dernier mapReads, dans l'ordre des reads
+     */
+    const std::vector<MappingResult>& getResults() const;
+
+    /**
+     * @brief Indique si un chemin désigne un index enregistré (extension .kidx)
+     */
+    static bool isIndexFile(const std::string& filename);
 
 private:
+    /**
+     * @brief Écrit l'en-tête du CSV de résultats : paramètres, statistiques globales et noms des colonnes
+     */
+    void writeCsvSummary(std::ostream& out) const;
+
+    /**
+     * @brief Charge un index enregistré et vérifie sa taille de k-mers
+     */
+    bool loadIndex(const std::string& filename);
+
+    /**
+     * @brief Affiche le filtre d'appartenance et renseigne le rapport d'exécution sur l'index chargé
+     */
+    void recordIndexInfo() const;
+
+    /**
+     * @brief Corps de analyzeRead pour une taille de k-mer donnée
+     * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+     */
+    template <typename KSize>
+    MappingResult analyzeReadWith(const Sequence& read, KSize kmerSize) const;
+
+    /**
+     * @brief Corps de seedRead pour une taille de k-mer donnée
+     * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+     */
+    template <typename KSize>
+    void seedReadWith(const Sequence& read, int positionOffset, KSize kmerSize,
+                      std::vector<KmerHit>& hits, std::vector<int>& votes) const;
+
+    /**
+     * @brief Corps de screenRead pour une taille de k-mer donnée
+     * @param kmerSize Taille des k-mers : FixedK<K> ou DynamicK
+     */
+    template <typename KSize>
+    ScreenResult screenReadWith(const Sequence& read, const ScreenParams& params, KSize kmerSize) const;
+
     int k;    /**< Taille des k-mers utilisés */
+    int secondaryK = 0;  /**< Taille des k-mers du second index du dernier mapReadsDispatched (0 = aucun) */
+    bool specializeK = true;  /**< Utiliser les analyses spécialisées pour les k courants */
     KmerIndex genomeIndex;  /**< Index k-mer construit à partir du génome de référence */
     std::vector<Sequence> reads;  /**< Reads valides extraits des fichiers FASTA/FASTQ */
-    std::unordered_map<std::string, std::vector<int>> mappings;  /**< Positions de mapping pour chaque read */
-    std::unordered_map<std::string, std::string> strandInfo;     /**< Brin détecté pour chaque read */
-    std::unordered_map<std::string, std::string> variations;     /**< Type de variation détectée pour chaque read */
-    std::unordered_map<std::string, MappingResult> mappingResults; /**< Résultats complets de l'analyse pour chaque read */
+    std::vector<MappingResult> results;  /**< Résultat de l'analyse de chaque read (même ordre que reads) */
+    std::vector<ScreenResult> screenResults;  /**< Résultat du dernier criblage (même ordre que reads) */
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,390 @@
+/**
+ * @file MappingServer.cpp
+ * @brief Implémentation du serveur de mapping résident et du client en ligne de commande.
+ */
+
+#include "MappingServer.hpp"
+#include "ReadFasta.hpp"
+#include "ReadFastq.hpp"
+#include "Utils.hpp"
+#include <cerrno>
+#include <chrono>
+#include <csignal>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <streambuf>
+#include <thread>
+#include <vector>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+namespace {
+
+/** Nombre de reads analysés et renvoyés par lot */
+const std::size_t BATCH_SIZE = 4096;
+
+/** Positionné par SIGINT/SIGTERM, consulté par la boucle d'acceptation */
+volatile std::sig_atomic_t signalReceived = 0;
+
+void onStopSignal(int) {
+    signalReceived = 1;
+}
+
+/**
+ * @class FdStreamBuf
+ * @brief Tampon de flux au-dessus d'un descripteur de fichier (socket), en lecture et en écriture.
+ */
+class FdStreamBuf : public std::streambuf {
+public:
+    explicit FdStreamBuf(int fd) : fd(fd), input(65536), output(65536) {
+        setg(input.data(), input.data(), input.data());
+        setp(output.data(), output.data() + output.size());
+    }
+
+    ~FdStreamBuf() override {
+        sync();
+    }
+
+protected:
+    int_type underflow() override {
+        if (gptr() < egptr()) return traits_type::to_int_type(*gptr());
+        ssize_t received;
+        do {
+            received = ::read(fd, input.data(), input.size());
+        } while (received < 0 && errno == EINTR);
+        if (received <= 0) return traits_type::eof();
+        setg(input.data(), input.data(), input.data() + received);
+        return traits_type::to_int_type(*gptr());
+    }
+
+    int_type overflow(int_type c) override {
+        if (sync() != 0) return traits_type::eof();
+        if (!traits_type::eq_int_type(c, traits_type::eof())) {
+            *pptr() = traits_type::to_char_type(c);
+            pbump(1);
+        }
+        return traits_type::not_eof(c);
+    }
+
+    int sync() override {
+        const char* data = pbase();
+        std::size_t remaining = pptr() - pbase();
+        while (remaining > 0) {
+            ssize_t sent = ::write(fd, data, remaining);
+            if (sent < 0 && errno == EINTR) continue;
+            if (sent <= 0) {
+                setp(output.data(), output.data() + output.size());
+                return -1;
+            }
+            data += sent;
+            remaining -= sent;
+        }
+        setp(output.data(), output.data() + output.size());
+        return 0;
+    }
+
+private:
+    int fd;                    /**< Descripteur sous-jacent (non fermé par le tampon) */
+    std::vector<char> input;   /**< Tampon de lecture */
+    std::vector<char> output;  /**< Tampon d'écriture */
+};
+
+/**
+ * @brief Remplit une adresse de socket Unix, false si le chemin est trop long
+ */
+bool makeAddress(const std::string& path, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(address.sun_path)) {
+        std::cerr << "Error: Socket path too long: " << path << "\n";
+        return false;
+    }
+    std::strncpy(address.sun_path, path.c_str(), sizeof(address.sun_path) - 1);
+    return true;
+}
+
+/**
+ * @brief Statistiques d'une requête de mapping
+ */
+struct RequestStats {
+    std::size_t reads = 0;   /**< Reads analysés */
+    std::size_t mapped = 0;  /**< Reads placés */
+};
+
+/**
+ * @brief Analyse un lot de reads sur le pool partagé et écrit les lignes CSV correspondantes
+ */
+void mapBatch(const Mapper& mapper, ThreadPool& pool, std::vector<Sequence>& batch,
+              std::ostream& out, RequestStats& stats) {
+    if (batch.empty()) return;
+    std::vector<MappingResult> results(batch.size());
+    auto analyzeRange = [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            results[i] = mapper.analyzeRead(batch[i]);
+        }
+    };
+    if (pool.size() > 1) pool.parallelFor(batch.size(), analyzeRange);
+    else analyzeRange(0, batch.size());
+
+    for (std::size_t i = 0; i < batch.size(); ++i) {
+        mapper.writeMappingRow(out, batch[i], results[i]);
+        if (results[i].aligned) stats.mapped++;
+    }
+    stats.reads += batch.size();
+    batch.clear();
+    out.flush(); // renvoie le lot sans attendre la fin de la requête
+}
+
+/**
+ * @brief Lit un flux FASTA ou FASTQ (format déduit du premier caractère) et mappe ses reads par lots
+ * @return false si le format n'est pas reconnu
+ */
+bool mapStream(std::istream& in, const Mapper& mapper, ThreadPool& pool, std::ostream& out, RequestStats& stats) {
+    in >> std::ws;
+    int first = in.peek();
+    std::vector<Sequence> batch;
+    batch.reserve(BATCH_SIZE);
+    auto onRead = [&](Sequence&& read) {
+        batch.push_back(std::move(read));
+        if (batch.size() == BATCH_SIZE) mapBatch(mapper, pool, batch, out, stats);
+    };
+
+    if (first == '>' || first == ';') {
+        ReadFasta("").stream(in, onRead);
+    } else if (first == '@') {
+        ReadFastq("").stream(in, onRead);
+    } else if (first != std::char_traits<char>::eof()) {
+        return false;
+    }
+    mapBatch(mapper, pool, batch, out, stats);
+    return true;
+}
+
+} // namespace
+
+MappingServer::MappingServer(std::size_t threads, NumaPlacement placement)
+    : placement(placement), pool(threads, placement != NumaPlacement::Off) {}
+
+MappingServer::~MappingServer() {
+    stop();
+    // Attend la fin des connexions en cours : elles utilisent le pool et les index
+    std::unique_lock<std::mutex> lock(connectionsMutex);
+    connectionsDone.wait(lock, [this]() { return activeConnections == 0; });
+}
+
+bool MappingServer::addIndex(const std::string& name, const std::string& referencePath, int k,
+                             std::size_t maxIndexBytes, int prefilterBits) {
+    if (indexes.count(name) > 0) {
+        std::cerr << "Error: Index " << name << " is already loaded.\n";
+        return false;
+    }
+    auto mapper = std::make_unique<Mapper>(k);
+    std::cout << "Chargement de l'index " << name << " (" << referencePath << ")...\n";
+    mapper->setPrefilter(prefilterBits);
+    if (!mapper->loadReference(referencePath, maxIndexBytes)) {
+        return false;
+    }
+    if (placement == NumaPlacement::Replicate) {
+        int copies = mapper->getGenomeIndex().replicateBase(NumaTopology::system());
+        if (copies > 0) std::cout << "Index " << name << " copié sur " << copies << " nœuds NUMA\n";
+    }
+    indexes[name] = std::move(mapper);
+    return true;
+}
+
+bool MappingServer::listen(const std::string& path) {
+    sockaddr_un address;
+    if (!makeAddress(path, address)) return false;
+
+    listenFd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (listenFd < 0) {
+        std::cerr << "Error: Cannot create socket: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    ::unlink(path.c_str()); // socket laissée par une exécution précédente
+    if (::bind(listenFd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0 ||
+        ::listen(listenFd, 64) < 0) {
+        std::cerr << "Error: Cannot listen on " << path << ": " << std::strerror(errno) << "\n";
+        ::close(listenFd);
+        listenFd = -1;
+        return false;
+    }
+    socketPath = path;
+    return true;
+}
+
+void MappingServer::run() {
+    if (listenFd < 0) return;
+    std::signal(SIGINT, onStopSignal);
+    std::signal(SIGTERM, onStopSignal);
+    std::signal(SIGPIPE, SIG_IGN); // un client qui se déconnecte ne doit pas arrêter le serveur
+
+    std::cout << "Serveur prêt sur " << socketPath << " (" << indexes.size() << " index, "
+              << pool.size() << " threads de mapping)\n" << std::flush;
+
+    while (!stopping && !signalReceived) {
+        pollfd waiting{listenFd, POLLIN, 0};
+        int ready = ::poll(&waiting, 1, 200);
+        if (ready <= 0) continue; // délai écoulé ou signal : on revérifie l'arrêt
+
+        int clientFd = ::accept(listenFd, nullptr, nullptr);
+        if (clientFd < 0) continue;
+
+        {
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            activeConnections++;
+        }
+        std::thread([this, clientFd]() {
+            handleClient(clientFd);
+            ::close(clientFd);
+            std::lock_guard<std::mutex> lock(connectionsMutex);
+            activeConnections--;
+            connectionsDone.notify_all();
+        }).detach();
+    }
+
+    std::cout << "Arrêt du serveur...\n";
+    stop();
+}
+
+void MappingServer::stop() {
+    stopping = true;
+    if (listenFd >= 0) {
+        ::close(listenFd);
+        listenFd = -1;
+        ::unlink(socketPath.c_str());
+    }
+}
+
+void MappingServer::handleClient(int fd) {
+    // Flux distincts en lecture et en écriture : la fin de lecture (eof) ne doit pas bloquer les réponses
+    FdStreamBuf buffer(fd);
+    std::istream input(&buffer);
+    std::ostream output(&buffer);
+
+    std::string line;
+    if (!std::getline(input, line)) return;
+    std::istringstream request(line);
+    std::string command, indexName, path;
+    request >> command >> indexName;
+    std::getline(request >> std::ws, path); // le chemin peut contenir des espaces
+
+    if (command == "LIST") {
+        for (const auto& entry : indexes) {
+            output << entry.first << ",k=" << entry.second->getK() << ","
+                    << entry.second->getGenomeIndex().getLayout().name() << "\n";
+        }
+        output << "END\n" << std::flush;
+        return;
+    }
+
+    auto found = indexes.find(indexName);
+    if ((command != "MAP" && command != "STREAM") || (command == "MAP" && path.empty())) {
+        output << "ERROR Unknown request: " << line << "\nEND\n" << std::flush;
+        return;
+    }
+    if (found == indexes.end()) {
+        output << "ERROR Unknown index: " << indexName << "\nEND\n" << std::flush;
+        return;
+    }
+    const Mapper& mapper = *found->second;
+
+    std::uint64_t requestId = ++requestCounter;
+    auto start = std::chrono::steady_clock::now();
+    RequestStats stats;
+    std::string error;
+
+    output << Mapper::CSV_HEADER << "\n";
+    if (command == "STREAM") {
+        if (!mapStream(input, mapper, pool, output, stats)) {
+            error = "Unknown read format (expected FASTA or FASTQ)";
+        }
+    } else {
+        std::vector<std::string> files;
+        if (std::filesystem::is_directory(path)) files = listFilesInDirectory(path);
+        else files.push_back(path);
+        for (const auto& file : files) {
+            std::ifstream in(file);
+            if (!in) {
+                error = "Cannot open file " + file;
+                break;
+            }
+            if (!mapStream(in, mapper, pool, output, stats)) {
+                std::cerr << "Error: Unknown format for " << file << ". Ignored.\n";
+            }
+        }
+    }
+
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    double readsPerSecond = seconds > 0 ? stats.reads / seconds : 0.0;
+    if (!error.empty()) output << "ERROR " << error << "\n";
+    output << "# request=" << requestId << " reads=" << stats.reads << " mapped=" << stats.mapped
+            << " seconds=" << seconds << " reads_per_second=" << readsPerSecond << "\n"
+            << "END\n" << std::flush;
+
+    std::cout << "Requête " << requestId << " : " << command << " " << indexName
+              << (path.empty() ? "" : " " + path) << " | reads=" << stats.reads
+              << " mapped=" << stats.mapped << " secondes=" << seconds
+              << " reads/s=" << readsPerSecond << (error.empty() ? "" : " | erreur : " + error)
+              << "\n" << std::flush;
+}
+
+int runMappingClient(const std::string& socketPath, const std::string& indexName, const std::string& readsPath) {
+    sockaddr_un address;
+    if (!makeAddress(socketPath, address)) return 1;
+
+    int fd = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (fd < 0 || ::connect(fd, reinterpret_cast<sockaddr*>(&address), sizeof(address)) < 0) {
+        std::cerr << "Error: Cannot connect to " << socketPath << ": " << std::strerror(errno) << "\n";
+        if (fd >= 0) ::close(fd);
+        return 1;
+    }
+    std::signal(SIGPIPE, SIG_IGN);
+
+    FdStreamBuf buffer(fd);
+    std::iostream channel(&buffer);
+    std::thread sender;
+    if (indexName.empty()) {
+        channel << "LIST\n" << std::flush;
+    } else if (readsPath == "-") {
+        // Les reads sont envoyés depuis un second thread pendant que les résultats arrivent :
+        // sinon client et serveur pourraient se bloquer mutuellement sur des tampons de socket pleins
+        sender = std::thread([fd, &indexName]() {
+            FdStreamBuf sendBuffer(fd);
+            std::ostream out(&sendBuffer);
+            out << "STREAM " << indexName << "\n";
+            out << std::cin.rdbuf();
+            out.clear(); // entrée standard vide : rien n'a été copié, ce n'est pas une erreur
+            out.flush();
+            ::shutdown(fd, SHUT_WR);
+        });
+    } else {
+        // Le serveur lit lui-même les fichiers : on lui transmet un chemin absolu
+        std::error_code ec;
+        std::filesystem::path absolute = std::filesystem::absolute(readsPath, ec);
+        channel << "MAP " << indexName << " " << (ec ? readsPath : absolute.string()) << "\n" << std::flush;
+    }
+
+    int status = 1; // une réponse sans "END" signifie une connexion interrompue
+    std::string line;
+    while (std::getline(channel, line)) {
+        if (line == "END") {
+            if (status == 1) status = 0;
+            break;
+        }
+        if (line.rfind("ERROR ", 0) == 0) {
+            std::cerr << "Error: " << line.substr(6) << "\n";
+            status = 2;
+            continue;
+        }
+        std::cout << line << "\n";
+    }
+    if (sender.joinable()) sender.join();
+    ::close(fd);
+    return status;
+}
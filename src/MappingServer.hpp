@@ -0,0 +1,107 @@
+/**
+ * @file MappingServer.hpp
+ * @brief Déclaration du serveur de mapping résident (socket Unix) et du client associé.
+ */
+
+#ifndef MAPPINGSERVER_HPP
+#define MAPPINGSERVER_HPP
+
+#include "Mapper.hpp"
+#include "NumaTopology.hpp"
+#include "ThreadPool.hpp"
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+
+/**
+ * @class MappingServer
+ * @brief Garde un ou plusieurs index en mémoire et traite des requêtes de mapping reçues sur une socket Unix.
+ *
+ * Protocole texte, une requête par connexion :
+ * - "LIST" : liste des index chargés ;
+ * - "MAP <index> <chemin>" : mappe un fichier FASTA/FASTQ ou un dossier de reads lu par le serveur ;
+ * - "STREAM <index>" : mappe les reads FASTA/FASTQ envoyés à la suite de la requête, jusqu'à la fin
+ *   d'écriture du client (shutdown).
+ *
+ * La réponse reprend l'en-tête et les lignes du CSV de résultats, envoyées par lots au fil du mapping,
+ * puis une ligne "# request=... reads=... mapped=... seconds=... reads_per_second=..." et enfin "END".
+ * Une erreur est signalée par une ligne "ERROR <message>" suivie de "END".
+ *
+ * Chaque connexion est servie par son propre thread d'entrées-sorties ; l'analyse des reads est confiée
+ * au pool de threads partagé par toutes les connexions.
+ */
+class MappingServer {
+public:
+    /**
+     * @brief Constructeur
+     * @param threads Nombre de threads du pool de mapping (0 = nombre de cœurs)
+     * @param placement Placement NUMA des threads du pool et des index chargés
+     */
+    explicit MappingServer(std::size_t threads, NumaPlacement placement = NumaPlacement::Off);
+
+    /**
+     * @brief Arrête le serveur et supprime la socket
+     */
+    ~MappingServer();
+
+    /**
+     * @brief Charge et indexe une référence sous un nom donné
+     * @param name Nom de l'index dans les requêtes
+     * @param referencePath Génome de référence (FASTA)
+     * @param k Taille des k-mers
+     * @param maxIndexBytes Budget mémoire de l'index (0 = pas de limite)
+     * @param prefilterBits Bits par k-mer du filtre d'appartenance (0 = pas de filtre)
+     * @return false si l'index n'a pas pu être construit
+     */
+    bool addIndex(const std::string& name, const std::string& referencePath, int k, std::size_t maxIndexBytes,
+                  int prefilterBits = 0);
+
+    /**
+     * @brief Crée la socket d'écoute
+     * @param socketPath Chemin de la socket Unix
+     * @return false en cas d'erreur
+     */
+    bool listen(const std::string& socketPath);
+
+    /**
+     * @brief Accepte les connexions jusqu'à SIGINT/SIGTERM ou un appel à stop()
+     */
+    void run();
+
+    /**
+     * @brief Demande l'arrêt de la boucle d'acceptation
+     */
+    void stop();
+
+private:
+    /**
+     * @brief Traite une connexion (lecture de la requête, mapping, réponse)
+     */
+    void handleClient(int fd);
+
+    NumaPlacement placement;                                  /**< Placement NUMA du pool et des index */
+    ThreadPool pool;                                          /**< Pool de mapping partagé */
+    std::map<std::string, std::unique_ptr<Mapper>> indexes;   /**< Index chargés, par nom */
+    std::string socketPath;                                   /**< Chemin de la socket d'écoute */
+    int listenFd = -1;                                        /**< Descripteur de la socket d'écoute */
+    std::atomic<bool> stopping{false};                        /**< Arrêt demandé */
+    std::atomic<std::uint64_t> requestCounter{0};             /**< Numéro de la dernière requête */
+    std::mutex connectionsMutex;                              /**< Protège activeConnections */
+    std::condition_variable connectionsDone;                  /**< Signale la fin d'une connexion */
+    std::size_t activeConnections = 0;                        /**< Connexions en cours */
+};
+
+/**
+ * @brief Client en ligne de commande : envoie une requête au serveur et recopie la réponse sur la sortie standard
+ * @param socketPath Chemin de la socket du serveur
+ * @param indexName Nom de l'index ("" pour lister les index)
+ * @param readsPath Fichier ou dossier de reads, ou "-" pour envoyer l'entrée standard
+ * @return 0 en cas de succès
+ */
+int runMappingClient(const std::string& socketPath, const std::string& indexName, const std::string& readsPath);
+
+#endif
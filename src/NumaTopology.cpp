@@ -0,0 +1,126 @@
+/**
+ * @file NumaTopology.cpp
+ * @brief Implémentation de la lecture de la topologie NUMA et de l'épinglage des threads.
+ */
+
+#include "NumaTopology.hpp"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <sstream>
+#include <thread>
+#include <pthread.h>
+#include <sched.h>
+
+namespace {
+
+thread_local int threadNode = 0; // Nœud du thread courant (voir pinCurrentThread)
+
+} // namespace
+
+const NumaTopology& NumaTopology::system() {
+    static const NumaTopology topology;
+    return topology;
+}
+
+NumaTopology::NumaTopology() {
+    // Nœuds triés par numéro ; un nœud sans cœur (mémoire seule) n'est pas retenu
+    std::map<int, std::vector<int>> nodes;
+    std::error_code error;
+    for (const auto& entry : std::filesystem::directory_iterator("/sys/devices/system/node", error)) {
+        const std::string name = entry.path().filename().string();
+        if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+            name.find_first_not_of("0123456789", 4) != std::string::npos) {
+            continue;
+        }
+        std::ifstream in(entry.path() / "cpulist");
+        std::string list;
+        if (!std::getline(in, list)) continue;
+        std::vector<int> cpus = parseCpuList(list);
+        if (!cpus.empty()) nodes[std::stoi(name.substr(4))] = std::move(cpus);
+    }
+    for (auto& node : nodes) nodeCpus.push_back(std::move(node.second));
+
+    if (nodeCpus.empty()) {
+        std::vector<int> all;
+        const unsigned count = std::thread::hardware_concurrency();
+        for (unsigned cpu = 0; cpu < (count > 0 ? count : 1); ++cpu) all.push_back(static_cast<int>(cpu));
+        nodeCpus.push_back(std::move(all));
+    }
+}
+
+std::vector<int> NumaTopology::parseCpuList(const std::string& text) {
+    std::vector<int> cpus;
+    std::istringstream in(text);
+    std::string range;
+    while (std::getline(in, range, ',')) {
+        std::istringstream bounds(range);
+        int first = 0, last = 0;
+        char dash = 0;
+        if (!(bounds >> first)) continue; // plage illisible : ignorée
+        last = (bounds >> dash >> last && dash == '-') ? last : first;
+        for (int cpu = first; cpu <= last; ++cpu) cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+int NumaTopology::nodeCount() const {
+    return static_cast<int>(nodeCpus.size());
+}
+
+const std::vector<int>& NumaTopology::cpus(int node) const {
+    return nodeCpus[static_cast<std::size_t>(node)];
+}
+
+std::string NumaTopology::describe() const {
+    std::ostringstream out;
+    out << nodeCount() << (nodeCount() > 1 ? " nœuds NUMA (cœurs : " : " nœud NUMA (cœurs : ");
+    for (int node = 0; node < nodeCount(); ++node) {
+        out << (node > 0 ? " + " : "") << cpus(node).size();
+    }
+    out << ")";
+    return out.str();
+}
+
+bool NumaTopology::pinCurrentThread(int node) const {
+    threadNode = node;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus(node)) {
+        if (cpu < CPU_SETSIZE) CPU_SET(cpu, &set);
+    }
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+}
+
+void NumaTopology::runOnNode(int node, const std::function<void()>& fn) const {
+    std::thread worker([this, node, &fn] {
+        pinCurrentThread(node);
+        fn();
+    });
+    worker.join();
+}
+
+int NumaTopology::currentNode() {
+    return threadNode;
+}
+
+bool NumaTopology::parsePlacement(const std::string& text, NumaPlacement& placement) {
+    if (text == "off") {
+        placement = NumaPlacement::Off;
+    } else if (text == "pin") {
+        placement = NumaPlacement::Pin;
+    } else if (text == "replicate") {
+        placement = NumaPlacement::Replicate;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+const char* NumaTopology::placementName(NumaPlacement placement) {
+    switch (placement) {
+        case NumaPlacement::Pin: return "pin";
+        case NumaPlacement::Replicate: return "replicate";
+        default: return "off";
+    }
+}
@@ -0,0 +1,96 @@
+/**
+ * @file NumaTopology.hpp
+ * @brief Déclaration de la topologie NUMA de la machine et du placement des threads sur ses nœuds.
+ */
+
+#ifndef NUMATOPOLOGY_HPP
+#define NUMATOPOLOGY_HPP
+
+#include <functional>
+#include <string>
+#include <vector>
+
+/**
+ * @enum NumaPlacement
+ * @brief Placement des threads de mapping et de l'index sur les nœuds NUMA.
+ */
+enum class NumaPlacement {
+    Off,      /**< Threads et mémoire laissés au système (off) */
+    Pin,      /**< Threads répartis entre les nœuds et épinglés (pin) */
+    Replicate /**< Threads épinglés et couche de base de l'index copiée sur chaque nœud (replicate) */
+};
+
+/**
+ * @class NumaTopology
+ * @brief Nœuds NUMA et cœurs de chacun, lus dans /sys/devices/system/node.
+ *
+ * Sans cette arborescence (noyau sans NUMA, autre système), la machine est vue comme un seul nœud
+ * regroupant tous les cœurs. Aucune bibliothèque NUMA n'est nécessaire : la mémoire est placée par la
+ * règle du premier accès (une page est allouée sur le nœud du thread qui l'écrit en premier), en faisant
+ * écrire chaque copie par un thread épinglé sur le nœud visé (voir runOnNode).
+ */
+class NumaTopology {
+public:
+    /**
+     * @brief Topologie de la machine (lue une seule fois)
+     */
+    static const NumaTopology& system();
+
+    /**
+     * @brief Nombre de nœuds ayant des cœurs
+     */
+    int nodeCount() const;
+
+    /**
+     * @brief Cœurs d'un nœud
+     * @param node Nœud (0 à nodeCount() - 1)
+     */
+    const std::vector<int>& cpus(int node) const;
+
+    /**
+     * @brief Description courte, ex. "2 nœuds NUMA (cœurs : 16 + 16)"
+     */
+    std::string describe() const;
+
+    /**
+     * @brief Épingle le thread appelant sur les cœurs d'un nœud et en fait son nœud courant
+     * @param node Nœud
+     * @return false si le système refuse l'épinglage (le nœud courant est tout de même retenu)
+     */
+    bool pinCurrentThread(int node) const;
+
+    /**
+     * @brief Exécute fn dans un thread épinglé sur un nœud et attend sa fin
+     *
+     * La mémoire écrite en premier par fn est placée sur ce nœud.
+     */
+    void runOnNode(int node, const std::function<void()>& fn) const;
+
+    /**
+     * @brief Nœud courant du thread appelant, fixé par pinCurrentThread (0 par défaut)
+     */
+    static int currentNode();
+
+    /**
+     * @brief Lit un placement : off, pin ou replicate
+     * @return false si le texte n'est pas reconnu
+     */
+    static bool parsePlacement(const std::string& text, NumaPlacement& placement);
+
+    /**
+     * @brief Nom d'un placement (off, pin, replicate)
+     */
+    static const char* placementName(NumaPlacement placement);
+
+private:
+    NumaTopology();
+
+    /**
+     * @brief Lit une liste de cœurs au format du noyau (ex. "0-3,8-11")
+     */
+    static std::vector<int> parseCpuList(const std::string& text);
+
+    std::vector<std::vector<int>> nodeCpus; /**< Cœurs de chaque nœud */
+};
+
+#endif
@@ -0,0 +1,366 @@
+/**
+ * @file Options.cpp
+ * @brief Analyse de la ligne de commande du programme principal.
+ */
+
+#include "Options.hpp"
+#include "IndexPlanner.hpp"
+#include "KmerIndex.hpp"
+#include <iostream>
+
+namespace {
+
+/**
+ * @brief Convertit une valeur entière d'option, avec message d'erreur si invalide
+ */
+bool parseInt(const std::string& name, const std::string& value, int& out) {
+    try {
+        std::size_t used = 0;
+        out = std::stoi(value, &used);
+        if (used != value.size()) throw std::invalid_argument(value);
+        return true;
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+        return false;
+    }
+}
+
+/**
+ * @brief Convertit une fraction comprise entre 0 et 1, avec message d'erreur si invalide
+ */
+bool parseFraction(const std::string& name, const std::string& value, double& out) {
+    try {
+        std::size_t used = 0;
+        out = std::stod(value, &used);
+        if (used != value.size() || out < 0.0 || out > 1.0) throw std::invalid_argument(value);
+        return true;
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid value for " << name << " (expected a fraction between 0 and 1): " << value << "\n";
+        return false;
+    }
+}
+
+/**
+ * @brief Convertit un nombre de threads (0 = nombre de cœurs)
+ */
+bool parseThreads(const std::string& name, const std::string& value, std::size_t& out) {
+    int threads = 0;
+    if (!parseInt(name, value, threads)) return false;
+    if (threads < 0) {
+        std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+        return false;
+    }
+    out = static_cast<std::size_t>(threads);
+    return true;
+}
+
+/**
+ * @brief Lit le nombre de bits par k-mer du filtre d'appartenance (0 = désactivé)
+ */
+bool parsePrefilterBits(const std::string& name, const std::string& value, int& bits) {
+    if (!parseInt(name, value, bits)) return false;
+    if (bits < 0 || bits > 64) {
+        std::cerr << "Error: " << name << " must be between 0 and 64 bits per k-mer.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lit et valide la taille des k-mers
+ */
+bool parseK(const std::string& value, int& k) {
+    if (!parseInt("k-mer size", value, k)) return false;
+    if (k <= 0 || k > KmerIndex::MAX_K) {
+        std::cerr << "Error: k-mer size must be between 1 and " << KmerIndex::MAX_K << ".\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lit la politique de pages de l'index (off, thp ou hugetlb)
+ */
+bool parseHugePages(const std::string& name, const std::string& value, PagePolicy& policy) {
+    if (!IndexMemory::parse(value, policy)) {
+        std::cerr << "Error: " << name << " must be off, thp or hugetlb.\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Lit le placement NUMA (off, pin ou replicate)
+ */
+bool parseNumaPlacement(const std::string& name, const std::string& value, NumaPlacement& placement) {
+    if (!NumaTopology::parsePlacement(value, placement)) {
+        std::cerr << "Error: " << name << " must be off, pin or replicate.\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+void printUsage(std::ostream& out, const std::string& program) {
+    out << "Usage: " << program << " <reference.fasta> <reads_directory> <k-mer size|auto> [options]\n"
+        << "       " << program << " serve <socket> <k-mer size> <name>=<reference.fasta>... [--threads n] [--max-index-mem n] [--prefilter bits]\n"
+        << "                [--huge-pages p] [--numa m]\n"
+        << "       " << program << " client <socket> [<index> <reads_path|->]\n"
+        << "       " << program << " index build <reference.fasta> <k-mer size> <index.kidx> [--max-index-mem n | --index-layout l]\n"
+        << "       " << program << " index append <index.kidx> <sequences.fasta>\n"
+        << "       " << program << " index remove <index.kidx> <sequence name>...\n"
+        << "       " << program << " index compact|info <index.kidx>\n"
+        << "La référence peut être un index enregistré (.kidx) à la place d'un FASTA.\n"
+        << "Avec k = auto, la taille des k-mers est choisie d'après l'unicité de la référence et un échantillon\n"
+        << "des reads ; un second index à k plus petit est construit pour les reads courts ou bruités si besoin.\n"
+        << "Options :\n"
+        << "  --trim-quality <q>   découpe l'extrémité 3' des reads de qualité < q\n"
+        << "  --adapter <seq>      retire l'adaptateur <seq> (ou son préfixe) en 3'\n"
+        << "  --min-length <n>     rejette les reads plus courts que n après découpage\n"
+        << "  --min-quality <q>    rejette les reads de qualité médiane < q\n"
+        << "  --max-index-mem <n>  budget mémoire de l'index (ex. 512M, 4G) : choisit l'organisation qui tient\n"
+        << "  --index-layout <l>   impose l'organisation de l'index : full, sampled/<pas>, suivie ou non de\n"
+        << "                       +compressed (listes de positions compressées)\n"
+        << "  --report <file>      écrit un rapport JSON (temps par étape, compteurs, pic mémoire)\n"
+        << "  --output-dir <dir>   dossier des résultats (sinon demandé sur l'entrée standard)\n"
+        << "  --threads <n>        threads de mapping (0 = nombre de cœurs, 1 par défaut)\n"
+        << "  --prefilter <bits>   filtre de Bloom de <bits> bits par k-mer devant l'index (ex. 10) :\n"
+        << "                       écarte vite les k-mers absents (échantillons contaminés ou dominés par l'hôte)\n"
+        << "  --screen <hits>      criblage sans position : un read est sur la cible dès <hits> k-mers retrouvés ;\n"
+        << "                       écrit on_target / off_target (FASTQ ou FASTA) et screen_summary.csv\n"
+        << "  --screen-max-misses <n>  classe un read hors cible après n k-mers absents (0 = tous testés)\n"
+        << "  --shards <n>         répartit l'index entre n processus (références trop grandes pour un seul index) ;\n"
+        << "                       --max-index-mem s'applique alors à chaque fragment\n"
+        << "  --sort-mem <n>       trie mapping_results.csv par position (tri externe, n octets de lignes en mémoire,\n"
+        << "                       ex. 256M) et écrit coverage.bedgraph et coverage_bins.csv\n"
+        << "  --coverage-bin <n>   largeur des fenêtres de coverage_bins.csv (10000 par défaut)\n"
+        << "  --variants <depth>   empile les reads alignés et écrit dans variants.csv les allèles alternatifs\n"
+        << "                       des positions d'au moins <depth> bases\n"
+        << "  --min-af <f>         fréquence allélique minimale des sites de variants.csv (0.2 par défaut)\n"
+        << "  --sample <n>         estimation rapide : ne mappe qu'un échantillon uniforme de n reads, tiré en une\n"
+        << "                       lecture des fichiers, et écrit qc_summary.csv (intervalles de confiance à 95 %)\n"
+        << "  --sample-seed <s>    graine de l'échantillonnage (1 par défaut)\n"
+        << "  --huge-pages <p>     pages des tableaux de l'index : off (défaut), thp (pages transparentes de 2 Mio),\n"
+        << "                       hugetlb (pages réservées de hugetlbfs, sinon thp)\n"
+        << "  --numa <m>           placement sur les nœuds NUMA : off (défaut), pin (threads de mapping répartis\n"
+        << "                       et épinglés par nœud), replicate (pin, et une copie de l'index par nœud)\n";
+}
+
+bool parseOptions(int argc, char* argv[], RunOptions& options) {
+    if (argc < 4) {
+        printUsage(std::cerr, argv[0]);
+        return false;
+    }
+
+    options.reference = argv[1];
+    options.readsDirectory = argv[2];
+    if (std::string(argv[3]) == "auto") {
+        options.autoK = true;
+    } else if (!parseK(argv[3], options.k)) {
+        return false;
+    }
+
+    bool coverageBinSet = false;
+    bool minAlleleFrequencySet = false;
+    bool layoutSet = false;
+    bool sampleSeedSet = false;
+    for (int i = 4; i < argc; ++i) {
+        std::string name = argv[i];
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for option " << name << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (name == "--trim-quality") {
+            if (!parseInt(name, value, options.filter.trim_quality)) return false;
+        } else if (name == "--adapter") {
+            options.filter.adapter = value;
+        } else if (name == "--min-length") {
+            if (!parseInt(name, value, options.filter.min_length)) return false;
+        } else if (name == "--min-quality") {
+            if (!parseInt(name, value, options.filter.min_median_quality)) return false;
+        } else if (name == "--max-index-mem") {
+            if (!parseByteSize(value, options.maxIndexBytes) || options.maxIndexBytes == 0) {
+                std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+                return false;
+            }
+        } else if (name == "--index-layout") {
+            if (!IndexLayout::parse(value, options.layout)) {
+                std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+                return false;
+            }
+            layoutSet = true;
+        } else if (name == "--report") {
+            options.reportPath = value;
+        } else if (name == "--output-dir") {
+            options.outputDir = value;
+        } else if (name == "--threads") {
+            if (!parseThreads(name, value, options.threads)) return false;
+        } else if (name == "--prefilter") {
+            if (!parsePrefilterBits(name, value, options.prefilterBits)) return false;
+        } else if (name == "--screen") {
+            if (!parseInt(name, value, options.screen.min_hits)) return false;
+            if (options.screen.min_hits < 1) {
+                std::cerr << "Error: " << name << " needs at least 1 k-mer hit.\n";
+                return false;
+            }
+        } else if (name == "--screen-max-misses") {
+            if (!parseInt(name, value, options.screen.max_misses)) return false;
+        } else if (name == "--sort-mem") {
+            if (!parseByteSize(value, options.sortMemory) || options.sortMemory == 0) {
+                std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+                return false;
+            }
+        } else if (name == "--coverage-bin") {
+            int width = 0;
+            if (!parseInt(name, value, width)) return false;
+            if (width < 1) {
+                std::cerr << "Error: " << name << " needs at least 1 base.\n";
+                return false;
+            }
+            options.coverageBin = static_cast<std::size_t>(width);
+            coverageBinSet = true;
+        } else if (name == "--variants") {
+            if (!parseInt(name, value, options.pileup.min_depth)) return false;
+            if (options.pileup.min_depth < 1) {
+                std::cerr << "Error: " << name << " needs a depth of at least 1.\n";
+                return false;
+            }
+        } else if (name == "--min-af") {
+            if (!parseFraction(name, value, options.pileup.min_allele_frequency)) return false;
+            minAlleleFrequencySet = true;
+        } else if (name == "--sample") {
+            int size = 0;
+            if (!parseInt(name, value, size)) return false;
+            if (size < 1) {
+                std::cerr << "Error: " << name << " needs at least 1 read.\n";
+                return false;
+            }
+            options.sampleSize = static_cast<std::size_t>(size);
+        } else if (name == "--sample-seed") {
+            try {
+                std::size_t used = 0;
+                options.sampleSeed = std::stoull(value, &used);
+                if (used != value.size() || value[0] == '-') throw std::invalid_argument(value);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+                return false;
+            }
+            sampleSeedSet = true;
+        } else if (name == "--huge-pages") {
+            if (!parseHugePages(name, value, options.hugePages)) return false;
+        } else if (name == "--numa") {
+            if (!parseNumaPlacement(name, value, options.numa)) return false;
+        } else if (name == "--shards") {
+            if (!parseInt(name, value, options.shards)) return false;
+            if (options.shards < 1) {
+                std::cerr << "Error: " << name << " needs at least 1 shard.\n";
+                return false;
+            }
+        } else {
+            std::cerr << "Error: Unknown option " << name << "\n";
+            printUsage(std::cerr, argv[0]);
+            return false;
+        }
+    }
+    if (options.screen.max_misses < 0 || (options.screen.max_misses > 0 && !options.screen.enabled())) {
+        std::cerr << "Error: --screen-max-misses requires --screen and a non-negative value.\n";
+        return false;
+    }
+    if (coverageBinSet && options.sortMemory == 0) {
+        std::cerr << "Error: --coverage-bin requires --sort-mem.\n";
+        return false;
+    }
+    if (options.sortMemory > 0 && options.screen.enabled()) {
+        std::cerr << "Error: --sort-mem cannot be combined with --screen.\n";
+        return false;
+    }
+    if (layoutSet && options.maxIndexBytes > 0) {
+        std::cerr << "Error: --index-layout cannot be combined with --max-index-mem.\n";
+        return false;
+    }
+    if (sampleSeedSet && options.sampleSize == 0) {
+        std::cerr << "Error: --sample-seed requires --sample.\n";
+        return false;
+    }
+    if (options.sampleSize > 0 && (options.screen.enabled() || options.sortMemory > 0 || options.pileup.enabled())) {
+        std::cerr << "Error: --sample cannot be combined with --screen, --sort-mem or --variants.\n";
+        return false;
+    }
+    if (minAlleleFrequencySet && !options.pileup.enabled()) {
+        std::cerr << "Error: --min-af requires --variants.\n";
+        return false;
+    }
+    if (options.pileup.enabled() && (options.screen.enabled() || options.shards > 1)) {
+        std::cerr << "Error: --variants cannot be combined with --screen or --shards.\n";
+        return false;
+    }
+    if (options.numa != NumaPlacement::Off && (options.threads == 1 || options.shards > 1)) {
+        std::cerr << "Error: --numa requires --threads other than 1 and cannot be combined with --shards.\n";
+        return false;
+    }
+    if (options.autoK && (options.screen.enabled() || options.shards > 1)) {
+        std::cerr << "Error: k = auto cannot be combined with --screen or --shards.\n";
+        return false;
+    }
+    if (options.shards > 1 && options.screen.enabled()) {
+        std::cerr << "Error: --shards cannot be combined with --screen.\n";
+        return false;
+    }
+    return true;
+}
+
+bool parseServeOptions(int argc, char* argv[], ServeOptions& options) {
+    if (argc < 5) {
+        printUsage(std::cerr, argv[0]);
+        return false;
+    }
+
+    options.socketPath = argv[2];
+    if (!parseK(argv[3], options.k)) return false;
+
+    for (int i = 4; i < argc; ++i) {
+        std::string name = argv[i];
+        if (name.rfind("--", 0) != 0) {
+            std::size_t equal = name.find('=');
+            if (equal == std::string::npos || equal == 0 || equal + 1 == name.size()) {
+                std::cerr << "Error: Expected <name>=<reference.fasta>, got " << name << "\n";
+                return false;
+            }
+            options.references.emplace_back(name.substr(0, equal), name.substr(equal + 1));
+            continue;
+        }
+        if (i + 1 >= argc) {
+            std::cerr << "Error: Missing value for option " << name << "\n";
+            return false;
+        }
+        std::string value = argv[++i];
+
+        if (name == "--threads") {
+            if (!parseThreads(name, value, options.threads)) return false;
+        } else if (name == "--max-index-mem") {
+            if (!parseByteSize(value, options.maxIndexBytes) || options.maxIndexBytes == 0) {
+                std::cerr << "Error: Invalid value for " << name << ": " << value << "\n";
+                return false;
+            }
+        } else if (name == "--prefilter") {
+            if (!parsePrefilterBits(name, value, options.prefilterBits)) return false;
+        } else if (name == "--huge-pages") {
+            if (!parseHugePages(name, value, options.hugePages)) return false;
+        } else if (name == "--numa") {
+            if (!parseNumaPlacement(name, value, options.numa)) return false;
+        } else {
+            std::cerr << "Error: Unknown option " << name << "\n";
+            printUsage(std::cerr, argv[0]);
+            return false;
+        }
+    }
+
+    if (options.references.empty()) {
+        std::cerr << "Error: No reference to index (expected <name>=<reference.fasta>).\n";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,94 @@
+/**
+ * @file Options.hpp
+ * @brief Déclaration des options de la ligne de commande du programme principal.
+ */
+
+#ifndef OPTIONS_HPP
+#define OPTIONS_HPP
+
+#include "KmerIndex.hpp"
+#include "NumaTopology.hpp"
+#include "Pileup.hpp"
+#include "ReadFilter.hpp"
+#include "ReadScreen.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @struct RunOptions
+ * @brief Paramètres d'une exécution : arguments positionnels et options facultatives.
+ */
+struct RunOptions {
+    std::string reference;      /**< Génome de référence (FASTA) */
+    std::string readsDirectory; /**< Dossier contenant les fichiers de reads */
+    int k = 0;                  /**< Taille des k-mers (0 si elle est choisie automatiquement) */
+    bool autoK = false;         /**< Taille des k-mers choisie d'après la référence et les reads ("auto") */
+    ReadFilterParams filter;    /**< Seuils du pré-filtrage des reads */
+    std::size_t maxIndexBytes = 0; /**< Budget mémoire de l'index (0 = pas de limite) */
+    IndexLayout layout;         /**< Organisation imposée de l'index (sans budget mémoire) */
+    std::string reportPath;     /**< Rapport JSON de l'exécution (vide = instrumentation désactivée) */
+    std::string outputDir;      /**< Dossier des résultats (vide = demandé sur l'entrée standard) */
+    std::size_t threads = 1;    /**< Threads de mapping (0 = nombre de cœurs) */
+    int prefilterBits = 0;      /**< Bits par k-mer du filtre d'appartenance (0 = pas de filtre) */
+    ScreenParams screen;        /**< Criblage sur la cible / hors cible à la place du mapping (si activé) */
+    int shards = 1;             /**< Fragments de l'index, chacun dans son processus (1 = index unique) */
+    std::size_t sortMemory = 0; /**< Mémoire du tri des résultats par position (0 = ordre des reads) */
+    std::size_t coverageBin = 10000; /**< Largeur des fenêtres de couverture (avec le tri) */
+    PileupParams pileup;        /**< Seuils de l'empilement et des sites variants (si activé) */
+    std::size_t sampleSize = 0; /**< Reads échantillonnés pour l'estimation rapide (0 = mapping de tous les reads) */
+    std::uint64_t sampleSeed = 1; /**< Graine de l'échantillonnage */
+    PagePolicy hugePages = PagePolicy::Default; /**< Pages des tableaux de l'index */
+    NumaPlacement numa = NumaPlacement::Off;    /**< Placement des threads de mapping et de l'index */
+};
+
+/**
+ * @struct ServeOptions
+ * @brief Paramètres du mode serveur : socket, index à charger et taille du pool de mapping.
+ */
+struct ServeOptions {
+    std::string socketPath;     /**< Chemin de la socket Unix */
+    int k = 0;                  /**< Taille des k-mers de tous les index */
+    std::vector<std::pair<std::string, std::string>> references; /**< Paires (nom de l'index, génome FASTA) */
+    std::size_t threads = 0;    /**< Threads de mapping (0 = nombre de cœurs) */
+    std::size_t maxIndexBytes = 0; /**< Budget mémoire de chaque index (0 = pas de limite) */
+    int prefilterBits = 0;      /**< Bits par k-mer du filtre d'appartenance de chaque index (0 = pas de filtre) */
+    PagePolicy hugePages = PagePolicy::Default; /**< Pages des tableaux des index */
+    NumaPlacement numa = NumaPlacement::Off;    /**< Placement des threads du pool et des index */
+};
+
+/**
+ * @brief Analyse la ligne de commande.
+ *
+ * Forme attendue : <reference.fasta> <reads_directory> <k-mer size> [options]
+ *
+ * @param argc Nombre d'arguments
+ * @param argv Arguments
+ * @param options Structure remplie avec les valeurs lues
+ * @return true si la ligne de commande est valide, sinon false (un message d'erreur est affiché)
+ */
+bool parseOptions(int argc, char* argv[], RunOptions& options);
+
+/**
+ * @brief Analyse la ligne de commande du mode serveur.
+ *
+ * Forme attendue : serve <socket> <k-mer size> <nom>=<reference.fasta>... [--threads n] [--max-index-mem n] [--prefilter bits]
+ *
+ * @param argc Nombre d'arguments
+ * @param argv Arguments (argv[1] vaut "serve")
+ * @param options Structure remplie avec les valeurs lues
+ * @return true si la ligne de commande est valide, sinon false (un message d'erreur est affiché)
+ */
+bool parseServeOptions(int argc, char* argv[], ServeOptions& options);
+
+/**
+ * @brief Affiche l'aide de la ligne de commande
+ * @param out Flux de sortie
+ * @param program Nom du programme (argv[0])
+ */
+void printUsage(std::ostream& out, const std::string& program);
+
+#endif
@@ -0,0 +1,196 @@
+/**
+ * @file Pileup.cpp
+ * @brief Implémentation de l'empilement des reads alignés par tranches du génome.
+ */
+
+#include "Pileup.hpp"
+#include "KmerCodec.hpp"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+constexpr char BASES[] = "ACGT";
+
+} // namespace
+
+bool PileupParams::enabled() const {
+    return min_depth > 0;
+}
+
+void PileupReport::print(std::ostream& out) const {
+    out << "Empilement des reads alignés :\n"
+        << "  reads empilés             : " << reads << "\n"
+        << "  bases empilées            : " << bases << "\n"
+        << "  positions couvertes       : " << covered_positions << "\n"
+        << "  allèles retenus           : " << sites << "\n";
+}
+
+Pileup::Pileup(const PileupParams& params) : params(params) {}
+
+void Pileup::run(const std::string& genome, const std::vector<Sequence>& reads,
+                 const std::vector<MappingResult>& results, ThreadPool* pool) {
+    const std::size_t slices = (genome.size() + SLICE_LENGTH - 1) / SLICE_LENGTH;
+    report = PileupReport();
+    sites.clear();
+
+    // Reads alignés regroupés par tranche de leur position de départ (tri par dénombrement)
+    bucketStarts.assign(slices + 1, 0);
+    maxReadLength = 0;
+    // Un read qui déborde du début de la référence (départ négatif) garde ses bases chevauchantes,
+    // comme dans CoverageTrack::add ; il est rangé dans la tranche 0
+    auto placed = [&](std::size_t i) {
+        if (i >= results.size() || !results[i].aligned) return false;
+        const std::int64_t start = results[i].start_pos;
+        return start < static_cast<std::int64_t>(genome.size()) &&
+               start + static_cast<std::int64_t>(reads[i].getSequence().size()) > 0;
+    };
+    auto sliceOf = [&](std::size_t i) {
+        return static_cast<std::size_t>(std::max(0, results[i].start_pos)) / SLICE_LENGTH;
+    };
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        if (!placed(i)) continue;
+        bucketStarts[sliceOf(i) + 1]++;
+        maxReadLength = std::max(maxReadLength, reads[i].getSequence().size());
+        report.reads++;
+    }
+    for (std::size_t s = 0; s < slices; ++s) bucketStarts[s + 1] += bucketStarts[s];
+    alignedReads.assign(report.reads, 0);
+    std::vector<std::size_t> next(bucketStarts.begin(), bucketStarts.end() - 1);
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        if (placed(i)) alignedReads[next[sliceOf(i)]++] = i;
+    }
+
+    // Une tranche par tâche : chaque bloc de tranches réutilise le tableau de comptes de son thread
+    std::vector<std::vector<VariantSite>> sliceSites(slices);
+    std::vector<PileupReport> sliceReports(slices);
+    auto pileRange = [&](std::size_t begin, std::size_t end) {
+        std::vector<BaseCounts> counts(std::min(SLICE_LENGTH, genome.size()));
+        for (std::size_t s = begin; s < end; ++s) {
+            pileSlice(s, genome, reads, results, counts, sliceSites[s], sliceReports[s]);
+        }
+    };
+    if (pool != nullptr && pool->size() > 1) {
+        pool->parallelFor(slices, pileRange);
+    } else {
+        pileRange(0, slices);
+    }
+
+    for (std::size_t s = 0; s < slices; ++s) {
+        sites.insert(sites.end(), sliceSites[s].begin(), sliceSites[s].end());
+        report.bases += sliceReports[s].bases;
+        report.covered_positions += sliceReports[s].covered_positions;
+    }
+    report.sites = sites.size();
+}
+
+void Pileup::pileSlice(std::size_t slice, const std::string& genome, const std::vector<Sequence>& reads,
+                       const std::vector<MappingResult>& results, std::vector<BaseCounts>& counts,
+                       std::vector<VariantSite>& found, PileupReport& sliceReport) const {
+    const std::size_t lo = slice * SLICE_LENGTH;
+    const std::size_t hi = std::min(genome.size(), lo + SLICE_LENGTH);
+    std::memset(counts.data(), 0, (hi - lo) * sizeof(BaseCounts));
+
+    // Reads qui chevauchent la tranche : ceux qui commencent au plus maxReadLength - 1 positions avant elle
+    const std::size_t firstSlice = lo >= maxReadLength ? (lo - maxReadLength + 1) / SLICE_LENGTH : 0;
+    for (std::size_t r = bucketStarts[firstSlice]; r < bucketStarts[slice + 1]; ++r) {
+        const std::size_t index = alignedReads[r];
+        const std::string& seq = reads[index].getSequence();
+        const std::string& quality = reads[index].getQuality();
+        const MappingResult& result = results[index];
+        const std::int64_t start = result.start_pos; // négatif si le read déborde du début de la référence
+        const std::int64_t end = start + static_cast<std::int64_t>(seq.size());
+        if (end <= static_cast<std::int64_t>(lo)) continue;
+        const std::size_t first = std::max<std::size_t>(lo, static_cast<std::size_t>(std::max<std::int64_t>(start, 0)));
+        const std::size_t last = std::min(hi, static_cast<std::size_t>(end));
+        if (first >= last) continue;
+
+        const bool reverse = result.strand == Strand::Reverse;
+        const bool hasQuality = quality.size() == seq.size();
+        const std::size_t length = seq.size();
+        for (std::size_t p = first; p < last; ++p) {
+            // Sur le brin inverse, la base j du read placé est le complément de la base (length - 1 - j)
+            const std::size_t j = static_cast<std::size_t>(static_cast<std::int64_t>(p) - start);
+            const std::size_t source = reverse ? length - 1 - j : j;
+            int code = baseCode(seq[source]);
+            if (code < 0) continue;
+            BaseCounts& at = counts[p - lo];
+            if (reverse) {
+                code = 3 - code;
+                at.reverse[code]++;
+            } else {
+                at.forward[code]++;
+            }
+            if (hasQuality) at.quality[code] += static_cast<std::uint32_t>(std::max(0, quality[source] - 33));
+            sliceReport.bases++;
+        }
+    }
+
+    for (std::size_t p = lo; p < hi; ++p) {
+        const BaseCounts& at = counts[p - lo];
+        std::uint32_t depth = 0;
+        for (int b = 0; b < 4; ++b) depth += at.forward[b] + at.reverse[b];
+        if (depth == 0) continue;
+        sliceReport.covered_positions++;
+        const int ref = baseCode(genome[p]);
+        if (ref < 0 || depth < static_cast<std::uint32_t>(params.min_depth)) continue;
+        for (int b = 0; b < 4; ++b) {
+            const std::uint32_t alt = at.forward[b] + at.reverse[b];
+            if (b == ref || alt == 0 || alt < params.min_allele_frequency * depth) continue;
+            VariantSite site;
+            site.position = p;
+            site.ref = BASES[ref];
+            site.alt = BASES[b];
+            site.depth = depth;
+            site.alt_forward = at.forward[b];
+            site.alt_reverse = at.reverse[b];
+            site.alt_quality = at.quality[b];
+            found.push_back(site);
+        }
+    }
+}
+
+const std::vector<VariantSite>& Pileup::getSites() const {
+    return sites;
+}
+
+const PileupReport& Pileup::getReport() const {
+    return report;
+}
+
+bool Pileup::writeCsv(const std::string& filename, const std::vector<Contig>& contigs) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open output file " << filename << "\n";
+        return false;
+    }
+    out << "contig,position,ref,alt,depth,alt_count,allele_frequency,alt_forward,alt_reverse,mean_alt_quality\n";
+
+    // Les sites sont triés : la séquence courante n'avance que vers la fin de la référence
+    std::size_t contig = 0;
+    for (const VariantSite& site : sites) {
+        while (contig + 1 < contigs.size() && site.position >= contigs[contig + 1].start) ++contig;
+        std::string name = contigs.empty() ? "genome" : contigs[contig].name;
+        name = name.substr(0, name.find_first_of(" \t"));
+        const std::size_t offset = contigs.empty() ? 0 : contigs[contig].start;
+        const std::uint32_t alt = site.alt_forward + site.alt_reverse;
+        out << name << "," << (site.position - offset) << "," << site.ref << "," << site.alt << ","
+            << site.depth << "," << alt << "," << static_cast<double>(alt) / site.depth << ","
+            << site.alt_forward << "," << site.alt_reverse << ",";
+        if (site.alt_quality > 0) {
+            out << static_cast<double>(site.alt_quality) / alt;
+        } else {
+            out << "NA";
+        }
+        out << "\n";
+    }
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Error: Cannot write " << filename << "\n";
+        return false;
+    }
+    return true;
+}
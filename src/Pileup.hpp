@@ -0,0 +1,141 @@
+/**
+ * @file Pileup.hpp
+ * @brief Déclaration de l'empilement des reads alignés et de la recherche de sites variants.
+ */
+
+#ifndef PILEUP_HPP
+#define PILEUP_HPP
+
+#include "KmerIndex.hpp"
+#include "Mapper.hpp"
+#include "Sequence.hpp"
+#include "ThreadPool.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct PileupParams
+ * @brief Seuils de sélection des sites variants.
+ */
+struct PileupParams {
+    int min_depth = 0;                  /**< Profondeur minimale d'un site (0 = empilement désactivé) */
+    double min_allele_frequency = 0.2;  /**< Fraction minimale des bases portant l'allèle alternatif */
+
+    /**
+     * @brief Indique si l'empilement est demandé
+     */
+    bool enabled() const;
+};
+
+/**
+ * @struct VariantSite
+ * @brief Allèle alternatif observé à une position de la référence.
+ */
+struct VariantSite {
+    std::size_t position = 0;         /**< Position dans le texte concaténé de la référence */
+    char ref = 'N';                   /**< Base de la référence */
+    char alt = 'N';                   /**< Base alternative */
+    std::uint32_t depth = 0;          /**< Bases A/C/G/T empilées à cette position */
+    std::uint32_t alt_forward = 0;    /**< Bases alternatives venant de reads alignés sur le brin direct */
+    std::uint32_t alt_reverse = 0;    /**< Bases alternatives venant de reads alignés sur le brin inverse */
+    std::uint64_t alt_quality = 0;    /**< Somme des qualités Phred des bases alternatives (0 sans qualités) */
+};
+
+/**
+ * @struct PileupReport
+ * @brief Compteurs d'un empilement.
+ */
+struct PileupReport {
+    std::size_t reads = 0;              /**< Reads alignés empilés */
+    std::uint64_t bases = 0;            /**< Bases empilées */
+    std::size_t covered_positions = 0;  /**< Positions de profondeur non nulle */
+    std::size_t sites = 0;              /**< Allèles retenus */
+
+    /**
+     * @brief Affiche le résumé de l'empilement
+     * @param out Flux de sortie
+     */
+    void print(std::ostream& out) const;
+};
+
+/**
+ * @class Pileup
+ * @brief Compte, position par position, les bases des reads alignés puis retient les allèles alternatifs fréquents.
+ *
+ * Le placement des reads est sans indel : la base i d'un read aligné en p (complémentaire inverse pour le brin
+ * inverse) est empilée en p + i. Le génome est découpé en tranches de SLICE_LENGTH positions ; chaque thread
+ * traite des tranches entières avec son propre tableau de comptes (48 octets par position, parcouru en
+ * séquence), en empilant la partie de chaque read qui chevauche la tranche. Les tranches sont disjointes :
+ * aucun verrou ni compteur atomique, et les sites des tranches sont simplement mis bout à bout dans l'ordre.
+ */
+class Pileup {
+public:
+    static constexpr std::size_t SLICE_LENGTH = std::size_t(1) << 18; /**< Positions par tranche */
+
+    /**
+     * @brief Constructeur
+     * @param params Seuils de sélection des sites
+     */
+    explicit Pileup(const PileupParams& params);
+
+    /**
+     * @brief Empile les reads alignés et recherche les sites variants
+     * @param genome Texte de la référence (positions des résultats)
+     * @param reads Reads
+     * @param results Résultat du mapping de chaque read (même ordre)
+     * @param pool Pool de threads (nullptr = séquentiel)
+     */
+    void run(const std::string& genome, const std::vector<Sequence>& reads,
+             const std::vector<MappingResult>& results, ThreadPool* pool = nullptr);
+
+    /**
+     * @brief Sites retenus, par position croissante
+     */
+    const std::vector<VariantSite>& getSites() const;
+
+    /**
+     * @brief Compteurs du dernier empilement
+     */
+    const PileupReport& getReport() const;
+
+    /**
+     * @brief Écrit les sites au format CSV, en coordonnées de chaque séquence de la référence (base 0)
+     * @param filename Fichier de sortie
+     * @param contigs Séquences de la référence (vide = une seule séquence "genome")
+     * @return false si le fichier ne peut pas être écrit
+     */
+    bool writeCsv(const std::string& filename, const std::vector<Contig>& contigs) const;
+
+private:
+    /**
+     * @struct BaseCounts
+     * @brief Comptes d'une position, par base (A, C, G, T).
+     */
+    struct BaseCounts {
+        std::uint32_t forward[4];  /**< Bases venant de reads du brin direct */
+        std::uint32_t reverse[4];  /**< Bases venant de reads du brin inverse */
+        std::uint32_t quality[4];  /**< Somme des qualités Phred */
+    };
+
+    /**
+     * @brief Empile une tranche et y recherche les sites
+     * @param counts Tableau de comptes du thread (SLICE_LENGTH positions)
+     * @param sites Sortie : sites de la tranche
+     * @param report Compteurs de la tranche
+     */
+    void pileSlice(std::size_t slice, const std::string& genome, const std::vector<Sequence>& reads,
+                   const std::vector<MappingResult>& results, std::vector<BaseCounts>& counts,
+                   std::vector<VariantSite>& sites, PileupReport& report) const;
+
+    PileupParams params;                     /**< Seuils de sélection */
+    std::vector<std::size_t> bucketStarts;   /**< Début, dans alignedReads, des reads commençant dans chaque tranche */
+    std::vector<std::size_t> alignedReads;   /**< Indices des reads alignés, regroupés par tranche de départ */
+    std::size_t maxReadLength = 0;           /**< Longueur du plus long read aligné */
+    std::vector<VariantSite> sites;          /**< Sites retenus */
+    PileupReport report;                     /**< Compteurs */
+};
+
+#endif
@@ -0,0 +1,86 @@
+/**
+ * @file PositionCodec.hpp
+ * @brief Compression des listes de positions de l'index : écarts successifs codés en group-varint.
+ *
+ * Une liste triée p0 < p1 < ... est codée par ses écarts (p0, p1 - p0, p2 - p1, ...), quatre par groupe :
+ * un octet de contrôle donne la longueur (1 à 4 octets, 2 bits par valeur) des quatre valeurs qui suivent,
+ * en petit-boutiste. Le dernier groupe ne contient que les valeurs restantes. Le décodage lit chaque valeur
+ * en un seul accès de 4 octets masqué, sans boucle par octet : le tampon doit donc être suivi de
+ * POSITION_PADDING octets lisibles. Ce format est celui des décodeurs group-varint vectoriels (un mélange
+ * d'octets par groupe), qui peuvent le lire tel quel.
+ */
+
+#ifndef POSITIONCODEC_HPP
+#define POSITIONCODEC_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+constexpr std::size_t POSITION_PADDING = 3; /**< Octets lisibles exigés après le dernier groupe */
+
+/**
+ * @brief Nombre d'octets (1 à 4) nécessaires pour une valeur
+ */
+inline int varintLength(std::uint32_t value) {
+    return value < (1u << 8) ? 1 : value < (1u << 16) ? 2 : value < (1u << 24) ? 3 : 4;
+}
+
+/**
+ * @brief Ajoute à out le codage d'une liste de positions triées (strictement croissantes, positives)
+ * @param positions Positions
+ * @param count Nombre de positions
+ * @param out Tampon de sortie (vecteur d'octets, quel que soit son allocateur ; les octets sont ajoutés à la fin)
+ */
+template <typename Bytes>
+void encodePositions(const int* positions, std::size_t count, Bytes& out) {
+    std::uint32_t previous = 0;
+    for (std::size_t group = 0; group < count; group += 4) {
+        const std::size_t control = out.size();
+        out.push_back(0);
+        for (std::size_t i = group; i < count && i < group + 4; ++i) {
+            std::uint32_t gap = static_cast<std::uint32_t>(positions[i]) - previous;
+            previous = static_cast<std::uint32_t>(positions[i]);
+            int length = varintLength(gap);
+            out[control] |= static_cast<std::uint8_t>((length - 1) << (2 * (i - group)));
+            for (int b = 0; b < length; ++b) out.push_back(static_cast<std::uint8_t>(gap >> (8 * b)));
+        }
+    }
+}
+
+/**
+ * @brief Décode une liste codée par encodePositions
+ * @param in Début de la liste (suivi d'au moins POSITION_PADDING octets lisibles)
+ * @param count Nombre de positions
+ * @param out Sortie : count positions
+ */
+inline void decodePositions(const std::uint8_t* in, std::size_t count, int* out) {
+    static constexpr std::uint32_t MASKS[4] = {0xFFu, 0xFFFFu, 0xFFFFFFu, 0xFFFFFFFFu};
+    std::uint32_t value = 0;
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        const std::uint8_t control = *in++;
+        for (int j = 0; j < 4; ++j) {
+            const int length = (control >> (2 * j)) & 3;
+            std::uint32_t gap;
+            std::memcpy(&gap, in, sizeof(gap));
+            value += gap & MASKS[length];
+            out[i + j] = static_cast<int>(value);
+            in += length + 1;
+        }
+    }
+    if (i < count) {
+        const std::uint8_t control = *in++;
+        for (int j = 0; i + j < count; ++j) {
+            const int length = (control >> (2 * j)) & 3;
+            std::uint32_t gap;
+            std::memcpy(&gap, in, sizeof(gap));
+            value += gap & MASKS[length];
+            out[i + j] = static_cast<int>(value);
+            in += length + 1;
+        }
+    }
+}
+
+#endif
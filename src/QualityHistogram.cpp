@@ -0,0 +1,81 @@
+/**
+ * @file QualityHistogram.cpp
+ * @brief Implémentation de la classe QualityHistogram.
+ */
+
+#include "QualityHistogram.hpp"
+
+void QualityHistogram::add(int phred) {
+    if (phred < 0) phred = 0;
+    if (phred >= BINS) phred = BINS - 1;
+    bins[phred]++;
+    total++;
+    sum += static_cast<std::uint64_t>(phred);
+    sumSquares += static_cast<std::uint64_t>(phred * phred);
+}
+
+void QualityHistogram::addQualityString(const std::string& quality) {
+    for (char c : quality) {
+        add(static_cast<int>(c) - 33); // ASCII → Phred+33
+    }
+}
+
+void QualityHistogram::merge(const QualityHistogram& other) {
+    for (int q = 0; q < BINS; ++q) {
+        bins[q] += other.bins[q];
+    }
+    total += other.total;
+    sum += other.sum;
+    sumSquares += other.sumSquares;
+}
+
+void QualityHistogram::clear() {
+    bins.fill(0);
+    total = 0;
+    sum = 0;
+    sumSquares = 0;
+}
+
+std::uint64_t QualityHistogram::count() const {
+    return total;
+}
+
+int QualityHistogram::median() const {
+    // Même convention que l'ancien tri : élément d'indice total / 2
+    return atRank(total / 2);
+}
+
+int QualityHistogram::atRank(std::uint64_t rank) const {
+    if (total == 0) return -1;
+    std::uint64_t cumulated = 0;
+    for (int q = 0; q < BINS; ++q) {
+        cumulated += bins[q];
+        if (cumulated > rank) return q;
+    }
+    return BINS - 1;
+}
+
+double QualityHistogram::mean() const {
+    return total > 0 ? static_cast<double>(sum) / static_cast<double>(total) : 0.0;
+}
+
+double QualityHistogram::variance() const {
+    if (total == 0) return 0.0;
+    const double average = mean();
+    return static_cast<double>(sumSquares) / static_cast<double>(total) - average * average;
+}
+
+int QualityHistogram::min() const {
+    for (int q = 0; q < BINS; ++q) {
+        if (bins[q] > 0) return q;
+    }
+    return -1;
+}
+
+std::uint64_t QualityHistogram::countBelow(int threshold) const {
+    std::uint64_t below = 0;
+    for (int q = 0; q < BINS && q < threshold; ++q) {
+        below += bins[q];
+    }
+    return below;
+}
@@ -0,0 +1,95 @@
+/**
+ * @file QualityHistogram.hpp
+ * @brief Déclaration de la classe QualityHistogram pour les statistiques de qualité Phred en une passe.
+ */
+
+#ifndef QUALITYHISTOGRAM_HPP
+#define QUALITYHISTOGRAM_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+
+/**
+ * @class QualityHistogram
+ * @brief Histogramme des scores Phred+33 (94 classes, de 0 à 93).
+ *
+ * Les caractères de qualité FASTQ imprimables ('!' à '~') correspondent à 94 scores possibles :
+ * un tableau de compteurs remplace donc le tri d'un vecteur de scores.
+ * La médiane, la moyenne et les bornes sont obtenues en O(n + 94) au lieu de O(n log n).
+ */
+class QualityHistogram {
+public:
+    static constexpr int BINS = 94; /**< Nombre de scores Phred représentables en ASCII imprimable */
+
+    /**
+     * @brief Ajoute un score Phred (tronqué dans l'intervalle [0, 93])
+     * @param phred Score de qualité
+     */
+    void add(int phred);
+
+    /**
+     * @brief Ajoute tous les scores d'une chaîne de qualité Phred+33
+     * @param quality Chaîne de qualité FASTQ
+     */
+    void addQualityString(const std::string& quality);
+
+    /**
+     * @brief Fusionne un autre histogramme dans celui-ci
+     * @param other Histogramme à ajouter
+     */
+    void merge(const QualityHistogram& other);
+
+    /**
+     * @brief Vide l'histogramme
+     */
+    void clear();
+
+    /**
+     * @brief Nombre de scores ajoutés
+     */
+    std::uint64_t count() const;
+
+    /**
+     * @brief Médiane des scores (élément d'indice n/2 une fois triés, comme l'ancien tri)
+     * @return La médiane, ou -1 si l'histogramme est vide
+     */
+    int median() const;
+
+    /**
+     * @brief Score d'indice rank une fois les scores triés (tronqué au dernier)
+     * @return Le score, ou -1 si l'histogramme est vide
+     */
+    int atRank(std::uint64_t rank) const;
+
+    /**
+     * @brief Moyenne des scores
+     * @return La moyenne, ou 0.0 si l'histogramme est vide
+     */
+    double mean() const;
+
+    /**
+     * @brief Variance des scores (population)
+     * @return La variance, ou 0.0 si l'histogramme est vide
+     */
+    double variance() const;
+
+    /**
+     * @brief Plus petit score observé, ou -1 si vide
+     */
+    int min() const;
+
+    /**
+     * @brief Nombre de scores strictement inférieurs à un seuil
+     * @param threshold Seuil Phred
+     */
+    std::uint64_t countBelow(int threshold) const;
+
+private:
+    std::array<std::uint64_t, BINS> bins{}; /**< Effectif de chaque score */
+    std::uint64_t total = 0;                /**< Nombre total de scores */
+    std::uint64_t sum = 0;                  /**< Somme des scores (pour la moyenne) */
+    std::uint64_t sumSquares = 0;           /**< Somme des carrés des scores (pour la variance) */
+};
+
+#endif
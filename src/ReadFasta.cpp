@@ -14,10 +14,6 @@ ReadFasta::ReadFasta(const std::string& filename) : filename(filename) {}
 
 /**
  * @brief Charge les séquences valides à partir du fichier FASTA.
- *
- * Les séquences malformées sont ignorées avec un message d'erreur :
- * - Si une ligne de séquence précède un header '>'
- * - Si une séquence contient des caractères autres que A, C, G ou T
  */
 void ReadFasta::load() {
     std::ifstream file(filename);
@@ -25,17 +21,35 @@ void ReadFasta::load() {
         std::cerr << "Error: Cannot open file " << filename << std::endl;
         return;
     }
+    load(file);
+}
 
+/**
+ * @brief Charge les séquences valides à partir d'un flux FASTA.
+ * @param in Flux d'entrée
+ */
+void ReadFasta::load(std::istream& in) {
+    stream(in, [this](Sequence&& seq) { sequences.push_back(std::move(seq)); });
+}
+
+/**
+ * @brief Parcourt un flux FASTA et transmet chaque séquence valide dès qu'elle est complète.
+ *
+ * Les séquences malformées sont ignorées avec un message d'erreur :
+ * - Si une ligne de séquence précède un header '>'
+ * - Si une séquence contient des caractères autres que A, C, G ou T
+ */
+void ReadFasta::stream(std::istream& in, const std::function<void(Sequence&&)>& onSequence) const {
     std::string line, seq_id, sequence;
     bool valid = true;
 
-    while (std::getline(file, line)) {
+    while (std::getline(in, line)) {
         if (line.empty()) continue;
 
         if (line[0] == '>'||line[0] == ';') {
             if (!seq_id.empty()) {
                 if (valid) {
-                    sequences.emplace_back(seq_id, sequence);
+                    onSequence(Sequence(seq_id, sequence));
                 } else {
                     std::cerr << "Warning: Non-ACGT character detected in sequence " << seq_id << ". Sequence was ignored." << std::endl;
                 }
@@ -60,7 +74,7 @@ void ReadFasta::load() {
 
     if (!seq_id.empty()) {
         if (valid) {
-            sequences.emplace_back(seq_id, sequence);
+            onSequence(Sequence(seq_id, sequence));
         } else {
             std::cerr << "Warning: Non-ACGT character detected in sequence " << seq_id << ". Sequence was ignored." << std::endl;
         }
@@ -78,8 +92,8 @@ void ReadFasta::printSequences() const {
 
 /**
  * @brief Retourne les séquences valides lues depuis le fichier
- * @return Un vecteur contenant les objets Sequence valides
+ * @return Une référence vers le vecteur contenant les objets Sequence valides
  */
-std::vector<Sequence> ReadFasta::getSequences() const {
+const std::vector<Sequence>& ReadFasta::getSequences() const {
     return sequences;
 }
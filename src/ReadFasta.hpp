@@ -6,6 +6,8 @@
 #ifndef READFASTA_HPP
 #define READFASTA_HPP
 
+#include <functional>
+#include <istream>
 #include <string>
 #include <vector>
 #include "Sequence.hpp"
@@ -22,8 +24,24 @@ public:
      */
     ReadFasta(const std::string& filename);
 
+    /**
+     * @brief Charge les séquences valides depuis le fichier
+     */
     void load();
 
+    /**
+     * @brief Charge les séquences valides depuis un flux (socket, entrée standard...)
+     * @param in Flux FASTA
+     */
+    void load(std::istream& in);
+
+    /**
+     * @brief Parcourt un flux FASTA sans conserver les séquences
+     * @param in Flux FASTA
+     * @param onSequence Fonction appelée pour chaque séquence valide
+     */
+    void stream(std::istream& in, const std::function<void(Sequence&&)>& onSequence) const;
+
     /**
      * @brief Affiche les séquences valides sur la sortie standard
      */
@@ -32,7 +50,7 @@ public:
     /**
      * @brief Retourne les séquences valides lues depuis le fichier
      */
-    std::vector<Sequence> getSequences() const;
+    const std::vector<Sequence>& getSequences() const;
 
 private:
     std::string filename;             /**< Chemin vers le fichier FASTA */
@@ -15,6 +15,26 @@ ReadFastq::ReadFastq(const std::string& filename) : filename(filename) {}
 
 /**
  * @brief Charge les reads valides à partir du fichier FASTQ.
+ */
+void ReadFastq::load() {
+    std::ifstream file(filename);
+    if (!file) {
+        std::cerr << "Error: Cannot open file " << filename << std::endl;
+        return;
+    }
+    load(file);
+}
+
+/**
+ * @brief Charge les reads valides à partir d'un flux FASTQ.
+ * @param in Flux d'entrée
+ */
+void ReadFastq::load(std::istream& in) {
+    stream(in, [this](Sequence&& read) { reads.push_back(std::move(read)); });
+}
+
+/**
+ * @brief Parcourt un flux FASTQ et transmet chaque read valide.
  *
  * Chaque read FASTQ est composé de 4 lignes :
  * - Ligne 1 : identifiant précédé de '@'
@@ -24,13 +44,7 @@ ReadFastq::ReadFastq(const std::string& filename) : filename(filename) {}
  *
  * Si l'un de ces éléments est absent ou mal formé, le read est ignoré avec un message d'erreur.
  */
-void ReadFastq::load() {
-    std::ifstream file(filename);
-    if (!file) {
-        std::cerr << "Error: Cannot open file " << filename << std::endl;
-        return;
-    }
-
+void ReadFastq::stream(std::istream& file, const std::function<void(Sequence&&)>& onRead) const {
     std::string id, sequence, plus_line, quality;
 
     while (std::getline(file, id)) {
@@ -62,7 +76,7 @@ void ReadFastq::load() {
         }
 
         // Retire le '@' de l'identifiant et ajoute la sequence valide
-        reads.emplace_back(id.substr(1), sequence, quality);
+        onRead(Sequence(id.substr(1), sequence, quality));
     }
 }
 
@@ -77,8 +91,8 @@ void ReadFastq::printReads() const {
 
 /**
  * @brief Retourne la liste des reads valides extraits du fichier.
- * @return Un vecteur d'objets Sequence correspondant aux reads valides.
+ * @return Une référence vers le vecteur d'objets Sequence correspondant aux reads valides.
  */
-std::vector<Sequence> ReadFastq::getReads() const {
+const std::vector<Sequence>& ReadFastq::getReads() const {
     return reads;
 }
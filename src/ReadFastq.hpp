@@ -6,6 +6,8 @@
 #ifndef READFASTQ_HPP
 #define READFASTQ_HPP
 
+#include <functional>
+#include <istream>
 #include <string>
 #include <vector>
 #include "Sequence.hpp"
@@ -31,6 +33,19 @@ public:
      */
     void load();
 
+    /**
+     * @brief Charge les reads valides depuis un flux (socket, entrée standard...)
+     * @param in Flux FASTQ
+     */
+    void load(std::istream& in);
+
+    /**
+     * @brief Parcourt un flux FASTQ sans conserver les reads
+     * @param in Flux FASTQ
+     * @param onRead Fonction appelée pour chaque read valide
+     */
+    void stream(std::istream& in, const std::function<void(Sequence&&)>& onRead) const;
+
     /**
      * @brief Affiche les reads valides au format FASTQ
      */
@@ -39,7 +54,7 @@ public:
     /**
      * @brief Retourne les lectures valides sous forme de vecteur de Sequence
      */
-    std::vector<Sequence> getReads() const;
+    const std::vector<Sequence>& getReads() const;
 
 private:
     std::string filename;             /**< Chemin du fichier FASTQ */
@@ -0,0 +1,112 @@
+/**
+ * @file ReadFilter.cpp
+ * @brief Implémentation du pré-filtrage et du découpage des reads.
+ */
+
+#include "ReadFilter.hpp"
+#include "QualityHistogram.hpp"
+#include <algorithm>
+
+bool ReadFilterParams::enabled() const {
+    return trim_quality > 0 || !adapter.empty() || min_length > 0 || min_median_quality > 0;
+}
+
+void ReadFilterReport::print(std::ostream& out) const {
+    out << "Pré-filtrage des reads :\n"
+        << "  reads en entrée           : " << input << "\n"
+        << "  adaptateurs retirés       : " << adapter_trimmed << "\n"
+        << "  extrémités 3' découpées   : " << quality_trimmed << " (" << bases_trimmed << " bases retirées)\n"
+        << "  rejetés (trop courts)     : " << dropped_short << "\n"
+        << "  rejetés (qualité faible)  : " << dropped_low_quality << "\n"
+        << "  reads conservés           : " << kept << "\n";
+}
+
+ReadFilter::ReadFilter(const ReadFilterParams& params) : params(params) {}
+
+std::size_t ReadFilter::findAdapter(const std::string& seq) const {
+    const std::string& adapter = params.adapter;
+    std::size_t len = seq.length();
+    std::size_t min_overlap = static_cast<std::size_t>(std::max(1, params.min_adapter_overlap));
+    if (adapter.empty() || len < min_overlap) return len;
+
+    // Premier point de coupure : adaptateur complet dans le read, ou préfixe de l'adaptateur en fin de read
+    for (std::size_t i = 0; i + min_overlap <= len; ++i) {
+        std::size_t overlap = std::min(len - i, adapter.length());
+        if (seq.compare(i, overlap, adapter, 0, overlap) == 0) {
+            return i;
+        }
+    }
+    return len;
+}
+
+std::size_t ReadFilter::qualityTrimLength(const std::string& quality) const {
+    // Somme cumulée de (seuil - q) depuis l'extrémité 3' : on coupe là où elle est maximale
+    int running = 0;
+    int best = 0;
+    std::size_t cut = quality.length();
+    for (std::size_t i = quality.length(); i-- > 0;) {
+        running += params.trim_quality - (static_cast<int>(quality[i]) - 33);
+        if (running < 0) break;
+        if (running > best) {
+            best = running;
+            cut = i;
+        }
+    }
+    return cut;
+}
+
+bool ReadFilter::process(Sequence& read) {
+    report.input++;
+    std::size_t original_length = read.getSequence().length();
+
+    if (!params.adapter.empty()) {
+        std::size_t cut = findAdapter(read.getSequence());
+        if (cut < read.getSequence().length()) {
+            read.truncate(cut);
+            report.adapter_trimmed++;
+        }
+    }
+
+    if (params.trim_quality > 0 && !read.getQuality().empty()) {
+        std::size_t cut = qualityTrimLength(read.getQuality());
+        if (cut < read.getSequence().length()) {
+            read.truncate(cut);
+            report.quality_trimmed++;
+        }
+    }
+    report.bases_trimmed += original_length - read.getSequence().length();
+
+    if (read.getSequence().empty() ||
+        static_cast<int>(read.getSequence().length()) < params.min_length) {
+        report.dropped_short++;
+        return false;
+    }
+
+    if (params.min_median_quality > 0 && !read.getQuality().empty()) {
+        QualityHistogram histogram;
+        histogram.addQualityString(read.getQuality());
+        if (histogram.median() < params.min_median_quality) {
+            report.dropped_low_quality++;
+            return false;
+        }
+    }
+
+    report.kept++;
+    return true;
+}
+
+void ReadFilter::apply(std::vector<Sequence>& reads) {
+    // Compactage en place : les reads conservés sont déplacés vers le début du vecteur
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < reads.size(); ++i) {
+        if (process(reads[i])) {
+            if (kept != i) reads[kept] = std::move(reads[i]);
+            kept++;
+        }
+    }
+    reads.erase(reads.begin() + static_cast<std::ptrdiff_t>(kept), reads.end());
+}
+
+const ReadFilterReport& ReadFilter::getReport() const {
+    return report;
+}
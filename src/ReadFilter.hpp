@@ -0,0 +1,104 @@
+/**
+ * @file ReadFilter.hpp
+ * @brief Déclaration de la classe ReadFilter : pré-filtrage et découpage des reads avant le mapping.
+ */
+
+#ifndef READFILTER_HPP
+#define READFILTER_HPP
+
+#include "Sequence.hpp"
+#include <ostream>
+#include <string>
+#include <vector>
+
+/**
+ * @struct ReadFilterParams
+ * @brief Seuils du pré-filtrage. Une valeur nulle (ou un adaptateur vide) désactive l'étape correspondante.
+ */
+struct ReadFilterParams {
+    int trim_quality = 0;          /**< Seuil Phred pour le découpage de l'extrémité 3' (0 = désactivé) */
+    std::string adapter;           /**< Séquence de l'adaptateur à retirer en 3' (vide = désactivé) */
+    int min_adapter_overlap = 3;   /**< Chevauchement minimal pour reconnaître un adaptateur partiel en fin de read */
+    int min_length = 0;            /**< Longueur minimale après découpage (0 = désactivé) */
+    int min_median_quality = 0;    /**< Qualité médiane minimale du read (0 = désactivé, ignoré en FASTA) */
+
+    /**
+     * @brief Indique si au moins une étape du filtre est active
+     */
+    bool enabled() const;
+};
+
+/**
+ * @struct ReadFilterReport
+ * @brief Compteurs par étape du pré-filtrage.
+ */
+struct ReadFilterReport {
+    std::size_t input = 0;                /**< Reads reçus */
+    std::size_t adapter_trimmed = 0;      /**< Reads dont un adaptateur a été retiré */
+    std::size_t quality_trimmed = 0;      /**< Reads dont l'extrémité 3' de faible qualité a été coupée */
+    std::size_t bases_trimmed = 0;        /**< Nombre total de bases retirées */
+    std::size_t dropped_short = 0;        /**< Reads rejetés car trop courts après découpage */
+    std::size_t dropped_low_quality = 0;  /**< Reads rejetés pour qualité médiane insuffisante */
+    std::size_t kept = 0;                 /**< Reads conservés pour le mapping */
+
+    /**
+     * @brief Affiche les compteurs par étape
+     * @param out Flux de sortie
+     */
+    void print(std::ostream& out) const;
+};
+
+/**
+ * @class ReadFilter
+ * @brief Retire les adaptateurs et les extrémités 3' de faible qualité, puis rejette les reads inexploitables.
+ *
+ * Les étapes sont appliquées dans l'ordre :
+ * - découpage de l'adaptateur (occurrence complète ou préfixe de l'adaptateur en fin de read),
+ * - découpage de l'extrémité 3' de qualité inférieure au seuil (algorithme de somme cumulée, comme BWA),
+ * - rejet des reads trop courts,
+ * - rejet des reads dont la qualité médiane est insuffisante (histogramme, sans tri).
+ *
+ * Les reads rejetés ne passent donc jamais par la recherche dans l'index.
+ */
+class ReadFilter {
+public:
+    /**
+     * @brief Constructeur
+     * @param params Seuils du filtre
+     */
+    explicit ReadFilter(const ReadFilterParams& params);
+
+    /**
+     * @brief Découpe un read en place et décide s'il est conservé
+     * @param read Read à traiter (modifié si découpé)
+     * @return true si le read est conservé
+     */
+    bool process(Sequence& read);
+
+    /**
+     * @brief Applique le filtre à un ensemble de reads et retire les reads rejetés
+     * @param reads Reads à filtrer (modifiés en place)
+     */
+    void apply(std::vector<Sequence>& reads);
+
+    /**
+     * @brief Retourne les compteurs accumulés depuis la construction
+     */
+    const ReadFilterReport& getReport() const;
+
+private:
+    /**
+     * @brief Position de début de l'adaptateur dans la séquence, ou sa longueur si absent
+     */
+    std::size_t findAdapter(const std::string& seq) const;
+
+    /**
+     * @brief Longueur à conserver après découpage de l'extrémité 3' de faible qualité
+     */
+    std::size_t qualityTrimLength(const std::string& quality) const;
+
+    ReadFilterParams params; /**< Seuils utilisés */
+    ReadFilterReport report; /**< Compteurs par étape */
+};
+
+#endif
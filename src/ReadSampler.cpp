@@ -0,0 +1,114 @@
+/**
+ * @file ReadSampler.cpp
+ * @brief Implémentation de l'échantillonnage en flux et des intervalles de confiance.
+ */
+
+#include "ReadSampler.hpp"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+namespace {
+
+constexpr double Z_95 = 1.959963984540054; // Quantile 97,5 % de la loi normale
+
+/**
+ * @brief Quantile normal corrigé pour une population finie (0 si l'échantillon couvre la population)
+ */
+double correctedZ(std::uint64_t sample, std::uint64_t population) {
+    if (population <= 1) return Z_95; // 0 = population infinie
+    if (sample >= population) return 0.0;
+    return Z_95 * std::sqrt(static_cast<double>(population - sample) / static_cast<double>(population - 1));
+}
+
+} // namespace
+
+ReadSampler::ReadSampler(std::size_t capacity, std::uint64_t seed) : capacity(capacity), rng(seed) {
+    reservoir.reserve(capacity);
+}
+
+void ReadSampler::offer(Sequence&& read) {
+    const std::uint64_t index = count++;
+    if (capacity == 0) return;
+    if (reservoir.size() < capacity) {
+        reservoir.emplace_back(index, std::move(read));
+        if (reservoir.size() == capacity) {
+            weight = std::exp(std::log(1.0 - rng.uniform()) / static_cast<double>(capacity));
+            next = index;
+            scheduleNext();
+        }
+        return;
+    }
+    if (index != next) return;
+    reservoir[rng.below(capacity)] = std::make_pair(index, std::move(read));
+    weight *= std::exp(std::log(1.0 - rng.uniform()) / static_cast<double>(capacity));
+    scheduleNext();
+}
+
+void ReadSampler::scheduleNext() {
+    // Nombre de reads sautés : loi géométrique de paramètre weight
+    const double skip = std::floor(std::log(1.0 - rng.uniform()) / std::log1p(-weight));
+    if (!(skip < static_cast<double>(std::numeric_limits<std::uint64_t>::max() - next - 1))) {
+        next = std::numeric_limits<std::uint64_t>::max(); // plus aucun remplacement atteignable
+        return;
+    }
+    next += static_cast<std::uint64_t>(skip) + 1;
+}
+
+std::uint64_t ReadSampler::seen() const {
+    return count;
+}
+
+std::vector<Sequence> ReadSampler::takeSample() {
+    std::sort(reservoir.begin(), reservoir.end(),
+              [](const auto& a, const auto& b) { return a.first < b.first; });
+    std::vector<Sequence> sample;
+    sample.reserve(reservoir.size());
+    for (auto& entry : reservoir) sample.push_back(std::move(entry.second));
+    reservoir.clear();
+    return sample;
+}
+
+SampleEstimate proportionEstimate(std::uint64_t successes, std::uint64_t trials, std::uint64_t population) {
+    SampleEstimate estimate;
+    if (trials == 0) return estimate;
+    const double n = static_cast<double>(trials);
+    const double p = static_cast<double>(successes) / n;
+    const double z = correctedZ(trials, population);
+    const double z2 = z * z;
+    const double center = (p + z2 / (2.0 * n)) / (1.0 + z2 / n);
+    const double half = z / (1.0 + z2 / n) * std::sqrt(p * (1.0 - p) / n + z2 / (4.0 * n * n));
+    estimate.defined = true;
+    estimate.value = p;
+    estimate.low = successes == 0 ? 0.0 : std::max(0.0, center - half);
+    estimate.high = successes == trials ? 1.0 : std::min(1.0, center + half);
+    return estimate;
+}
+
+SampleEstimate medianEstimate(const QualityHistogram& histogram, std::uint64_t population) {
+    SampleEstimate estimate;
+    const std::uint64_t n = histogram.count();
+    if (n == 0) return estimate;
+    // Rangs n/2 -+ z * sqrt(n) / 2 : le nombre d'observations sous la médiane suit une loi binomiale(n, 1/2)
+    const double spread = correctedZ(n, population) * std::sqrt(static_cast<double>(n)) / 2.0;
+    const double middle = static_cast<double>(n) / 2.0;
+    const std::uint64_t lowRank = static_cast<std::uint64_t>(std::max(0.0, std::floor(middle - spread)));
+    const std::uint64_t highRank = std::min<std::uint64_t>(n - 1, static_cast<std::uint64_t>(std::ceil(middle + spread)));
+    estimate.defined = true;
+    estimate.value = histogram.median();
+    estimate.low = histogram.atRank(std::min(lowRank, n / 2));
+    estimate.high = histogram.atRank(std::max(highRank, n / 2));
+    return estimate;
+}
+
+SampleEstimate meanEstimate(const QualityHistogram& histogram, std::uint64_t population) {
+    SampleEstimate estimate;
+    const std::uint64_t n = histogram.count();
+    if (n == 0) return estimate;
+    const double half = correctedZ(n, population) * std::sqrt(histogram.variance() / static_cast<double>(n));
+    estimate.defined = true;
+    estimate.value = histogram.mean();
+    estimate.low = estimate.value - half;
+    estimate.high = estimate.value + half;
+    return estimate;
+}
@@ -0,0 +1,102 @@
+/**
+ * @file ReadSampler.hpp
+ * @brief Déclaration de l'échantillonnage de reads en flux (réservoir) et des intervalles de confiance associés.
+ */
+
+#ifndef READSAMPLER_HPP
+#define READSAMPLER_HPP
+
+#include "QualityHistogram.hpp"
+#include "Sequence.hpp"
+#include "SyntheticGenome.hpp"
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+/**
+ * @class ReadSampler
+ * @brief Échantillon uniforme de taille fixe d'un flux de reads de longueur inconnue (réservoir, algorithme L).
+ *
+ * Les capacity premiers reads remplissent le réservoir ; ensuite, le nombre de reads à sauter avant le prochain
+ * remplacement est tiré directement, si bien qu'un read non retenu ne coûte qu'un décrément (environ
+ * capacity * ln(N / capacity) tirages pour N reads). Chaque read du flux a la même probabilité d'être retenu ;
+ * pour une graine donnée, l'échantillon est reproductible.
+ */
+class ReadSampler {
+public:
+    /**
+     * @brief Constructeur
+     * @param capacity Taille de l'échantillon
+     * @param seed Graine du générateur
+     */
+    ReadSampler(std::size_t capacity, std::uint64_t seed);
+
+    /**
+     * @brief Présente le read suivant du flux
+     * @param read Read (déplacé seulement s'il est retenu)
+     */
+    void offer(Sequence&& read);
+
+    /**
+     * @brief Nombre de reads présentés
+     */
+    std::uint64_t seen() const;
+
+    /**
+     * @brief Retire l'échantillon, dans l'ordre du flux
+     */
+    std::vector<Sequence> takeSample();
+
+private:
+    /**
+     * @brief Tire l'indice du prochain read à retenir et met à jour le poids courant
+     */
+    void scheduleNext();
+
+    std::size_t capacity;        /**< Taille de l'échantillon */
+    SplitMix64 rng;              /**< Générateur pseudo-aléatoire */
+    double weight = 1.0;         /**< Poids W de l'algorithme L */
+    std::uint64_t count = 0;     /**< Reads présentés */
+    std::uint64_t next = 0;      /**< Indice du prochain read retenu */
+    std::vector<std::pair<std::uint64_t, Sequence>> reservoir; /**< Reads retenus et leur indice dans le flux */
+};
+
+/**
+ * @struct SampleEstimate
+ * @brief Estimation ponctuelle et intervalle de confiance à 95 %.
+ */
+struct SampleEstimate {
+    bool defined = false; /**< false si l'échantillon ne contient aucune observation */
+    double value = 0.0;   /**< Estimation ponctuelle */
+    double low = 0.0;     /**< Borne basse de l'intervalle */
+    double high = 0.0;    /**< Borne haute de l'intervalle */
+};
+
+/**
+ * @brief Proportion estimée sur un échantillon, avec l'intervalle de score de Wilson
+ *
+ * L'intervalle est resserré par la correction de population finie : il est réduit à la valeur observée
+ * lorsque l'échantillon couvre toute la population.
+ *
+ * @param successes Observations positives dans l'échantillon
+ * @param trials Taille de l'échantillon
+ * @param population Taille de la population échantillonnée (0 = infinie)
+ */
+SampleEstimate proportionEstimate(std::uint64_t successes, std::uint64_t trials, std::uint64_t population);
+
+/**
+ * @brief Médiane d'un histogramme d'échantillon, avec l'intervalle non paramétrique des statistiques d'ordre
+ * @param histogram Valeurs de l'échantillon
+ * @param population Taille de la population échantillonnée (0 = infinie)
+ */
+SampleEstimate medianEstimate(const QualityHistogram& histogram, std::uint64_t population);
+
+/**
+ * @brief Moyenne d'un histogramme d'échantillon, avec l'intervalle de l'approximation normale
+ * @param histogram Valeurs de l'échantillon
+ * @param population Taille de la population échantillonnée (0 = infinie)
+ */
+SampleEstimate meanEstimate(const QualityHistogram& histogram, std::uint64_t population);
+
+#endif
@@ -0,0 +1,39 @@
+/**
+ * @file ReadScreen.cpp
+ * @brief Implémentation des compteurs du criblage des reads.
+ */
+
+#include "ReadScreen.hpp"
+
+bool ScreenParams::enabled() const {
+    return min_hits > 0;
+}
+
+void ScreenReport::add(const ScreenResult& result, std::uint64_t kmers) {
+    total++;
+    if (result.on_target) {
+        on_target++;
+    } else {
+        off_target++;
+    }
+    kmers_tested += static_cast<std::uint64_t>(result.kmers_tested);
+    kmers_total += kmers;
+}
+
+void ScreenReport::print(std::ostream& out) const {
+    double percent = total > 0 ? 100.0 * on_target / total : 0.0;
+    double tested = kmers_total > 0 ? 100.0 * kmers_tested / kmers_total : 0.0;
+    out << "Criblage des reads :\n"
+        << "  reads criblés             : " << total << "\n"
+        << "  sur la cible              : " << on_target << " (" << percent << "%)\n"
+        << "  hors cible                : " << off_target << " (" << (total > 0 ? 100.0 - percent : 0.0) << "%)\n"
+        << "  k-mers testés             : " << kmers_tested << " (" << tested << "% des k-mers des reads)\n";
+}
+
+void ScreenReport::writeCsv(std::ostream& out) const {
+    out << "total reads," << total << "\n"
+        << "on-target reads," << on_target << "," << (total > 0 ? 100.0 * on_target / total : 0.0) << "%\n"
+        << "off-target reads," << off_target << "," << (total > 0 ? 100.0 * off_target / total : 0.0) << "%\n"
+        << "k-mers tested," << kmers_tested << "\n"
+        << "k-mers in reads," << kmers_total << "\n";
+}
@@ -0,0 +1,73 @@
+/**
+ * @file ReadScreen.hpp
+ * @brief Paramètres et compteurs du criblage des reads (sur la cible / hors cible), sans calcul de position.
+ */
+
+#ifndef READSCREEN_HPP
+#define READSCREEN_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+/**
+ * @struct ScreenParams
+ * @brief Règle d'arrêt du criblage d'un read.
+ *
+ * Les k-mers du read sont testés dans l'ordre et le test s'arrête dès que la classe est décidée :
+ * - sur la cible dès que @c min_hits k-mers distincts sont retrouvés dans l'index (sur l'un ou l'autre brin) ;
+ * - hors cible dès que les k-mers restants ne suffisent plus à atteindre @c min_hits, ou après @c max_misses
+ *   k-mers absents si ce seuil est fixé.
+ */
+struct ScreenParams {
+    int min_hits = 0;    /**< k-mers retrouvés nécessaires pour classer un read sur la cible (0 = criblage désactivé) */
+    int max_misses = 0;  /**< k-mers absents au-delà desquels le read est classé hors cible (0 = pas de limite) */
+
+    /**
+     * @brief Indique si le criblage est demandé
+     */
+    bool enabled() const;
+};
+
+/**
+ * @struct ScreenResult
+ * @brief Classe d'un read et nombre de k-mers testés pour la décider.
+ */
+struct ScreenResult {
+    bool on_target = false;  /**< Le read provient-il de la référence ? */
+    int kmers_tested = 0;    /**< k-mers testés avant l'arrêt */
+    int hits = 0;            /**< k-mers retrouvés dans l'index */
+};
+
+/**
+ * @struct ScreenReport
+ * @brief Compteurs d'un criblage.
+ */
+struct ScreenReport {
+    std::size_t total = 0;          /**< Reads criblés */
+    std::size_t on_target = 0;      /**< Reads sur la cible */
+    std::size_t off_target = 0;     /**< Reads hors cible */
+    std::uint64_t kmers_tested = 0; /**< k-mers testés, tous reads confondus */
+    std::uint64_t kmers_total = 0;  /**< k-mers que contiennent les reads (testés ou non) */
+
+    /**
+     * @brief Ajoute le résultat d'un read
+     * @param result Résultat du criblage
+     * @param kmers Nombre de k-mers du read
+     */
+    void add(const ScreenResult& result, std::uint64_t kmers);
+
+    /**
+     * @brief Affiche le résumé du criblage
+     * @param out Flux de sortie
+     */
+    void print(std::ostream& out) const;
+
+    /**
+     * @brief Écrit le résumé au format CSV (une ligne "clé,valeur" par compteur)
+     * @param out Flux de sortie
+     */
+    void writeCsv(std::ostream& out) const;
+};
+
+#endif
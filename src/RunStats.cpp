@@ -0,0 +1,211 @@
+/**
+ * @file RunStats.cpp
+ * @brief Implémentation de l'instrumentation de l'exécution et du rapport JSON.
+ */
+
+#include "RunStats.hpp"
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <cstdio>
+#include <sstream>
+#include <sys/resource.h>
+
+namespace {
+
+const char* stageName(Stage stage) {
+    switch (stage) {
+        case Stage::ReferenceParse: return "reference_parse";
+        case Stage::KSelection: return "k_selection";
+        case Stage::IndexBuild: return "index_build";
+        case Stage::ReadIngestion: return "read_ingestion";
+        case Stage::ReadFilter: return "read_filter";
+        case Stage::Mapping: return "mapping";
+        case Stage::Seeding: return "seeding";
+        case Stage::Voting: return "voting";
+        case Stage::Pileup: return "pileup";
+        case Stage::Export: return "export";
+        default: return "unknown";
+    }
+}
+
+const char* counterName(Counter counter) {
+    switch (counter) {
+        case Counter::ReadsAnalyzed: return "reads_analyzed";
+        case Counter::ReadsAligned: return "reads_aligned";
+        case Counter::IndexProbes: return "index_probes";
+        case Counter::ReverseComplementFallbacks: return "reverse_complement_fallbacks";
+        case Counter::VotesCast: return "votes_cast";
+        case Counter::CandidatePositions: return "candidate_positions";
+        case Counter::MaxCandidatesPerRead: return "max_candidates_per_read";
+        case Counter::PrefilterQueries: return "prefilter_queries";
+        case Counter::PrefilterRejections: return "prefilter_rejections";
+        case Counter::PrefilterFalsePositives: return "prefilter_false_positives";
+        default: return "unknown";
+    }
+}
+
+/**
+ * @brief Encode une chaîne au format JSON (guillemets compris)
+ */
+std::string jsonString(const std::string& value) {
+    std::string out = "\"";
+    for (char c : value) {
+        switch (c) {
+            case '"': out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\n': out += "\\n"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    char buffer[8];
+                    std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                    out += buffer;
+                } else {
+                    out += c;
+                }
+        }
+    }
+    return out + "\"";
+}
+
+} // namespace
+
+RunStats& RunStats::instance() {
+    static RunStats stats;
+    return stats;
+}
+
+void RunStats::setEnabled(bool value) {
+    enabled.store(value, std::memory_order_relaxed);
+}
+
+void RunStats::addTime(Stage stage, std::chrono::nanoseconds elapsed) {
+    stageNanos[static_cast<std::size_t>(stage)].fetch_add(
+        static_cast<std::uint64_t>(elapsed.count()), std::memory_order_relaxed);
+}
+
+void RunStats::add(Counter counter, std::uint64_t value) {
+    counters[static_cast<std::size_t>(counter)].fetch_add(value, std::memory_order_relaxed);
+}
+
+void RunStats::updateMax(Counter counter, std::uint64_t value) {
+    auto& slot = counters[static_cast<std::size_t>(counter)];
+    std::uint64_t current = slot.load(std::memory_order_relaxed);
+    while (value > current && !slot.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+std::uint64_t RunStats::get(Counter counter) const {
+    return counters[static_cast<std::size_t>(counter)].load(std::memory_order_relaxed);
+}
+
+double RunStats::seconds(Stage stage) const {
+    return static_cast<double>(stageNanos[static_cast<std::size_t>(stage)].load(std::memory_order_relaxed)) * 1e-9;
+}
+
+void RunStats::setInfo(const std::string& key, const std::string& value) {
+    std::lock_guard<std::mutex> lock(infoMutex);
+    for (auto& [name, encoded] : infos) {
+        if (name == key) {
+            encoded = jsonString(value);
+            return;
+        }
+    }
+    infos.emplace_back(key, jsonString(value));
+}
+
+void RunStats::setInfo(const std::string& key, double value) {
+    std::ostringstream encoded;
+    encoded << std::setprecision(15) << value;
+    std::lock_guard<std::mutex> lock(infoMutex);
+    for (auto& [name, current] : infos) {
+        if (name == key) {
+            current = encoded.str();
+            return;
+        }
+    }
+    infos.emplace_back(key, encoded.str());
+}
+
+void RunStats::reset() {
+    for (auto& value : stageNanos) value.store(0, std::memory_order_relaxed);
+    for (auto& value : counters) value.store(0, std::memory_order_relaxed);
+    std::lock_guard<std::mutex> lock(infoMutex);
+    infos.clear();
+}
+
+long RunStats::peakRssKb() {
+    std::ifstream status("/proc/self/status");
+    std::string line;
+    while (std::getline(status, line)) {
+        if (line.rfind("VmHWM:", 0) == 0) {
+            return std::stol(line.substr(6)); // "VmHWM:   123456 kB"
+        }
+    }
+
+    // Repli hors Linux : ru_maxrss est en octets sur macOS, en kio ailleurs
+    struct rusage usage {};
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return -1;
+#ifdef __APPLE__
+    return usage.ru_maxrss / 1024;
+#else
+    return usage.ru_maxrss;
+#endif
+}
+
+bool RunStats::writeJson(const std::string& filename) const {
+    std::ofstream out(filename);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open report file " << filename << "\n";
+        return false;
+    }
+
+    out << "{\n  \"stages_seconds\": {";
+    for (std::size_t s = 0; s < stageNanos.size(); ++s) {
+        out << (s ? "," : "") << "\n    " << jsonString(stageName(static_cast<Stage>(s))) << ": "
+            << seconds(static_cast<Stage>(s));
+    }
+    out << "\n  },\n  \"counters\": {";
+    for (std::size_t c = 0; c < counters.size(); ++c) {
+        out << (c ? "," : "") << "\n    " << jsonString(counterName(static_cast<Counter>(c))) << ": "
+            << get(static_cast<Counter>(c));
+    }
+
+    double mapping = seconds(Stage::Mapping);
+    std::uint64_t analyzed = get(Counter::ReadsAnalyzed);
+    // Filtre d'appartenance : part des k-mers absents de l'index, et part de ceux que le filtre a laissés passer
+    double queries = static_cast<double>(get(Counter::PrefilterQueries));
+    double rejected = static_cast<double>(get(Counter::PrefilterRejections));
+    double falsePositives = static_cast<double>(get(Counter::PrefilterFalsePositives));
+    double absent = rejected + falsePositives;
+    out << "\n  },\n  \"derived\": {"
+        << "\n    \"reads_per_second\": " << (mapping > 0 ? static_cast<double>(analyzed) / mapping : 0.0) << ","
+        << "\n    \"mean_candidates_per_read\": "
+        << (analyzed > 0 ? static_cast<double>(get(Counter::CandidatePositions)) / analyzed : 0.0) << ","
+        << "\n    \"mean_probes_per_read\": "
+        << (analyzed > 0 ? static_cast<double>(get(Counter::IndexProbes)) / analyzed : 0.0) << ","
+        << "\n    \"prefilter_miss_rate\": " << (queries > 0 ? absent / queries : 0.0) << ","
+        << "\n    \"prefilter_false_positive_rate\": " << (absent > 0 ? falsePositives / absent : 0.0)
+        << "\n  },\n  \"info\": {";
+
+    {
+        std::lock_guard<std::mutex> lock(infoMutex);
+        for (std::size_t i = 0; i < infos.size(); ++i) {
+            out << (i ? "," : "") << "\n    " << jsonString(infos[i].first) << ": " << infos[i].second;
+        }
+    }
+    out << "\n  },\n  \"peak_rss_kb\": " << peakRssKb() << "\n}\n";
+    return true;
+}
+
+ScopedStageTimer::ScopedStageTimer(Stage stage)
+    : stage(stage), active(RunStats::instance().isEnabled()) {
+    if (active) start = std::chrono::steady_clock::now();
+}
+
+ScopedStageTimer::~ScopedStageTimer() {
+    if (active) {
+        RunStats::instance().addTime(stage, std::chrono::steady_clock::now() - start);
+    }
+}
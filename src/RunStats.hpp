@@ -0,0 +1,168 @@
+/**
+ * @file RunStats.hpp
+ * @brief Déclaration de l'instrumentation de l'exécution : temps par étape, compteurs et rapport JSON.
+ */
+
+#ifndef RUNSTATS_HPP
+#define RUNSTATS_HPP
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+/**
+ * @enum Stage
+ * @brief Étapes chronométrées d'une exécution.
+ */
+enum class Stage {
+    ReferenceParse, /**< Lecture du FASTA de référence */
+    KSelection,     /**< Choix automatique de la taille des k-mers */
+    IndexBuild,     /**< Construction de l'index des k-mers */
+    ReadIngestion,  /**< Lecture des fichiers de reads */
+    ReadFilter,     /**< Pré-filtrage et découpage des reads */
+    Mapping,        /**< Mapping de l'ensemble des reads (temps mur) */
+    Seeding,        /**< Recherche des k-mers des reads dans l'index (cumul par read) */
+    Voting,         /**< Choix de la position par vote (cumul par read) */
+    Pileup,         /**< Empilement des reads alignés et recherche de variants */
+    Export,         /**< Écriture des résultats */
+    Count           /**< Nombre d'étapes (non utilisé comme étape) */
+};
+
+/**
+ * @enum Counter
+ * @brief Compteurs d'événements du chemin critique.
+ */
+enum class Counter {
+    ReadsAnalyzed,              /**< Reads passés dans analyzeRead */
+    ReadsAligned,               /**< Reads alignés */
+    IndexProbes,                /**< Recherches dans la table de l'index */
+    ReverseComplementFallbacks, /**< Recherches du complémentaire inverse après un échec sur le brin direct */
+    VotesCast,                  /**< Votes attribués à des positions de départ */
+    CandidatePositions,         /**< Positions de départ distinctes (somme sur les reads) */
+    MaxCandidatesPerRead,       /**< Maximum de positions de départ distinctes pour un read */
+    PrefilterQueries,           /**< k-mers testés par le filtre d'appartenance */
+    PrefilterRejections,        /**< k-mers écartés par le filtre (absents, sans recherche dans la table) */
+    PrefilterFalsePositives,    /**< k-mers acceptés par le filtre mais absents de l'index */
+    Count                       /**< Nombre de compteurs (non utilisé comme compteur) */
+};
+
+/**
+ * @class RunStats
+ * @brief Instrumentation globale du processus, désactivée par défaut.
+ *
+ * Lorsqu'elle est désactivée, chaque point d'instrumentation se réduit à la lecture d'un booléen :
+ * les compteurs du chemin critique sont accumulés localement puis ajoutés une seule fois par read.
+ * Les compteurs sont atomiques pour pouvoir être alimentés par plusieurs threads.
+ */
+class RunStats {
+public:
+    /**
+     * @brief Instance unique du processus
+     */
+    static RunStats& instance();
+
+    /**
+     * @brief Active ou désactive l'instrumentation
+     */
+    void setEnabled(bool value);
+
+    /**
+     * @brief Indique si l'instrumentation est active
+     */
+    bool isEnabled() const { return enabled.load(std::memory_order_relaxed); }
+
+    /**
+     * @brief Ajoute une durée à une étape
+     */
+    void addTime(Stage stage, std::chrono::nanoseconds elapsed);
+
+    /**
+     * @brief Ajoute une valeur à un compteur
+     */
+    void add(Counter counter, std::uint64_t value);
+
+    /**
+     * @brief Conserve le maximum entre la valeur d'un compteur et la valeur donnée
+     */
+    void updateMax(Counter counter, std::uint64_t value);
+
+    /**
+     * @brief Valeur actuelle d'un compteur
+     */
+    std::uint64_t get(Counter counter) const;
+
+    /**
+     * @brief Durée cumulée d'une étape, en secondes
+     */
+    double seconds(Stage stage) const;
+
+    /**
+     * @brief Ajoute (ou remplace) une information textuelle dans la section "info" du rapport
+     */
+    void setInfo(const std::string& key, const std::string& value);
+
+    /**
+     * @brief Ajoute (ou remplace) une information numérique dans la section "info" du rapport
+     */
+    void setInfo(const std::string& key, double value);
+
+    /**
+     * @brief Remet à zéro les temps, compteurs et informations
+     */
+    void reset();
+
+    /**
+     * @brief Écrit le rapport JSON de l'exécution
+     * @param filename Chemin du fichier de sortie
+     * @return true si l'écriture a réussi
+     */
+    bool writeJson(const std::string& filename) const;
+
+    /**
+     * @brief Pic de mémoire résidente du processus (VmHWM de /proc/self/status, sinon getrusage)
+     * @return Le pic en kio, ou -1 si indisponible
+     */
+    static long peakRssKb();
+
+private:
+    RunStats() = default;
+
+    std::atomic<bool> enabled{false};                                                 /**< Instrumentation active ? */
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Stage::Count)> stageNanos{};  /**< Temps par étape (ns) */
+    std::array<std::atomic<std::uint64_t>, static_cast<std::size_t>(Counter::Count)> counters{}; /**< Compteurs */
+    mutable std::mutex infoMutex;                                                     /**< Protège infos */
+    std::vector<std::pair<std::string, std::string>> infos;                           /**< Clé -> valeur JSON déjà encodée */
+};
+
+/**
+ * @class ScopedStageTimer
+ * @brief Chronomètre RAII : ajoute à une étape le temps écoulé dans sa portée si l'instrumentation est active.
+ */
+class ScopedStageTimer {
+public:
+    /**
+     * @brief Démarre le chronomètre (sans effet si l'instrumentation est désactivée)
+     * @param stage Étape à laquelle imputer le temps
+     */
+    explicit ScopedStageTimer(Stage stage);
+
+    /**
+     * @brief Arrête le chronomètre et impute le temps écoulé
+     */
+    ~ScopedStageTimer();
+
+    ScopedStageTimer(const ScopedStageTimer&) = delete;
+    ScopedStageTimer& operator=(const ScopedStageTimer&) = delete;
+
+private:
+    Stage stage;                                    /**< Étape chronométrée */
+    bool active;                                    /**< Instrumentation active au démarrage ? */
+    std::chrono::steady_clock::time_point start;    /**< Instant de départ */
+};
+
+#endif
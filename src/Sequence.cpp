@@ -34,11 +34,23 @@ void Sequence::print() const {
     }
 }
 
+/**
+ * @brief Écrit la séquence dans son format d'origine (FASTQ si elle a une qualité, sinon FASTA)
+ * @param out Flux de sortie
+ */
+void Sequence::write(std::ostream& out) const {
+    if (quality.empty()) {
+        out << ">" << id << "\n" << sequence << "\n";
+    } else {
+        out << "@" << id << "\n" << sequence << "\n+\n" << quality << "\n";
+    }
+}
+
 /**
  * @brief Retourne l'identifiant de la séquence
  * @return L'ID
  */
-std::string Sequence::getId() const {
+const std::string& Sequence::getId() const {
     return id;
 }
 
@@ -46,7 +58,7 @@ std::string Sequence::getId() const {
  * @brief Retourne la séquence de base (ACGT...)
  * @return La séquence
  */
-std::string Sequence::getSequence() const {
+const std::string& Sequence::getSequence() const {
     return sequence;
 }
 
@@ -54,6 +66,18 @@ std::string Sequence::getSequence() const {
  * @brief Retourne la chaîne de qualité (si disponible)
  * @return La chaîne de qualité, ou vide si FASTA
  */
-std::string Sequence::getQuality() const {
+const std::string& Sequence::getQuality() const {
     return quality;
 }
+
+/**
+ * @brief Raccourcit la séquence et la qualité associée (découpage de l'extrémité 3')
+ * @param length Nouvelle longueur
+ */
+void Sequence::truncate(std::size_t length) {
+    if (length >= sequence.length()) return;
+    sequence.resize(length);
+    if (!quality.empty()) {
+        quality.resize(length);
+    }
+}
@@ -35,23 +35,35 @@ public:
      */
     void print() const;
 
+    /**
+     * @brief Écrit la séquence au format FASTQ si elle a une qualité, sinon au format FASTA.
+     * @param out Flux de sortie
+     */
+    void write(std::ostream& out) const;
+
     /**
      * @brief Retourne l'identifiant de la séquence.
      * @return L'ID
      */
-    std::string getId() const;
+    const std::string& getId() const;
 
     /**
      * @brief Retourne la séquence nucléotidique.
      * @return La séquence
      */
-    std::string getSequence() const;
+    const std::string& getSequence() const;
 
     /**
      * @brief Retourne la chaîne de qualité (s'il y en a une).
      * @return La qualité
      */
-    std::string getQuality() const;
+    const std::string& getQuality() const;
+
+    /**
+     * @brief Raccourcit la séquence (et la qualité si présente) à une longueur donnée.
+     * @param length Nouvelle longueur, sans effet si elle dépasse la longueur actuelle
+     */
+    void truncate(std::size_t length);
 
 private:
     std::string id;       /**< Identifiant de la séquence */
@@ -0,0 +1,456 @@
+/**
+ * @file ShardedMapper.cpp
+ * @brief Implémentation du mapping sur une référence répartie entre plusieurs processus.
+ */
+
+#include "ShardedMapper.hpp"
+#include "IndexPlanner.hpp"
+#include "ReadFasta.hpp"
+#include "RunStats.hpp"
+#include <algorithm>
+#include <cerrno>
+#include <csignal>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <utility>
+
+namespace {
+
+constexpr std::size_t BATCH_SIZE = 4096; // Reads envoyés à chaque fragment par aller-retour
+
+// Compteurs du chemin critique mesurés dans les processus de travail et renvoyés avec chaque lot
+constexpr Counter WORKER_COUNTERS[] = {
+    Counter::IndexProbes, Counter::ReverseComplementFallbacks,
+    Counter::PrefilterQueries, Counter::PrefilterRejections, Counter::PrefilterFalsePositives,
+};
+constexpr std::size_t WORKER_COUNTER_COUNT = sizeof(WORKER_COUNTERS) / sizeof(WORKER_COUNTERS[0]);
+
+/**
+ * @brief Écrit exactement size octets (reprend après une interruption)
+ */
+bool writeFully(int fd, const void* data, std::size_t size) {
+    const char* bytes = static_cast<const char*>(data);
+    while (size > 0) {
+        ssize_t written = ::write(fd, bytes, size);
+        if (written < 0 && errno == EINTR) continue;
+        if (written <= 0) return false;
+        bytes += written;
+        size -= static_cast<std::size_t>(written);
+    }
+    return true;
+}
+
+/**
+ * @brief Lit exactement size octets ; false en fin de flux ou en cas d'erreur
+ */
+bool readFully(int fd, void* data, std::size_t size) {
+    char* bytes = static_cast<char*>(data);
+    while (size > 0) {
+        ssize_t got = ::read(fd, bytes, size);
+        if (got < 0 && errno == EINTR) continue;
+        if (got <= 0) return false;
+        bytes += got;
+        size -= static_cast<std::size_t>(got);
+    }
+    return true;
+}
+
+template <typename T>
+void append(std::string& buffer, const T& value) {
+    buffer.append(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+template <typename T>
+void appendArray(std::string& buffer, const std::vector<T>& values) {
+    buffer.append(reinterpret_cast<const char*>(values.data()), values.size() * sizeof(T));
+}
+
+/**
+ * @brief Lecture séquentielle d'un message reçu en entier
+ */
+class MessageReader {
+public:
+    explicit MessageReader(const std::string& buffer) : buffer(buffer) {}
+
+    template <typename T>
+    bool read(T& value) { return readBytes(&value, sizeof(T)); }
+
+    bool readString(std::string& text, std::size_t size) {
+        text.resize(size);
+        return size == 0 || readBytes(&text[0], size);
+    }
+
+    template <typename T>
+    bool readArray(std::vector<T>& values, std::size_t count) {
+        std::size_t previous = values.size();
+        values.resize(previous + count);
+        return readBytes(values.data() + previous, count * sizeof(T));
+    }
+
+private:
+    bool readBytes(void* out, std::size_t size) {
+        if (position + size > buffer.size()) return false;
+        std::memcpy(out, buffer.data() + position, size);
+        position += size;
+        return true;
+    }
+
+    const std::string& buffer;  /**< Message complet */
+    std::size_t position = 0;   /**< Prochain octet à lire */
+};
+
+/**
+ * @brief Envoie un message précédé de sa taille
+ */
+bool sendMessage(int fd, const std::string& payload) {
+    std::uint64_t size = payload.size();
+    return writeFully(fd, &size, sizeof(size)) && writeFully(fd, payload.data(), payload.size());
+}
+
+/**
+ * @brief Reçoit un message envoyé par sendMessage
+ */
+bool receiveMessage(int fd, std::string& payload) {
+    std::uint64_t size;
+    if (!readFully(fd, &size, sizeof(size))) return false;
+    payload.resize(size);
+    return readFully(fd, &payload[0], size);
+}
+
+/**
+ * @brief Boucle d'un processus de travail : indexe son fragment puis répond aux lots de reads
+ *
+ * Message prêt : mémoire de l'index et k-mers distincts. Requête : nombre de reads puis (longueur, séquence)
+ * par read. Réponse : compteurs du lot, puis pour chaque read ses k-mers retrouvés et ses votes.
+ *
+ * @return Code de sortie du processus
+ */
+int runShardWorker(int in, int out, int k, int prefilterBits, const IndexLayout& layout,
+                   std::string text, std::size_t start) {
+    Mapper mapper(k);
+    mapper.setPrefilter(prefilterBits);
+    mapper.getGenomeIndex().setLayout(layout);
+    mapper.getGenomeIndex().indexGenome(std::move(text));
+
+    std::string message;
+    append(message, static_cast<std::uint64_t>(mapper.getGenomeIndex().memoryUsage()));
+    append(message, static_cast<std::uint64_t>(mapper.getGenomeIndex().distinctKmers()));
+    if (!sendMessage(out, message)) return 1;
+
+    RunStats& stats = RunStats::instance();
+    std::string request, reply;
+    Sequence read("", "");
+    std::string sequence;
+    std::vector<KmerHit> hits;
+    std::vector<int> votes;
+    while (receiveMessage(in, request)) {
+        std::uint64_t before[WORKER_COUNTER_COUNT];
+        for (std::size_t c = 0; c < WORKER_COUNTER_COUNT; ++c) before[c] = stats.get(WORKER_COUNTERS[c]);
+
+        MessageReader reader(request);
+        std::uint32_t count = 0;
+        if (!reader.read(count)) return 1;
+        reply.assign(WORKER_COUNTER_COUNT * sizeof(std::uint64_t), '\0'); // compteurs, remplis à la fin du lot
+        for (std::uint32_t r = 0; r < count; ++r) {
+            std::uint32_t length = 0;
+            if (!reader.read(length) || !reader.readString(sequence, length)) return 1;
+            read = Sequence("", sequence);
+            mapper.seedRead(read, static_cast<int>(start), hits, votes);
+            append(reply, static_cast<std::uint32_t>(hits.size()));
+            append(reply, static_cast<std::uint32_t>(votes.size()));
+            appendArray(reply, hits);
+            appendArray(reply, votes);
+        }
+        for (std::size_t c = 0; c < WORKER_COUNTER_COUNT; ++c) {
+            std::uint64_t delta = stats.get(WORKER_COUNTERS[c]) - before[c];
+            std::memcpy(&reply[c * sizeof(std::uint64_t)], &delta, sizeof(delta));
+        }
+        if (!sendMessage(out, reply)) return 1;
+    }
+    return 0;
+}
+
+} // namespace
+
+ShardedMapper::ShardedMapper(int k, int shards) : k(k), shards(static_cast<std::size_t>(std::max(1, shards))) {}
+
+ShardedMapper::~ShardedMapper() {
+    stopWorkers();
+}
+
+void ShardedMapper::setPrefilter(int bitsPerKmer) {
+    prefilterBits = bitsPerKmer;
+}
+
+void ShardedMapper::setLayout(const IndexLayout& newLayout) {
+    layout = newLayout;
+}
+
+int ShardedMapper::shardCount() const {
+    return static_cast<int>(shards.size());
+}
+
+const std::vector<Contig>& ShardedMapper::getContigs() const {
+    return contigs;
+}
+
+bool ShardedMapper::loadReference(const std::string& filename, std::size_t maxIndexBytes) {
+    RunStats& stats = RunStats::instance();
+    std::string genome;
+    {
+        ScopedStageTimer timer(Stage::ReferenceParse);
+        ReadFasta fastaReader(filename);
+        fastaReader.load();
+        contigs.clear();
+        for (const auto& seq : fastaReader.getSequences()) {
+            Contig contig;
+            contig.name = seq.getId();
+            contig.start = genome.size();
+            contig.length = seq.getSequence().size();
+            contigs.push_back(contig);
+            genome += seq.getSequence();
+        }
+    }
+    const std::size_t kmers = genome.size() >= static_cast<std::size_t>(k) ? genome.size() - k + 1 : 0;
+    if (kmers < shards.size()) {
+        std::cerr << "Error: Reference " << filename << " is too short for " << shards.size() << " shards.\n";
+        return false;
+    }
+
+    // Tranches de positions de k-mer de tailles égales ; avec un index échantillonné, les bornes sont des
+    // multiples du pas pour que chaque fragment retienne les mêmes positions qu'un index unique
+    auto split = [&](std::size_t step) {
+        for (std::size_t i = 0; i < shards.size(); ++i) {
+            shards[i].start = i == 0 ? 0 : (i * kmers / shards.size()) / step * step;
+            shards[i].end = i + 1 == shards.size() ? kmers : ((i + 1) * kmers / shards.size()) / step * step;
+        }
+    };
+    auto shardText = [&](const Shard& shard) {
+        return genome.substr(shard.start, shard.end - shard.start + k - 1);
+    };
+    split(1);
+
+    if (maxIndexBytes > 0) {
+        // Le budget s'applique à chaque processus : on estime l'index du plus grand fragment
+        const Shard& largest = *std::max_element(shards.begin(), shards.end(), [](const Shard& a, const Shard& b) {
+            return a.end - a.start < b.end - b.start;
+        });
+        std::vector<LayoutEstimate> estimates = estimateLayouts(shardText(largest), k);
+        printLayoutEstimates(std::cout, estimates, maxIndexBytes);
+        LayoutEstimate chosen;
+        if (!chooseLayout(estimates, maxIndexBytes, chosen)) {
+            std::cerr << "Error: No index layout fits in --max-index-mem " << formatBytes(maxIndexBytes)
+                      << " per shard. Increase the budget or the number of shards.\n";
+            return false;
+        }
+        layout = chosen.layout;
+        std::cout << "Organisation de l'index retenue : " << layout.name() << " (estimation "
+                  << formatBytes(chosen.bytes) << " par fragment)\n";
+        if (stats.isEnabled()) {
+            stats.setInfo("index_memory_budget_bytes", static_cast<double>(maxIndexBytes));
+            stats.setInfo("index_estimated_bytes", static_cast<double>(chosen.bytes));
+        }
+    }
+    split(static_cast<std::size_t>(std::max(1, layout.step)));
+
+    std::cout << "Indexing genome in " << shards.size() << " shards...\n";
+    ScopedStageTimer timer(Stage::IndexBuild);
+    std::signal(SIGPIPE, SIG_IGN); // un fragment arrêté se traduit par une erreur d'écriture, pas par un signal
+    for (Shard& shard : shards) {
+        if (!spawnWorker(shard, shardText(shard), layout)) return false;
+    }
+    genome.clear();
+    genome.shrink_to_fit();
+
+    // Les fragments s'indexent en parallèle ; chacun signale la fin de sa construction
+    std::size_t totalBytes = 0, largestBytes = 0, distinct = 0;
+    for (std::size_t i = 0; i < shards.size(); ++i) {
+        std::string ready;
+        std::uint64_t bytes = 0, kmersInShard = 0;
+        MessageReader reader(ready);
+        if (!receiveMessage(shards[i].fromWorker, ready) || !reader.read(bytes) || !reader.read(kmersInShard)) {
+            std::cerr << "Error: Shard " << i << " failed while indexing.\n";
+            return false;
+        }
+        shards[i].indexBytes = bytes;
+        shards[i].distinctKmers = kmersInShard;
+        std::cout << "  fragment " << i << " : positions [" << shards[i].start << ", " << shards[i].end << "), "
+                  << formatBytes(bytes) << ", processus " << shards[i].pid << "\n";
+        totalBytes += bytes;
+        largestBytes = std::max<std::size_t>(largestBytes, bytes);
+        distinct += kmersInShard;
+    }
+    if (stats.isEnabled()) {
+        stats.setInfo("shards", static_cast<double>(shards.size()));
+        stats.setInfo("index_layout", layout.name());
+        stats.setInfo("index_bytes", static_cast<double>(totalBytes));
+        stats.setInfo("shard_index_bytes_max", static_cast<double>(largestBytes));
+        stats.setInfo("distinct_kmers", static_cast<double>(distinct)); // k-mers communs à deux fragments comptés deux fois
+    }
+    return true;
+}
+
+bool ShardedMapper::spawnWorker(Shard& shard, std::string text, const IndexLayout& layout) {
+    int requests[2], replies[2];
+    if (::pipe(requests) < 0) {
+        std::cerr << "Error: Cannot create pipe: " << std::strerror(errno) << "\n";
+        return false;
+    }
+    if (::pipe(replies) < 0) {
+        std::cerr << "Error: Cannot create pipe: " << std::strerror(errno) << "\n";
+        ::close(requests[0]);
+        ::close(requests[1]);
+        return false;
+    }
+
+    std::cout.flush(); // sinon le fils hérite du tampon et le réécrit
+    pid_t pid = ::fork();
+    if (pid < 0) {
+        std::cerr << "Error: Cannot start shard process: " << std::strerror(errno) << "\n";
+        for (int fd : {requests[0], requests[1], replies[0], replies[1]}) ::close(fd);
+        return false;
+    }
+    if (pid == 0) {
+        // Fils : ne garder que ses deux extrémités de tube (les fragments précédents doivent voir
+        // la fin de flux quand le coordinateur ferme les leurs)
+        ::close(requests[1]);
+        ::close(replies[0]);
+        for (const Shard& other : shards) {
+            if (other.toWorker >= 0) ::close(other.toWorker);
+            if (other.fromWorker >= 0) ::close(other.fromWorker);
+        }
+        int status = runShardWorker(requests[0], replies[1], k, prefilterBits, layout, std::move(text), shard.start);
+        std::_Exit(status); // pas de destructeurs statiques ni de tampons hérités du coordinateur
+    }
+
+    ::close(requests[0]);
+    ::close(replies[1]);
+    shard.pid = pid;
+    shard.toWorker = requests[1];
+    shard.fromWorker = replies[0];
+    return true;
+}
+
+void ShardedMapper::stopWorkers() {
+    for (Shard& shard : shards) {
+        if (shard.toWorker >= 0) ::close(shard.toWorker); // fin de flux : le fragment se termine
+        shard.toWorker = -1;
+    }
+    for (Shard& shard : shards) {
+        if (shard.fromWorker >= 0) ::close(shard.fromWorker);
+        shard.fromWorker = -1;
+        if (shard.pid > 0) {
+            int status = 0;
+            while (::waitpid(shard.pid, &status, 0) < 0 && errno == EINTR) {
+            }
+            shard.pid = -1;
+        }
+    }
+}
+
+bool ShardedMapper::mapReads(const Mapper& mapper, const std::vector<Sequence>& reads,
+                             std::vector<MappingResult>& results) {
+    RunStats& stats = RunStats::instance();
+    results.assign(reads.size(), MappingResult());
+
+    std::string request;
+    std::vector<std::string> replies(shards.size());
+    std::vector<std::size_t> offsets(shards.size());
+    std::vector<Strand> kmerStrand;
+    std::vector<KmerHit> hits, mergedHits;
+    std::vector<int> votes, mergedVotes;
+    std::vector<std::pair<std::size_t, std::size_t>> ranges; // (premier hit, premier vote) par fragment
+
+    for (std::size_t first = 0; first < reads.size(); first += BATCH_SIZE) {
+        const std::size_t last = std::min(reads.size(), first + BATCH_SIZE);
+
+        // Diffusion du lot à tous les fragments, puis collecte des réponses : les fragments mappent en parallèle.
+        // Pas d'interblocage : un fragment lit la requête entière avant d'écrire sa réponse
+        request.clear();
+        append(request, static_cast<std::uint32_t>(last - first));
+        for (std::size_t r = first; r < last; ++r) {
+            const std::string& seq = reads[r].getSequence();
+            append(request, static_cast<std::uint32_t>(seq.size()));
+            request += seq;
+        }
+        for (std::size_t s = 0; s < shards.size(); ++s) {
+            if (!sendMessage(shards[s].toWorker, request)) {
+                std::cerr << "Error: Shard " << s << " (process " << shards[s].pid << ") stopped responding.\n";
+                return false;
+            }
+        }
+        for (std::size_t s = 0; s < shards.size(); ++s) {
+            if (!receiveMessage(shards[s].fromWorker, replies[s])) {
+                std::cerr << "Error: Shard " << s << " (process " << shards[s].pid << ") stopped responding.\n";
+                return false;
+            }
+        }
+
+        for (std::size_t s = 0; s < shards.size(); ++s) {
+            offsets[s] = WORKER_COUNTER_COUNT * sizeof(std::uint64_t);
+            if (stats.isEnabled()) {
+                for (std::size_t c = 0; c < WORKER_COUNTER_COUNT; ++c) {
+                    std::uint64_t value;
+                    std::memcpy(&value, replies[s].data() + c * sizeof(value), sizeof(value));
+                    stats.add(WORKER_COUNTERS[c], value);
+                }
+            }
+        }
+
+        for (std::size_t r = first; r < last; ++r) {
+            const int length = static_cast<int>(reads[r].getSequence().size());
+            kmerStrand.assign(length >= k ? static_cast<std::size_t>(length - k + 1) : 0, Strand::None);
+
+            // Réponses de chaque fragment pour ce read ; le brin de chaque k-mer est celui d'un index unique :
+            // direct s'il est retrouvé sur le brin direct dans au moins un fragment, sinon inverse
+            hits.clear();
+            votes.clear();
+            ranges.clear();
+            for (std::size_t s = 0; s < shards.size(); ++s) {
+                std::uint32_t hitCount, voteCount;
+                const std::string& reply = replies[s];
+                std::memcpy(&hitCount, reply.data() + offsets[s], sizeof(hitCount));
+                std::memcpy(&voteCount, reply.data() + offsets[s] + sizeof(hitCount), sizeof(voteCount));
+                offsets[s] += 2 * sizeof(std::uint32_t);
+                ranges.emplace_back(hits.size(), votes.size());
+                hits.resize(hits.size() + hitCount);
+                std::memcpy(hits.data() + ranges.back().first, reply.data() + offsets[s], hitCount * sizeof(KmerHit));
+                offsets[s] += hitCount * sizeof(KmerHit);
+                votes.resize(votes.size() + voteCount);
+                std::memcpy(votes.data() + ranges.back().second, reply.data() + offsets[s], voteCount * sizeof(int));
+                offsets[s] += voteCount * sizeof(int);
+            }
+            for (const KmerHit& hit : hits) {
+                Strand& strand = kmerStrand[static_cast<std::size_t>(hit.kmer)];
+                if (hit.strand == Strand::Forward || strand == Strand::None) strand = hit.strand;
+            }
+
+            // Fusion : un hit par k-mer, par indice croissant, avec les votes des fragments du brin retenu
+            mergedHits.clear();
+            mergedVotes.clear();
+            for (std::size_t i = 0; i < kmerStrand.size(); ++i) {
+                if (kmerStrand[i] == Strand::None) continue;
+                KmerHit merged;
+                merged.kmer = static_cast<int>(i);
+                merged.strand = kmerStrand[i];
+                mergedHits.push_back(merged);
+            }
+            for (std::size_t s = 0; s < shards.size(); ++s) {
+                std::size_t end = s + 1 < shards.size() ? ranges[s + 1].first : hits.size();
+                std::size_t vote = ranges[s].second;
+                for (std::size_t h = ranges[s].first; h < end; ++h) {
+                    if (hits[h].strand == kmerStrand[static_cast<std::size_t>(hits[h].kmer)]) {
+                        mergedVotes.insert(mergedVotes.end(), votes.begin() + vote, votes.begin() + vote + hits[h].votes);
+                    }
+                    vote += hits[h].votes;
+                }
+            }
+            results[r] = mapper.resolveRead(reads[r], mergedHits, mergedVotes);
+        }
+    }
+    return true;
+}
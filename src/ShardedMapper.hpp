@@ -0,0 +1,123 @@
+/**
+ * @file ShardedMapper.hpp
+ * @brief Déclaration du mapping sur une référence répartie entre plusieurs processus (un index par fragment).
+ */
+
+#ifndef SHARDEDMAPPER_HPP
+#define SHARDEDMAPPER_HPP
+
+#include "KmerIndex.hpp"
+#include "Mapper.hpp"
+#include <cstddef>
+#include <string>
+#include <sys/types.h>
+#include <vector>
+
+/**
+ * @class ShardedMapper
+ * @brief Coordinateur d'un index réparti : la référence est découpée en N fragments contigus, chacun indexé
+ * et interrogé par son propre processus de travail (fork), relié au coordinateur par deux tubes.
+ *
+ * Chaque fragment indexe les k-mers qui commencent dans sa tranche de la référence (plus k - 1 bases de
+ * recouvrement), si bien que chaque position n'est indexée que par un seul fragment. Les reads sont diffusés
+ * par lots à tous les fragments ; chacun renvoie, pour chaque read, ses k-mers retrouvés avec leur brin et leurs
+ * votes (Mapper::seedRead, positions dans la référence complète). Le coordinateur fusionne ces réponses comme
+ * le ferait un index unique — pour un k-mer, les occurrences sur le brin direct l'emportent sur celles du brin
+ * inverse, et les votes de tous les fragments s'additionnent — puis décide avec Mapper::resolveRead.
+ * Les résultats sont donc identiques à ceux d'un index unique.
+ *
+ * Le protocole binaire (lots de séquences, réponses par read) ne dépend que de descripteurs de fichiers :
+ * les tubes pourront être remplacés par des sockets pour répartir les fragments sur plusieurs machines.
+ */
+class ShardedMapper {
+public:
+    /**
+     * @brief Constructeur
+     * @param k Taille des k-mers
+     * @param shards Nombre de fragments (et de processus de travail)
+     */
+    ShardedMapper(int k, int shards);
+
+    /**
+     * @brief Ferme les tubes et attend la fin des processus de travail
+     */
+    ~ShardedMapper();
+
+    ShardedMapper(const ShardedMapper&) = delete;
+    ShardedMapper& operator=(const ShardedMapper&) = delete;
+
+    /**
+     * @brief Active le filtre d'appartenance dans chaque fragment (à appeler avant loadReference)
+     * @param bitsPerKmer Bits de filtre par k-mer distinct (0 = pas de filtre)
+     */
+    void setPrefilter(int bitsPerKmer);
+
+    /**
+     * @brief Organisation de l'index de chaque fragment, sans budget mémoire (à appeler avant loadReference)
+     */
+    void setLayout(const IndexLayout& newLayout);
+
+    /**
+     * @brief Lit la référence, la découpe en fragments et lance un processus d'indexation par fragment
+     *
+     * Avec un budget mémoire, l'organisation est choisie pour que l'index du plus grand fragment tienne
+     * dans le budget : le budget s'applique à chaque processus de travail.
+     *
+     * @param filename Génome de référence (FASTA)
+     * @param maxIndexBytes Budget mémoire de l'index de chaque fragment (0 = pas de limite)
+     * @return false si la référence est illisible, si aucune organisation ne tient ou si un processus a échoué
+     */
+    bool loadReference(const std::string& filename, std::size_t maxIndexBytes = 0);
+
+    /**
+     * @brief Mappe des reads sur l'ensemble des fragments
+     * @param mapper Mapper du coordinateur (même k ; son index n'est pas utilisé)
+     * @param reads Reads à mapper
+     * @param results Sortie : un résultat par read, dans le même ordre
+     * @return false si un processus de travail a cessé de répondre
+     */
+    bool mapReads(const Mapper& mapper, const std::vector<Sequence>& reads, std::vector<MappingResult>& results);
+
+    /**
+     * @brief Nombre de fragments
+     */
+    int shardCount() const;
+
+    /**
+     * @brief Séquences de la référence complète, dans l'ordre du texte
+     */
+    const std::vector<Contig>& getContigs() const;
+
+private:
+    /**
+     * @struct Shard
+     * @brief Fragment de la référence et processus qui l'indexe.
+     */
+    struct Shard {
+        std::size_t start = 0;    /**< Première position de k-mer couverte */
+        std::size_t end = 0;      /**< Fin (exclue) des positions de k-mer couvertes */
+        pid_t pid = -1;           /**< Processus de travail */
+        int toWorker = -1;        /**< Tube coordinateur -> fragment (requêtes) */
+        int fromWorker = -1;      /**< Tube fragment -> coordinateur (réponses) */
+        std::size_t indexBytes = 0;    /**< Mémoire de l'index du fragment */
+        std::size_t distinctKmers = 0; /**< k-mers distincts du fragment */
+    };
+
+    /**
+     * @brief Crée le processus d'un fragment ; le fils indexe sa tranche puis répond aux lots jusqu'à la fermeture du tube
+     */
+    bool spawnWorker(Shard& shard, std::string text, const IndexLayout& layout);
+
+    /**
+     * @brief Ferme les tubes et attend tous les processus de travail
+     */
+    void stopWorkers();
+
+    int k;                       /**< Taille des k-mers */
+    int prefilterBits = 0;       /**< Bits par k-mer du filtre de chaque fragment */
+    IndexLayout layout;          /**< Organisation de l'index de chaque fragment */
+    std::vector<Shard> shards;   /**< Fragments, dans l'ordre de la référence */
+    std::vector<Contig> contigs; /**< Séquences de la référence complète */
+};
+
+#endif
@@ -0,0 +1,215 @@
+/**
+ * @file SyntheticGenome.cpp
+ * @brief Implémentation de la génération de génomes et de reads synthétiques.
+ */
+
+#include "SyntheticGenome.hpp"
+#include "Utils.hpp"
+#include <algorithm>
+#include <cctype>
+#include <cmath>
+
+namespace {
+
+/**
+ * @brief Tire une base selon le taux de GC
+ */
+char randomBase(SplitMix64& rng, double gc_content) {
+    double u = rng.uniform();
+    if (u < gc_content) {
+        return u < gc_content / 2 ? 'G' : 'C';
+    }
+    return u < gc_content + (1.0 - gc_content) / 2 ? 'A' : 'T';
+}
+
+/**
+ * @brief Remplace une base par l'une des trois autres
+ */
+char substituteBase(SplitMix64& rng, char base) {
+    static const char others[4][3] = {{'C', 'G', 'T'}, {'A', 'G', 'T'}, {'A', 'C', 'T'}, {'A', 'C', 'G'}};
+    int row = base == 'A' ? 0 : base == 'C' ? 1 : base == 'G' ? 2 : 3;
+    return others[row][rng.below(3)];
+}
+
+} // namespace
+
+std::string generateGenome(const GenomeParams& params) {
+    SplitMix64 rng(params.seed);
+    std::string genome(params.length, 'A');
+    for (char& base : genome) {
+        base = randomBase(rng, params.gc_content);
+    }
+
+    if (params.repeat_fraction <= 0.0 || params.repeat_length <= 0 ||
+        params.repeat_families <= 0 || params.length < static_cast<std::size_t>(params.repeat_length)) {
+        return genome;
+    }
+
+    // Familles de répétitions, puis copies exactes à des positions aléatoires
+    std::vector<std::string> families(params.repeat_families);
+    for (auto& family : families) {
+        family.resize(params.repeat_length);
+        for (char& base : family) {
+            base = randomBase(rng, params.gc_content);
+        }
+    }
+
+    std::size_t copies = static_cast<std::size_t>(
+        params.repeat_fraction * static_cast<double>(params.length) / params.repeat_length);
+    std::size_t max_start = params.length - params.repeat_length + 1;
+    for (std::size_t c = 0; c < copies; ++c) {
+        const std::string& family = families[rng.below(families.size())];
+        genome.replace(rng.below(max_start), family.length(), family);
+    }
+    return genome;
+}
+
+bool parseQualityModel(const std::string& name, QualityModel& model) {
+    if (name == "constant") model = QualityModel::Constant;
+    else if (name == "illumina") model = QualityModel::Illumina;
+    else if (name == "random") model = QualityModel::Random;
+    else return false;
+    return true;
+}
+
+namespace {
+
+/**
+ * @brief Qualité Phred d'une base correcte à la position j d'un read de longueur L
+ */
+int modelQuality(SplitMix64& rng, QualityModel model, int j, int length) {
+    switch (model) {
+        case QualityModel::Illumina: {
+            double x = length > 1 ? static_cast<double>(j) / (length - 1) : 0.0;
+            int q = static_cast<int>(40.0 - 15.0 * x * x) + static_cast<int>(rng.below(5)) - 2;
+            return q < 2 ? 2 : (q > 41 ? 41 : q);
+        }
+        case QualityModel::Random:
+            return 20 + static_cast<int>(rng.below(21));
+        default:
+            return 40;
+    }
+}
+
+/**
+ * @brief Simule un read à partir de la position start du brin direct, puis le retourne s'il est sur le brin inverse
+ */
+Sequence simulateRead(SplitMix64& rng, const std::string& genome, std::size_t start, bool reverse,
+                      const ReadSimParams& params, const std::string& id) {
+    std::string seq;
+    std::vector<bool> erroneous;
+    seq.reserve(params.length);
+    erroneous.reserve(params.length);
+
+    const double half_indel = params.indel_rate / 2;
+    std::size_t ref = start;
+    while (static_cast<int>(seq.length()) < params.length && ref < genome.length()) {
+        char base = static_cast<char>(std::toupper(static_cast<unsigned char>(genome[ref])));
+        double u = rng.uniform();
+        if (u < half_indel) {                                  // insertion
+            seq += "ACGT"[rng.below(4)];
+            erroneous.push_back(true);
+        } else if (u < params.indel_rate) {                    // délétion
+            ref++;
+        } else if (u < params.indel_rate + params.error_rate) { // substitution
+            seq += substituteBase(rng, base);
+            erroneous.push_back(true);
+            ref++;
+        } else {
+            seq += base;
+            erroneous.push_back(false);
+            ref++;
+        }
+    }
+
+    if (reverse) {
+        seq = reverseComplement(seq);
+        erroneous.assign(erroneous.rbegin(), erroneous.rend());
+    }
+
+    if (!params.with_quality) {
+        return Sequence(id, seq);
+    }
+    std::string quality(seq.length(), 'I');
+    for (std::size_t j = 0; j < seq.length(); ++j) {
+        int q = erroneous[j] ? 2 + static_cast<int>(rng.below(13))
+                             : modelQuality(rng, params.quality_model, static_cast<int>(j), static_cast<int>(seq.length()));
+        quality[j] = static_cast<char>(33 + q);
+    }
+    return Sequence(id, seq, quality);
+}
+
+/**
+ * @brief Nom de read portant la vérité terrain
+ */
+std::string truthName(std::size_t i, std::size_t start, bool reverse) {
+    return "sim" + std::to_string(i) + "_" + std::to_string(start) + "_" + (reverse ? "-" : "+");
+}
+
+} // namespace
+
+std::vector<Sequence> sampleReads(const std::string& genome, const ReadSimParams& params) {
+    std::vector<Sequence> reads;
+    if (params.length <= 0 || genome.length() < static_cast<std::size_t>(params.length)) {
+        return reads;
+    }
+
+    SplitMix64 rng(params.seed);
+    std::size_t max_start = genome.length() - params.length + 1;
+    reads.reserve(params.count);
+
+    for (std::size_t i = 0; i < params.count; ++i) {
+        std::size_t start = rng.below(max_start);
+        bool reverse = rng.uniform() < params.reverse_fraction;
+        reads.push_back(simulateRead(rng, genome, start, reverse, params, truthName(i, start, reverse)));
+    }
+    return reads;
+}
+
+void samplePairedReads(const std::string& genome, const ReadSimParams& params,
+                       std::vector<Sequence>& mates1, std::vector<Sequence>& mates2) {
+    if (params.length <= 0 || genome.length() < static_cast<std::size_t>(params.length)) {
+        return;
+    }
+
+    SplitMix64 rng(params.seed);
+    mates1.reserve(mates1.size() + params.count);
+    mates2.reserve(mates2.size() + params.count);
+
+    for (std::size_t i = 0; i < params.count; ++i) {
+        // Taille du fragment : loi normale (Box-Muller), bornée par la longueur des reads et du génome
+        double u1 = rng.uniform(), u2 = rng.uniform();
+        double normal = std::sqrt(-2.0 * std::log(1.0 - u1)) * std::cos(6.283185307179586 * u2);
+        long fragment = std::lround(params.fragment_mean + params.fragment_sd * normal);
+        fragment = std::max<long>(fragment, params.length);
+        fragment = std::min<long>(fragment, static_cast<long>(genome.length()));
+
+        std::size_t fragment_start = rng.below(genome.length() - static_cast<std::size_t>(fragment) + 1);
+        std::size_t left = fragment_start;
+        std::size_t right = fragment_start + static_cast<std::size_t>(fragment) - params.length;
+        bool reverse_fragment = rng.uniform() < params.reverse_fraction;
+
+        // Orientation FR : un mate sur le brin direct à gauche, l'autre sur le brin inverse à droite
+        std::size_t start1 = reverse_fragment ? right : left;
+        std::size_t start2 = reverse_fragment ? left : right;
+        mates1.push_back(simulateRead(rng, genome, start1, reverse_fragment, params,
+                                      truthName(i, start1, reverse_fragment) + "_1"));
+        mates2.push_back(simulateRead(rng, genome, start2, !reverse_fragment, params,
+                                      truthName(i, start2, !reverse_fragment) + "_2"));
+    }
+}
+
+bool parseSimulatedReadName(const std::string& id, long& start, char& strand) {
+    if (id.rfind("sim", 0) != 0) return false;
+    std::size_t first = id.find('_');
+    if (first == std::string::npos) return false;
+    std::size_t second = id.find('_', first + 1);
+    if (second == std::string::npos || second + 1 >= id.length()) return false;
+    try {
+        start = std::stol(id.substr(first + 1, second - first - 1));
+    } catch (const std::exception&) {
+        return false;
+    }
+    strand = id[second + 1];
+    return strand == '+' || strand == '-';
+}
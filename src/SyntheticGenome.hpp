@@ -0,0 +1,146 @@
+/**
+ * @file SyntheticGenome.hpp
+ * @brief Génération déterministe de génomes et de reads synthétiques (benchmarks et tests de bout en bout).
+ */
+
+#ifndef SYNTHETICGENOME_HPP
+#define SYNTHETICGENOME_HPP
+
+#include "Sequence.hpp"
+#include <cstdint>
+#include <string>
+#include <vector>
+
+/**
+ * @class SplitMix64
+ * @brief Générateur pseudo-aléatoire minimal et portable.
+ *
+ * Contrairement aux distributions de la bibliothèque standard, dont le résultat dépend de
+ * l'implémentation, ce générateur produit la même suite sur toutes les plateformes pour une graine donnée.
+ */
+class SplitMix64 {
+public:
+    /**
+     * @brief Constructeur
+     * @param seed Graine
+     */
+    explicit SplitMix64(std::uint64_t seed) : state(seed) {}
+
+    /**
+     * @brief Retourne le prochain entier 64 bits de la suite
+     */
+    std::uint64_t next() {
+        std::uint64_t z = (state += 0x9E3779B97F4A7C15ULL);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+        return z ^ (z >> 31);
+    }
+
+    /**
+     * @brief Réel uniforme dans [0, 1)
+     */
+    double uniform() {
+        return static_cast<double>(next() >> 11) * (1.0 / 9007199254740992.0);
+    }
+
+    /**
+     * @brief Entier uniforme dans [0, n)
+     * @param n Borne exclue (doit être > 0)
+     */
+    std::uint64_t below(std::uint64_t n) {
+        return next() % n;
+    }
+
+private:
+    std::uint64_t state; /**< État interne */
+};
+
+/**
+ * @struct GenomeParams
+ * @brief Paramètres du génome synthétique.
+ */
+struct GenomeParams {
+    std::size_t length = 1000000;  /**< Taille du génome en paires de bases */
+    double gc_content = 0.5;       /**< Proportion de G et C */
+    double repeat_fraction = 0.0;  /**< Fraction du génome couverte par des copies d'éléments répétés */
+    int repeat_length = 300;       /**< Longueur de chaque élément répété */
+    int repeat_families = 4;       /**< Nombre d'éléments répétés distincts */
+    std::uint64_t seed = 42;       /**< Graine du générateur */
+};
+
+/**
+ * @enum QualityModel
+ * @brief Profil des chaînes de qualité des reads simulés.
+ */
+enum class QualityModel {
+    Constant, /**< Q40 sur tout le read */
+    Illumina, /**< Q40 en 5', décroissance quadratique jusqu'à ~Q25 en 3', avec bruit */
+    Random    /**< Qualité uniforme entre Q20 et Q40 */
+};
+
+/**
+ * @brief Convertit un nom de modèle ("constant", "illumina", "random")
+ * @return false si le nom est inconnu
+ */
+bool parseQualityModel(const std::string& name, QualityModel& model);
+
+/**
+ * @struct ReadSimParams
+ * @brief Paramètres de l'échantillonnage de reads à partir d'un génome.
+ */
+struct ReadSimParams {
+    std::size_t count = 1000;      /**< Nombre de reads (de paires en mode paired-end) */
+    int length = 100;              /**< Longueur des reads */
+    double error_rate = 0.0;       /**< Taux de substitution par base */
+    double indel_rate = 0.0;       /**< Taux d'insertion + délétion par base (moitié chacun) */
+    double reverse_fraction = 0.5; /**< Proportion de reads (ou de fragments) tirés sur le brin complémentaire inverse */
+    bool with_quality = true;      /**< Produire des reads FASTQ plutôt que FASTA */
+    QualityModel quality_model = QualityModel::Constant; /**< Profil des qualités */
+    int fragment_mean = 300;       /**< Taille moyenne des fragments (paired-end) */
+    int fragment_sd = 30;          /**< Écart-type de la taille des fragments (paired-end) */
+    std::uint64_t seed = 7;        /**< Graine du générateur */
+};
+
+/**
+ * @brief Génère un génome aléatoire selon le taux de GC, puis y insère des copies d'éléments répétés.
+ * @param params Paramètres du génome
+ * @return La séquence (A, C, G, T)
+ */
+std::string generateGenome(const GenomeParams& params);
+
+/**
+ * @brief Tire des reads uniformément dans le génome, sur les deux brins, avec substitutions et indels aléatoires.
+ *
+ * Le nom de chaque read contient sa vérité terrain : sim<i>_<start>_<+|->, où start est la position
+ * (0-based, brin direct) de la première base de référence couverte par le read.
+ * Les bases erronées reçoivent une qualité basse (Q2 à Q14).
+ *
+ * @param genome Génome source
+ * @param params Paramètres des reads
+ * @return Les reads simulés
+ */
+std::vector<Sequence> sampleReads(const std::string& genome, const ReadSimParams& params);
+
+/**
+ * @brief Tire des paires de reads (paired-end, orientation FR) à partir de fragments de taille gaussienne.
+ *
+ * Les mates sont nommés sim<i>_<start>_<+|->_1 et sim<i>_<start>_<+|->_2 avec la vérité propre à chaque mate.
+ *
+ * @param genome Génome source
+ * @param params Paramètres des reads et des fragments
+ * @param mates1 Variable de sortie : premiers mates
+ * @param mates2 Variable de sortie : seconds mates
+ */
+void samplePairedReads(const std::string& genome, const ReadSimParams& params,
+                       std::vector<Sequence>& mates1, std::vector<Sequence>& mates2);
+
+/**
+ * @brief Extrait la vérité terrain d'un nom de read simulé
+ * @param id Nom du read (sim<i>_<start>_<strand>[_<mate>])
+ * @param start Variable de sortie : position d'origine
+ * @param strand Variable de sortie : brin d'origine ('+' ou '-')
+ * @return false si le nom ne suit pas ce format
+ */
+bool parseSimulatedReadName(const std::string& id, long& start, char& strand);
+
+#endif
@@ -0,0 +1,76 @@
+/**
+ * @file ThreadPool.cpp
+ * @brief Implémentation du pool de threads.
+ */
+
+#include "ThreadPool.hpp"
+#include "NumaTopology.hpp"
+#include <algorithm>
+
+ThreadPool::ThreadPool(std::size_t threads, bool pinned) {
+    if (threads == 0) {
+        threads = std::max<std::size_t>(1, std::thread::hardware_concurrency());
+    }
+    const int nodes = NumaTopology::system().nodeCount();
+    workers.reserve(threads);
+    for (std::size_t i = 0; i < threads; ++i) {
+        workers.emplace_back(&ThreadPool::workerLoop, this, pinned ? static_cast<int>(i % nodes) : -1);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    available.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+std::future<void> ThreadPool::submit(std::function<void()> task) {
+    std::packaged_task<void()> packaged(std::move(task));
+    std::future<void> done = packaged.get_future();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        tasks.push(std::move(packaged));
+    }
+    available.notify_one();
+    return done;
+}
+
+void ThreadPool::parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn) {
+    if (count == 0) return;
+    // Quelques blocs par thread pour équilibrer la charge sans multiplier les tâches
+    std::size_t blocks = std::min(count, workers.size() * 4);
+    std::size_t blockSize = (count + blocks - 1) / blocks;
+
+    std::vector<std::future<void>> pending;
+    for (std::size_t begin = 0; begin < count; begin += blockSize) {
+        std::size_t end = std::min(count, begin + blockSize);
+        pending.push_back(submit([&fn, begin, end]() { fn(begin, end); }));
+    }
+    for (auto& done : pending) {
+        done.get(); // propage une éventuelle exception
+    }
+}
+
+std::size_t ThreadPool::size() const {
+    return workers.size();
+}
+
+void ThreadPool::workerLoop(int node) {
+    if (node >= 0) NumaTopology::system().pinCurrentThread(node);
+    for (;;) {
+        std::packaged_task<void()> task;
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            available.wait(lock, [this]() { return stopping || !tasks.empty(); });
+            if (stopping && tasks.empty()) return;
+            task = std::move(tasks.front());
+            tasks.pop();
+        }
+        task();
+    }
+}
@@ -0,0 +1,79 @@
+/**
+ * @file ThreadPool.hpp
+ * @brief Déclaration d'un pool de threads de taille fixe partagé par le mapping et le serveur.
+ */
+
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+#include <condition_variable>
+#include <cstddef>
+#include <functional>
+#include <future>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+/**
+ * @class ThreadPool
+ * @brief File de tâches consommée par un nombre fixe de threads.
+ *
+ * Une tâche ne doit pas attendre le résultat d'une autre tâche du même pool
+ * (risque d'interblocage si tous les threads attendent).
+ */
+class ThreadPool {
+public:
+    /**
+     * @brief Démarre les threads
+     * @param threads Nombre de threads (0 = nombre de cœurs disponibles)
+     * @param pinned true pour répartir les threads entre les nœuds NUMA, chacun épinglé sur les cœurs de son nœud
+     *        (voir NumaTopology::pinCurrentThread)
+     */
+    explicit ThreadPool(std::size_t threads = 0, bool pinned = false);
+
+    /**
+     * @brief Termine les tâches en attente puis arrête les threads
+     */
+    ~ThreadPool();
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    /**
+     * @brief Ajoute une tâche à la file
+     * @param task Tâche à exécuter
+     * @return Un future permettant d'attendre la fin de la tâche
+     */
+    std::future<void> submit(std::function<void()> task);
+
+    /**
+     * @brief Découpe [0, count) en blocs exécutés en parallèle, et attend leur fin
+     *
+     * À n'appeler que depuis un thread extérieur au pool.
+     *
+     * @param count Nombre d'éléments
+     * @param fn Fonction appelée avec (début, fin) pour chaque bloc
+     */
+    void parallelFor(std::size_t count, const std::function<void(std::size_t, std::size_t)>& fn);
+
+    /**
+     * @brief Nombre de threads du pool
+     */
+    std::size_t size() const;
+
+private:
+    /**
+     * @brief Boucle d'un thread : exécute les tâches jusqu'à l'arrêt du pool
+     * @param node Nœud NUMA sur lequel épingler le thread (-1 = pas d'épinglage)
+     */
+    void workerLoop(int node);
+
+    std::vector<std::thread> workers;                 /**< Threads du pool */
+    std::queue<std::packaged_task<void()>> tasks;     /**< Tâches en attente */
+    std::mutex mutex;                                 /**< Protège tasks et stopping */
+    std::condition_variable available;                /**< Signale une nouvelle tâche ou l'arrêt */
+    bool stopping = false;                            /**< Arrêt demandé */
+};
+
+#endif
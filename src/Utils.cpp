@@ -1,4 +1,5 @@
 #include "Utils.hpp"
+#include "QualityHistogram.hpp"
 #include <filesystem>
 #include <fstream>
 #include <iostream>
@@ -54,8 +55,7 @@ std::string reverseComplement(const std::string& seq) {
 }
 
 int medianQuality(const std::string& quality) {
-    std::vector<int> scores;
-    for (char c : quality) scores.push_back(static_cast<int>(c) - 33); // ASCII → Phred+33
-    std::sort(scores.begin(), scores.end());
-    return scores[scores.size() / 2];
+    QualityHistogram histogram;
+    histogram.addQualityString(quality); // ASCII → Phred+33, une seule passe
+    return histogram.median();
 }
\ No newline at end of file
@@ -30,6 +30,11 @@ std::string detectFileFormat(const std::string& filename);
  */
 std::string reverseComplement(const std::string& seq);
 
+/**
+ * @brief Calcule la qualité médiane (Phred+33) d'un read à l'aide d'un histogramme, sans tri.
+ * @param quality Chaîne de qualité FASTQ
+ * @return La médiane, ou -1 si la chaîne est vide
+ */
 int medianQuality(const std::string& quality);
 
 #endif
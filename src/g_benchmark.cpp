@@ -1,110 +1,564 @@
 #include <benchmark/benchmark.h>
+#include "IndexMemory.hpp"
 #include "Mapper.hpp"
+#include "Pileup.hpp"
+#include "KmerCodec.hpp"
 #include "ReadFasta.hpp"
+#include "ReadFastq.hpp"
+#include "SyntheticGenome.hpp"
+#include <atomic>
+#include <cstddef>
+#include <cstdlib>
+#include <filesystem>
 #include <fstream>
 #include <iostream>
+#include <map>
+#include <new>
 
 /**
  * @file g_benchmark.cpp
- * @brief Benchmark de la fonction Mapper::analyzeRead() avec un vrai génome de référence (E. coli).
+ * @brief Suite de benchmarks du chemin de mapping sur un génome synthétique déterministe.
+ *
+ * Chaque étape est mesurée séparément : construction de l'index, recherche d'un k-mer (présent ou absent),
+ * mapping d'un read, criblage d'un read, mapping d'un lot de reads, lecture FASTA/FASTQ, export CSV
+ * et empilement des reads alignés (argument "threads").
+ * Le codage des k-mers, la construction de l'index et le mapping d'un read sont mesurés avec
+ * l'argument "specialized" : 1 = versions compilées pour k fixe (11, 15, 19, 21, 25, 31), 0 = chemin générique.
+ * Les recherches infructueuses et le mapping de reads hors cible sont mesurés avec l'argument "prefilter"
+ * (bits par k-mer du filtre d'appartenance, 0 = sans filtre). Les recherches fructueuses sont mesurées avec
+ * l'argument "compressed" (listes de positions compressées) et publient le compteur "bytes/position"
+ * (à comparer avec --repeat_fraction, qui allonge les listes). BM_KmerLookupPages mesure les recherches
+ * sur un index plus grand que les caches avec l'argument "pages" (0 = off, 1 = thp, 2 = hugetlb, voir
+ * --huge-pages) et publie le compteur "huge_MiB" (mémoire effectivement en pages de 2 Mio).
+ * L'index est toujours construit hors de la boucle chronométrée, sauf pour BM_IndexBuild.
+ *
+ * Paramètres (avant les options de Google Benchmark) :
+ * @code
+ * ./g_benchmark [genome.fasta] [--genome_size=N] [--gc=0.5] [--repeat_fraction=0.0]
+ *               [--read_length=100] [--error_rate=0.01] [--seed=42]
+ * @endcode
+ * Si un FASTA est fourni, son premier enregistrement remplace le génome synthétique
+ * (tronqué à la taille demandée par chaque benchmark).
+ *
+ * Les allocations sur le tas sont comptées (remplacement de toutes les formes de operator new, alignées
+ * comprises) : BM_AnalyzeRead et BM_MapReads publient le compteur "allocs/read" et échouent si le mapping
+ * alloue encore une fois les tampons en place.
  */
 
-std::string genome_path = "./genomes/e_coli.fasta";  // Par défaut
+/** Nombre d'appels à operator new (toutes formes) depuis le démarrage */
+static std::atomic<std::uint64_t> heapAllocations{0};
 
 /**
- * @brief Lit la séquence génomique depuis un fichier FASTA (première séquence uniquement).
- * @param filepath Chemin du fichier FASTA
- * @return La séquence concaténée du génome
+ * @brief Allocation comptée commune à toutes les formes de operator new (nullptr si la mémoire manque)
  */
-std::string loadGenomeFromFasta(const std::string& filepath) {
-    ReadFasta reader(filepath);         // Création d'un lecteur FASTA
-    reader.load();                      // Chargement des séquences
-    const auto& sequences = reader.getSequences();
-    if (!sequences.empty()) {
-        return sequences[0].getSequence();  // Retourne la première séquence trouvée
+static void* countedAllocate(std::size_t size, std::size_t alignment = 0) {
+    heapAllocations.fetch_add(1, std::memory_order_relaxed);
+    if (size == 0) size = 1;
+    if (alignment <= alignof(std::max_align_t)) return std::malloc(size);
+    return std::aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static void* countedAllocateOrThrow(std::size_t size, std::size_t alignment = 0) {
+    if (void* memory = countedAllocate(size, alignment)) return memory;
+    throw std::bad_alloc();
+}
+
+// Ensemble complet des remplacements : chaque forme de new a sa forme de delete (malloc et aligned_alloc → free)
+void* operator new(std::size_t size) { return countedAllocateOrThrow(size); }
+void* operator new[](std::size_t size) { return countedAllocateOrThrow(size); }
+void* operator new(std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new[](std::size_t size, const std::nothrow_t&) noexcept { return countedAllocate(size); }
+void* operator new(std::size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment) {
+    return countedAllocateOrThrow(size, static_cast<std::size_t>(alignment));
+}
+void* operator new(std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+void* operator new[](std::size_t size, std::align_val_t alignment, const std::nothrow_t&) noexcept {
+    return countedAllocate(size, static_cast<std::size_t>(alignment));
+}
+
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete(void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t, std::align_val_t) noexcept { std::free(memory); }
+void operator delete(void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::align_val_t, const std::nothrow_t&) noexcept { std::free(memory); }
+
+namespace {
+
+/**
+ * @struct BenchConfig
+ * @brief Paramètres globaux de la suite, lus sur la ligne de commande.
+ */
+struct BenchConfig {
+    std::string genome_path;           /**< FASTA réel facultatif */
+    std::size_t genome_size = 1 << 20; /**< Taille du génome pour les benchmarks à taille fixe */
+    double gc_content = 0.5;           /**< Taux de GC du génome synthétique */
+    double repeat_fraction = 0.0;      /**< Fraction répétée du génome synthétique */
+    int read_length = 100;             /**< Longueur des reads simulés */
+    double error_rate = 0.01;          /**< Taux de substitution des reads simulés */
+    std::uint64_t seed = 42;           /**< Graine commune */
+};
+
+BenchConfig config;
+
+/**
+ * @brief Génome de la taille demandée (généré une seule fois par taille)
+ */
+const std::string& genomeOfSize(std::size_t size) {
+    static std::map<std::size_t, std::string> cache;
+    static std::string fasta_genome;
+    static bool fasta_loaded = false;
+
+    auto it = cache.find(size);
+    if (it != cache.end()) return it->second;
+
+    if (!config.genome_path.empty()) {
+        if (!fasta_loaded) {
+            ReadFasta reader(config.genome_path);
+            reader.load();
+            const auto sequences = reader.getSequences();
+            if (!sequences.empty()) fasta_genome = sequences[0].getSequence();
+            fasta_loaded = true;
+        }
+        return cache[size] = fasta_genome.substr(0, size);
+    }
+
+    GenomeParams params;
+    params.length = size;
+    params.gc_content = config.gc_content;
+    params.repeat_fraction = config.repeat_fraction;
+    params.seed = config.seed;
+    return cache[size] = generateGenome(params);
+}
+
+/**
+ * @brief Reads simulés à partir d'un génome
+ */
+std::vector<Sequence> readsFrom(const std::string& genome, std::size_t count) {
+    ReadSimParams params;
+    params.count = count;
+    params.length = config.read_length;
+    params.error_rate = config.error_rate;
+    params.seed = config.seed + 1;
+    return sampleReads(genome, params);
+}
+
+/**
+ * @brief Reads simulés à partir d'un génome contaminant indépendant du génome indexé (reads hors cible)
+ */
+std::vector<Sequence> offTargetReads(std::size_t count) {
+    GenomeParams contaminant;
+    contaminant.length = config.genome_size;
+    contaminant.gc_content = config.gc_content;
+    contaminant.seed = config.seed + 99;
+    return readsFrom(generateGenome(contaminant), count);
+}
+
+/**
+ * @brief Fichier temporaire propre au benchmark
+ */
+std::string tempPath(const std::string& name) {
+    return (std::filesystem::temp_directory_path() / ("g_benchmark_" + name)).string();
+}
+
+/**
+ * @brief Publie le nombre d'allocations par read de la boucle chronométrée ; toute allocation
+ * en régime établi (après l'échauffement) est signalée comme une erreur du benchmark
+ */
+void reportAllocations(benchmark::State& state, std::uint64_t allocations, std::uint64_t reads) {
+    state.counters["allocs/read"] = reads > 0 ? static_cast<double>(allocations) / static_cast<double>(reads) : 0.0;
+    if (allocations > 0) {
+        state.SkipWithError("heap allocations in the steady-state mapping loop");
     }
-    return "";  // Si aucun read valide, retourne une chaîne vide
 }
 
 /**
- * @brief Benchmark de Mapper::analyzeRead() en utilisant le génome passé en argv
- *        et un petit ensemble de reads simulés issus du génome.
+ * @brief Mapper dont l'index est construit sur le génome (hors chronométrage)
+ */
+Mapper indexedMapper(const std::string& genome, int k) {
+    Mapper mapper(k);
+    mapper.getGenomeIndex().indexGenome(genome);
+    return mapper;
+}
+
+} // namespace
+
+/**
+ * @brief Construction de l'index : balayage de la taille du génome et de k.
+ */
+static void BM_IndexBuild(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(static_cast<std::size_t>(state.range(0)));
+    int k = static_cast<int>(state.range(1));
+    bool specialized = state.range(2) != 0;
+
+    for (auto _ : state) {
+        KmerIndex index(k);
+        index.setKSpecialization(specialized);
+        index.indexGenome(genome);
+        benchmark::ClobberMemory();
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(genome.size()));
+}
+BENCHMARK(BM_IndexBuild)
+    ->ArgNames({"size", "k", "specialized"})
+    ->ArgsProduct({{1 << 16, 1 << 18, 1 << 20}, {11, 15, 21, 31}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Codage glissant des k-mers et de leurs complémentaires inverses sur tout le génome.
+ */
+static void BM_EncodeKmers(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    int k = static_cast<int>(state.range(0));
+    bool specialized = state.range(1) != 0;
+
+    for (auto _ : state) {
+        std::uint64_t checksum = 0;
+        withKmerSize(k, specialized, [&](auto kmerSize) {
+            forEachKmerBothStrands(genome, kmerSize, [&](std::uint64_t forward, std::uint64_t reverse, std::size_t) {
+                checksum += forward ^ reverse;
+            });
+        });
+        benchmark::DoNotOptimize(checksum);
+    }
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * static_cast<int64_t>(genome.size()));
+}
+BENCHMARK(BM_EncodeKmers)
+    ->ArgNames({"k", "specialized"})
+    ->ArgsProduct({{15, 21, 31}, {0, 1}})
+    ->Unit(benchmark::kMillisecond);
+
+/**
+ * @brief Recherche d'un k-mer présent dans le génome (k-mers tirés aléatoirement, en alternance).
+ */
+static void BM_KmerLookupHit(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    int k = static_cast<int>(state.range(0));
+    IndexLayout layout;
+    layout.compressed = state.range(1) != 0;
+    KmerIndex index(k, layout);
+    index.indexGenome(genome);
+
+    std::vector<std::string> kmers;
+    SplitMix64 rng(config.seed);
+    for (int i = 0; i < 4096; ++i) {
+        kmers.push_back(genome.substr(rng.below(genome.size() - k + 1), k));
+    }
+
+    Strand strand;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.searchKmerWithStrand(kmers[i++ & 4095], strand));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["bytes/position"] = static_cast<double>(index.positionListBytes()) /
+                                       static_cast<double>(genome.size() - k + 1);
+}
+BENCHMARK(BM_KmerLookupHit)
+    ->ArgNames({"k", "compressed"})
+    ->ArgsProduct({{11, 15, 21, 31}, {0, 1}});
+
+/**
+ * @brief Recherche d'un k-mer aléatoire, le plus souvent absent (cas des reads contaminants).
+ */
+static void BM_KmerLookupMiss(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    int k = static_cast<int>(state.range(0));
+    KmerIndex index(k);
+    index.indexGenome(genome);
+    index.setPrefilter(static_cast<double>(state.range(1)));
+
+    GenomeParams noise;
+    noise.length = 4096 + k;
+    noise.seed = config.seed + 99;
+    std::string random_text = generateGenome(noise);
+    std::vector<std::string> kmers;
+    for (int i = 0; i < 4096; ++i) {
+        kmers.push_back(random_text.substr(i, k));
+    }
+
+    Strand strand;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.searchKmerWithStrand(kmers[i++ & 4095], strand));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+}
+BENCHMARK(BM_KmerLookupMiss)
+    ->ArgNames({"k", "prefilter"})
+    ->ArgsProduct({{15, 21, 31}, {0, 10}});
+
+/**
+ * @brief Recherche d'un k-mer présent dans un index de 8 Mb (hors des caches et du TLB en pages de 4 Kio),
+ * selon la politique de pages de l'index.
+ */
+static void BM_KmerLookupPages(benchmark::State& state) {
+    static const PagePolicy policies[] = {PagePolicy::Default, PagePolicy::TransparentHuge, PagePolicy::HugeTlb};
+    const std::string& genome = genomeOfSize(std::size_t(1) << 23);
+    const int k = 21;
+    const std::size_t hugeBefore = IndexMemory::transparentHugeBytes() + IndexMemory::hugeTlbBytes();
+    IndexMemory::setPolicy(policies[state.range(0)]);
+    KmerIndex index(k);
+    index.indexGenome(genome);
+    IndexMemory::setPolicy(PagePolicy::Default);
+    const std::size_t hugeAfter = IndexMemory::transparentHugeBytes() + IndexMemory::hugeTlbBytes();
+
+    std::vector<std::string> kmers;
+    SplitMix64 rng(config.seed);
+    for (int i = 0; i < 65536; ++i) {
+        kmers.push_back(genome.substr(rng.below(genome.size() - k + 1), k));
+    }
+
+    Strand strand;
+    std::size_t i = 0;
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(index.searchKmerWithStrand(kmers[i++ & 65535], strand));
+    }
+    state.SetItemsProcessed(static_cast<int64_t>(state.iterations()));
+    state.counters["huge_MiB"] = hugeAfter > hugeBefore ? static_cast<double>(hugeAfter - hugeBefore) / (1 << 20) : 0.0;
+}
+BENCHMARK(BM_KmerLookupPages)->ArgName("pages")->Arg(0)->Arg(1)->Arg(2);
+
+/**
+ * @brief Mapping d'un read (Mapper::analyzeRead) sur un index déjà construit.
+ */
+static void BM_AnalyzeRead(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    int k = static_cast<int>(state.range(0));
+    Mapper mapper = indexedMapper(genome, k);
+    mapper.setKSpecialization(state.range(1) != 0);
+    std::vector<Sequence> reads = readsFrom(genome, 1024);
+    for (const auto& read : reads) mapper.analyzeRead(read); // échauffement : dimensionne les tampons
+
+    std::size_t i = 0;
+    std::uint64_t allocationsBefore = heapAllocations.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mapper.analyzeRead(reads[i++ & 1023]));
+    }
+    reportAllocations(state, heapAllocations.load() - allocationsBefore, state.iterations());
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * config.read_length);
+}
+BENCHMARK(BM_AnalyzeRead)
+    ->ArgNames({"k", "specialized"})
+    ->ArgsProduct({{11, 15, 21, 31}, {0, 1}});
+
+/**
+ * @brief Mapping d'un read hors cible (génome contaminant indépendant), avec ou sans filtre d'appartenance.
+ */
+static void BM_AnalyzeOffTargetRead(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    int k = static_cast<int>(state.range(0));
+    Mapper mapper = indexedMapper(genome, k);
+    mapper.setPrefilter(static_cast<double>(state.range(1)));
+    std::vector<Sequence> reads = offTargetReads(1024);
+    for (const auto& read : reads) mapper.analyzeRead(read); // échauffement : dimensionne les tampons
+
+    std::size_t i = 0;
+    std::uint64_t allocationsBefore = heapAllocations.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mapper.analyzeRead(reads[i++ & 1023]));
+    }
+    reportAllocations(state, heapAllocations.load() - allocationsBefore, state.iterations());
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * config.read_length);
+}
+BENCHMARK(BM_AnalyzeOffTargetRead)
+    ->ArgNames({"k", "prefilter"})
+    ->ArgsProduct({{15, 21, 31}, {0, 10}});
+
+/**
+ * @brief Criblage d'un read (Mapper::screenRead, 2 k-mers retrouvés suffisent) : reads sur la cible
+ * ou hors cible, avec ou sans filtre d'appartenance. À comparer à BM_AnalyzeRead / BM_AnalyzeOffTargetRead.
+ */
+static void BM_ScreenRead(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    Mapper mapper = indexedMapper(genome, 21);
+    mapper.setPrefilter(static_cast<double>(state.range(1)));
+    std::vector<Sequence> reads = state.range(0) != 0 ? offTargetReads(1024) : readsFrom(genome, 1024);
+    ScreenParams params;
+    params.min_hits = 2;
+    for (const auto& read : reads) mapper.screenRead(read, params); // échauffement
+
+    std::size_t i = 0;
+    std::uint64_t allocationsBefore = heapAllocations.load();
+    for (auto _ : state) {
+        benchmark::DoNotOptimize(mapper.screenRead(reads[i++ & 1023], params));
+    }
+    reportAllocations(state, heapAllocations.load() - allocationsBefore, state.iterations());
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations()), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations()) * config.read_length);
+}
+BENCHMARK(BM_ScreenRead)
+    ->ArgNames({"off_target", "prefilter"})
+    ->ArgsProduct({{0, 1}, {0, 10}});
+
+/**
+ * @brief Mapping d'un lot de reads (Mapper::mapReads), balayage de la taille du génome.
  */
 static void BM_MapReads(benchmark::State& state) {
-    std::string genome = loadGenomeFromFasta(genome_path);
+    const std::string& genome = genomeOfSize(static_cast<std::size_t>(state.range(0)));
+    const std::size_t batch = 10000;
+    Mapper mapper = indexedMapper(genome, 15);
+    mapper.addReads(readsFrom(genome, batch));
+    mapper.mapReads(); // échauffement : dimensionne les résultats et les tampons
 
-    // Simulation de quelques reads à partir de la séquence du génome (reads parfaits)
+    std::uint64_t allocationsBefore = heapAllocations.load();
+    for (auto _ : state) {
+        mapper.mapReads();
+        benchmark::ClobberMemory();
+    }
+    reportAllocations(state, heapAllocations.load() - allocationsBefore, state.iterations() * batch);
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations() * batch), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * batch) * config.read_length);
+}
+BENCHMARK(BM_MapReads)
+    ->ArgName("size")
+    ->Arg(1 << 16)->Arg(1 << 18)->Arg(1 << 20)
+    ->Unit(benchmark::kMillisecond);
 
-    std::vector<Sequence> reads = {
-        Sequence("read1", genome.substr(1000, 50)),
-        Sequence("read2", genome.substr(2000, 50)),
-        Sequence("read3", genome.substr(3000, 50))
-    };
+/**
+ * @brief Lecture et validation d'un fichier FASTQ (ReadFastq::load).
+ */
+static void BM_ParseFastq(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    std::vector<Sequence> reads = readsFrom(genome, static_cast<std::size_t>(state.range(0)));
+    std::string path = tempPath("reads.fastq");
+    {
+        std::ofstream out(path);
+        for (const auto& read : reads) {
+            out << "@" << read.getId() << "\n" << read.getSequence() << "\n+\n" << read.getQuality() << "\n";
+        }
+    }
+    int64_t bytes = static_cast<int64_t>(std::filesystem::file_size(path));
 
-    // Boucle de benchmark (répétée automatiquement par Google Benchmark)
     for (auto _ : state) {
-        Mapper mapper(15);  // Création d'un Mapper avec k = 15
-        mapper.getGenomeIndex().indexGenome(genome);  // Indexation du génome
+        ReadFastq reader(path);
+        reader.load();
+        benchmark::DoNotOptimize(reader);
+    }
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), benchmark::Counter::kIsRate);
+    std::filesystem::remove(path);
+}
+BENCHMARK(BM_ParseFastq)->ArgName("reads")->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
 
-        // Analyse de chaque read sur le génome indexé
+/**
+ * @brief Lecture et validation d'un fichier FASTA (ReadFasta::load).
+ */
+static void BM_ParseFasta(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    std::vector<Sequence> reads = readsFrom(genome, static_cast<std::size_t>(state.range(0)));
+    std::string path = tempPath("reads.fasta");
+    {
+        std::ofstream out(path);
         for (const auto& read : reads) {
-            benchmark::DoNotOptimize(mapper.analyzeRead(read));  // Empêche l'optimisation du compilateur
+            out << ">" << read.getId() << "\n" << read.getSequence() << "\n";
         }
+    }
+    int64_t bytes = static_cast<int64_t>(std::filesystem::file_size(path));
 
-        benchmark::ClobberMemory();  // Force la prise en compte mémoire par le benchmark
+    for (auto _ : state) {
+        ReadFasta reader(path);
+        reader.load();
+        benchmark::DoNotOptimize(reader);
     }
+    state.SetBytesProcessed(state.iterations() * bytes);
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations() * state.range(0)), benchmark::Counter::kIsRate);
+    std::filesystem::remove(path);
 }
-BENCHMARK(BM_MapReads)
-    ->Iterations(1) //1 itération pour rapidité de benchmarking
-    ->Unit(benchmark::kMillisecond); //result plus lisible
+BENCHMARK(BM_ParseFasta)->ArgName("reads")->Arg(10000)->Arg(100000)->Unit(benchmark::kMillisecond);
 
 /**
- * @brief Benchmark de KmerIndex::indexGenome() sur le génome E. coli
- *        Permet d'évaluer la rapidité de l'indexation des k-mers.
+ * @brief Export des résultats (Mapper::exportMappingsToCSV) après un mapping non chronométré.
  */
-static void BM_IndexGenome(benchmark::State& state) {
-    std::string genome = loadGenomeFromFasta(genome_path);
+static void BM_ExportCSV(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(config.genome_size);
+    const std::size_t batch = static_cast<std::size_t>(state.range(0));
+    Mapper mapper = indexedMapper(genome, 15);
+    mapper.addReads(readsFrom(genome, batch));
+    mapper.mapReads();
+    std::string path = tempPath("mapping_results.csv");
 
     for (auto _ : state) {
-        KmerIndex index(15);  // k = 15
-        index.indexGenome(genome);  // Indexation du génome
-        benchmark::ClobberMemory();
+        mapper.exportMappingsToCSV(path);
     }
+    state.SetBytesProcessed(state.iterations() * static_cast<int64_t>(std::filesystem::file_size(path)));
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations() * batch), benchmark::Counter::kIsRate);
+    std::filesystem::remove(path);
 }
-BENCHMARK(BM_IndexGenome)
-    ->Iterations(1) //1 itération pour rapidité de benchmarking
-    ->Unit(benchmark::kMillisecond); //result plus lisible
+BENCHMARK(BM_ExportCSV)->ArgName("reads")->Arg(10000)->Unit(benchmark::kMillisecond);
 
 /**
- * @brief Benchmark de KmerIndex::searchKmerWithStrand() sur un génome indexé.
- *        On teste la recherche d'un k-mer fréquent pour mesurer la latence.
+ * @brief Empilement des reads alignés et recherche des sites (Pileup::run) après un mapping non chronométré.
  */
-static void BM_SearchKmerWithStrand(benchmark::State& state) {
-    std::string genome = loadGenomeFromFasta(genome_path);
-    KmerIndex index(15);
-    index.indexGenome(genome);
-    std::string strand;
-    std::string kmer = genome.substr(1000, 15);  // Un k-mer connu
+static void BM_Pileup(benchmark::State& state) {
+    const std::string& genome = genomeOfSize(std::size_t(1) << 20);
+    const std::size_t batch = 100000;
+    Mapper mapper = indexedMapper(genome, 15);
+    mapper.addReads(readsFrom(genome, batch));
+    mapper.mapReads();
+    ThreadPool pool(static_cast<std::size_t>(state.range(0)));
+    PileupParams params;
+    params.min_depth = 5;
 
     for (auto _ : state) {
-        benchmark::DoNotOptimize(index.searchKmerWithStrand(kmer, strand));
-        benchmark::ClobberMemory();
+        Pileup pileup(params);
+        pileup.run(genome, mapper.getReads(), mapper.getResults(), &pool);
+        benchmark::DoNotOptimize(pileup.getSites().data());
     }
+    state.counters["reads/s"] = benchmark::Counter(static_cast<double>(state.iterations() * batch), benchmark::Counter::kIsRate);
+    state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * batch) * config.read_length);
 }
-BENCHMARK(BM_SearchKmerWithStrand)
-    ->Iterations(1) //1 itération pour rapidité de benchmarking
-    ->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_Pileup)->ArgName("threads")->Arg(1)->Arg(4)->UseRealTime()->Unit(benchmark::kMillisecond);
 
-// === MAIN MODIFIÉ POUR PRENDRE UN FICHIER EN ARGUMENT ===
+// === MAIN : paramètres du génome synthétique, puis options de Google Benchmark ===
 int main(int argc, char** argv) {
-    if (argc > 1) {
-        genome_path = argv[1];
-        std::cout << "Utilisation du fichier génome : " << genome_path << std::endl;
-    } else {
-        std::cerr << "[Info] Aucun fichier FASTA passé. Utilisation du génome par défaut : " << genome_path << std::endl;
+    std::vector<char*> remaining = {argv[0]};
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        auto value = [&arg]() { return arg.substr(arg.find('=') + 1); };
+
+        if (arg.rfind("--genome_size=", 0) == 0) {
+            config.genome_size = std::stoull(value());
+        } else if (arg.rfind("--gc=", 0) == 0) {
+            config.gc_content = std::stod(value());
+        } else if (arg.rfind("--repeat_fraction=", 0) == 0) {
+            config.repeat_fraction = std::stod(value());
+        } else if (arg.rfind("--read_length=", 0) == 0) {
+            config.read_length = std::stoi(value());
+        } else if (arg.rfind("--error_rate=", 0) == 0) {
+            config.error_rate = std::stod(value());
+        } else if (arg.rfind("--seed=", 0) == 0) {
+            config.seed = std::stoull(value());
+        } else if (arg.rfind("--", 0) != 0 && config.genome_path.empty()) {
+            config.genome_path = arg;
+            std::cout << "Utilisation du fichier génome : " << config.genome_path << std::endl;
+        } else {
+            remaining.push_back(argv[i]);
+        }
     }
 
-    benchmark::Initialize(&argc, argv);
+    int remaining_argc = static_cast<int>(remaining.size());
+    benchmark::Initialize(&remaining_argc, remaining.data());
+    if (benchmark::ReportUnrecognizedArguments(remaining_argc, remaining.data())) return 1;
+    benchmark::AddCustomContext("genome", config.genome_path.empty() ? "synthetic" : config.genome_path);
+    benchmark::AddCustomContext("gc_content", std::to_string(config.gc_content));
+    benchmark::AddCustomContext("repeat_fraction", std::to_string(config.repeat_fraction));
+    benchmark::AddCustomContext("read_length", std::to_string(config.read_length));
+    benchmark::AddCustomContext("error_rate", std::to_string(config.error_rate));
+    benchmark::AddCustomContext("seed", std::to_string(config.seed));
     benchmark::RunSpecifiedBenchmarks();
     benchmark::Shutdown();
     return 0;
@@ -1,32 +1,269 @@
+#include "CoverageTrack.hpp"
+#include "IndexCommand.hpp"
+#include "IndexPlanner.hpp"
+#include "KmerSelector.hpp"
 #include "Mapper.hpp"
+#include "MappingServer.hpp"
+#include "NumaTopology.hpp"
+#include "Options.hpp"
+#include "RunStats.hpp"
+#include "ShardedMapper.hpp"
+#include "ThreadPool.hpp"
 #include <iostream>
 #include <filesystem>
+#include <memory>
+#include <string>
+
+/**
+ * @brief Mode serveur : charge les index une fois puis traite les requêtes reçues sur la socket
+ */
+int runServer(int argc, char* argv[]) {
+    ServeOptions options;
+    if (!parseServeOptions(argc, argv, options)) {
+        return 1;
+    }
+
+    IndexMemory::setPolicy(options.hugePages);
+    MappingServer server(options.threads, options.numa);
+    for (const auto& reference : options.references) {
+        if (!server.addIndex(reference.first, reference.second, options.k, options.maxIndexBytes,
+                             options.prefilterBits)) {
+            return 1;
+        }
+    }
+    if (!server.listen(options.socketPath)) {
+        return 1;
+    }
+    server.run();
+    return 0;
+}
+
+/**
+ * @brief Renseigne le rapport d'exécution avec le choix automatique de k : courbe d'unicité, choix, coût et bénéfice
+ */
+void recordKmerPlan(RunStats& stats, const KmerSelector& selector) {
+    for (const UniquenessPoint& point : selector.getCurve()) {
+        const std::string suffix = "_k" + std::to_string(point.k);
+        stats.setInfo("autok_unique_fraction" + suffix, point.unique_fraction);
+        stats.setInfo("autok_mean_occurrences" + suffix, point.mean_occurrences);
+        stats.setInfo("autok_index_estimated_bytes" + suffix, static_cast<double>(point.index_bytes));
+    }
+    const KmerPlan& plan = selector.getPlan();
+    stats.setInfo("autok_reference_k", plan.reference_k);
+    stats.setInfo("autok_primary_k", plan.primary_k);
+    stats.setInfo("autok_secondary_k", plan.secondary_k);
+    stats.setInfo("autok_sampled_reads", static_cast<double>(plan.sampled_reads));
+    stats.setInfo("autok_on_target_reads", static_cast<double>(plan.on_target_reads));
+    stats.setInfo("autok_read_error_rate", plan.read_error_rate);
+    if (plan.quality_error_rate >= 0.0) stats.setInfo("autok_quality_error_rate", plan.quality_error_rate);
+    stats.setInfo("autok_primary_only_sensitivity", plan.primary_only_sensitivity);
+    stats.setInfo("autok_planned_sensitivity", plan.planned_sensitivity);
+    stats.setInfo("autok_primary_estimated_bytes", static_cast<double>(plan.primary_bytes));
+    stats.setInfo("autok_secondary_estimated_bytes", static_cast<double>(plan.secondary_bytes));
+}
+
+/**
+ * @brief Copie les index sur chaque nœud NUMA si demandé, puis renseigne le rapport sur le placement de l'index
+ */
+void placeIndexes(RunStats& stats, const RunOptions& options, Mapper& mapper, Mapper* secondary) {
+    const NumaTopology& topology = NumaTopology::system();
+    int copies = 0;
+    if (options.numa == NumaPlacement::Replicate) {
+        copies = mapper.getGenomeIndex().replicateBase(topology);
+        if (secondary != nullptr) secondary->getGenomeIndex().replicateBase(topology);
+    }
+    if (options.numa != NumaPlacement::Off) {
+        std::cout << "Placement NUMA : " << topology.describe() << ", threads épinglés";
+        if (options.numa == NumaPlacement::Replicate) {
+            std::cout << (copies > 0 ? ", index copié sur chaque nœud" : ", copie de l'index inutile");
+        }
+        std::cout << "\n";
+    }
+    const std::size_t hugeBytes = IndexMemory::transparentHugeBytes() + IndexMemory::hugeTlbBytes();
+    if (options.hugePages != PagePolicy::Default) {
+        std::cout << "Pages de 2 Mio : " << formatBytes(hugeBytes);
+        if (IndexMemory::hugeTlbFallbacks() > 0) {
+            std::cout << " (" << IndexMemory::hugeTlbFallbacks() << " allocations hugetlbfs refusées, servies en thp)";
+        }
+        std::cout << "\n";
+    }
+
+    if (!stats.isEnabled()) return;
+    stats.setInfo("huge_pages", IndexMemory::name(options.hugePages));
+    stats.setInfo("huge_page_bytes", static_cast<double>(hugeBytes));
+    stats.setInfo("hugetlb_bytes", static_cast<double>(IndexMemory::hugeTlbBytes()));
+    stats.setInfo("hugetlb_fallbacks", static_cast<double>(IndexMemory::hugeTlbFallbacks()));
+    stats.setInfo("numa_placement", NumaTopology::placementName(options.numa));
+    stats.setInfo("numa_nodes", topology.nodeCount());
+    stats.setInfo("index_replicas", copies);
+    if (copies > 0) stats.setInfo("index_bytes", static_cast<double>(mapper.getGenomeIndex().memoryUsage()));
+}
 
 int main(int argc, char* argv[]) {
-    if (argc < 4) {
-        std::cerr << "Usage: " << argv[0] << " <reference.fasta> <reads_directory> <k-mer size>\n";
+    std::string command = argc > 1 ? argv[1] : "";
+    if (command == "serve") {
+        return runServer(argc, argv);
+    }
+    if (command == "index") {
+        return runIndexCommand(argc, argv);
+    }
+    if (command == "client") {
+        if (argc != 3 && argc != 5) {
+            printUsage(std::cerr, argv[0]);
+            return 1;
+        }
+        return argc == 3 ? runMappingClient(argv[2], "", "") : runMappingClient(argv[2], argv[3], argv[4]);
+    }
+
+    RunOptions options;
+    if (!parseOptions(argc, argv, options)) {
         return 1;
     }
 
-    std::string refPath = argv[1];
-    std::string readsDir = argv[2];
-    int k = std::stoi(argv[3]);
+    IndexMemory::setPolicy(options.hugePages);
+
+    std::string refPath = options.reference;
+    std::string readsDir = options.readsDirectory;
+    int k = options.k;
+
+    RunStats& stats = RunStats::instance();
+    if (!options.reportPath.empty()) {
+        stats.setEnabled(true);
+        stats.setInfo("reference", refPath);
+        stats.setInfo("reads_directory", readsDir);
+        if (options.autoK) {
+            stats.setInfo("k", std::string("auto"));
+        } else {
+            stats.setInfo("k", k);
+        }
+    }
 
     Mapper mapper(k);
+    mapper.setPrefilter(options.prefilterBits);
+    mapper.getGenomeIndex().setLayout(options.layout);
 
+    std::unique_ptr<ShardedMapper> shards;
+    std::string genome; // k automatique : la référence n'est indexée qu'une fois les reads chargés
+    std::vector<Contig> contigs;
     std::cout << "Loading reference genome...\n";
-    mapper.loadReference(refPath);
+    if (options.autoK) {
+        if (Mapper::isIndexFile(refPath)) {
+            std::cerr << "Error: k = auto needs a FASTA reference, not a saved index.\n";
+            return 1;
+        }
+        Mapper::parseReference(refPath, genome, contigs);
+    } else if (options.shards > 1) {
+        if (Mapper::isIndexFile(refPath)) {
+            std::cerr << "Error: --shards needs a FASTA reference, not a saved index.\n";
+            return 1;
+        }
+        shards = std::make_unique<ShardedMapper>(k, options.shards);
+        shards->setPrefilter(options.prefilterBits);
+        shards->setLayout(options.layout);
+        if (!shards->loadReference(refPath, options.maxIndexBytes)) {
+            return 1;
+        }
+    } else if (!mapper.loadReference(refPath, options.maxIndexBytes)) {
+        return 1;
+    }
+
+    std::uint64_t inputReads = 0;
+    if (options.sampleSize > 0) {
+        std::cout << "Sampling reads from directory...\n";
+        inputReads = mapper.sampleReadsFromDirectory(readsDir, options.sampleSize, options.sampleSeed);
+        std::cout << "Nombre de reads lus : " << inputReads << ", échantillon : " << mapper.getReads().size() << "\n";
+        if (stats.isEnabled()) {
+            stats.setInfo("sample_size", static_cast<double>(options.sampleSize));
+            stats.setInfo("sample_seed", static_cast<double>(options.sampleSeed));
+            stats.setInfo("sample_input_reads", static_cast<double>(inputReads));
+        }
+    } else {
+        std::cout << "Loading reads from directory...\n";
+        mapper.loadReadsFromDirectory(readsDir);
+        std::cout << "Nombre de reads chargés : " << mapper.getReads().size() << "\n";
+    }
+
+    if (options.filter.enabled()) {
+        ReadFilterReport filterReport = mapper.filterReads(options.filter);
+        filterReport.print(std::cout);
+    }
 
-    std::cout << "Loading reads from directory...\n";
-    mapper.loadReadsFromDirectory(readsDir);
-    std::cout << "Nombre de reads chargés : " << mapper.getReads().size() << "\n";
+    KmerSelector selector;
+    std::unique_ptr<Mapper> secondary;
+    if (options.autoK) {
+        {
+            ScopedStageTimer timer(Stage::KSelection);
+            selector.profileReference(genome);
+            selector.choose(mapper.getReads(), genome);
+        }
+        const KmerPlan& plan = selector.getPlan();
+        if (plan.primary_k == 0) {
+            std::cerr << "Error: Cannot choose a k-mer size: the reference is shorter than the smallest candidate.\n";
+            return 1;
+        }
+        plan.print(std::cout);
+        if (stats.isEnabled()) recordKmerPlan(stats, selector);
 
-    std::cout << "Mapping reads...\n";
-    mapper.mapReads();
+        // Le budget et l'organisation s'appliquent à chaque index
+        if (plan.secondary_k > 0) {
+            secondary = std::make_unique<Mapper>(plan.secondary_k);
+            secondary->setPrefilter(options.prefilterBits);
+            secondary->getGenomeIndex().setLayout(options.layout);
+            if (!secondary->indexReference(genome, contigs, options.maxIndexBytes)) {
+                return 1;
+            }
+            if (stats.isEnabled()) {
+                stats.setInfo("autok_secondary_index_bytes",
+                              static_cast<double>(secondary->getGenomeIndex().memoryUsage()));
+            }
+        }
+        mapper.setK(plan.primary_k);
+        if (!mapper.indexReference(std::move(genome), std::move(contigs), options.maxIndexBytes)) {
+            return 1;
+        }
+    }
+
+    if (!shards) {
+        placeIndexes(stats, options, mapper, secondary.get());
+    }
+
+    std::unique_ptr<ThreadPool> pool;
+    if (options.threads != 1) {
+        pool = std::make_unique<ThreadPool>(options.threads, options.numa != NumaPlacement::Off);
+    }
+    ScreenReport screenReport;
+    if (options.screen.enabled()) {
+        std::cout << "Screening reads...\n";
+        screenReport = mapper.screenReads(options.screen, pool.get());
+        screenReport.print(std::cout);
+        if (stats.isEnabled()) {
+            stats.setInfo("screen_min_hits", options.screen.min_hits);
+            stats.setInfo("screen_max_misses", options.screen.max_misses);
+            stats.setInfo("screen_on_target", static_cast<double>(screenReport.on_target));
+            stats.setInfo("screen_off_target", static_cast<double>(screenReport.off_target));
+            stats.setInfo("screen_kmers_tested", static_cast<double>(screenReport.kmers_tested));
+        }
+    } else {
+        std::cout << "Mapping reads...\n";
+        if (shards) {
+            if (!mapper.mapReadsSharded(*shards)) {
+                return 1;
+            }
+        } else if (secondary) {
+            std::size_t dispatched = mapper.mapReadsDispatched(
+                *secondary, [&selector](const Sequence& read) { return selector.useSecondary(read); }, pool.get());
+            std::cout << "Reads confiés au second index (k = " << secondary->getK() << ") : " << dispatched << "\n";
+            if (stats.isEnabled()) stats.setInfo("autok_secondary_mapped_reads", static_cast<double>(dispatched));
+        } else {
+            mapper.mapReads(pool.get());
+        }
+    }
 
-    std::string outputDir;
-    std::cout << "Veuillez entrer le dossier où enregistrer les résultats : ";
-    std::getline(std::cin, outputDir);
+    std::string outputDir = options.outputDir;
+    if (outputDir.empty()) {
+        std::cout << "Veuillez entrer le dossier où enregistrer les résultats : ";
+        std::getline(std::cin, outputDir);
+    }
 
     // Vérifie si le dossier existe
     if (!std::filesystem::exists(outputDir)) {
@@ -34,14 +271,62 @@ int main(int argc, char* argv[]) {
         return 1;
     }
 
+    if (options.screen.enabled()) {
+        if (!mapper.exportScreenedReads(outputDir, screenReport)) {
+            return 1;
+        }
+        std::cout << "Reads triés exportés dans : " << outputDir << " (on_target, off_target, screen_summary.csv)\n";
+        if (stats.isEnabled() && stats.writeJson(options.reportPath)) {
+            std::cout << "Rapport d'exécution écrit dans : " << options.reportPath << "\n";
+        }
+        return 0;
+    }
+
     // Construit le chemin final du fichier CSV
-    std::string outputPath = outputDir;
-    if (outputPath.back() != '/' && outputPath.back() != '\\')
-        outputPath += "/";
-    outputPath += "mapping_results.csv";
+    std::string outputPrefix = outputDir;
+    if (outputPrefix.back() != '/' && outputPrefix.back() != '\\')
+        outputPrefix += "/";
+    std::string outputPath = outputPrefix + "mapping_results.csv";
+
+    if (options.sampleSize > 0) {
+        // Estimation rapide : seul le résumé est écrit, les lignes de l'échantillon ne représentent pas le run
+        std::string summaryPath = outputPrefix + "qc_summary.csv";
+        if (!mapper.exportSampleSummary(summaryPath, inputReads)) {
+            return 1;
+        }
+        std::cout << "Résumé estimé exporté dans : " << summaryPath << "\n";
+        if (stats.isEnabled() && stats.writeJson(options.reportPath)) {
+            std::cout << "Rapport d'exécution écrit dans : " << options.reportPath << "\n";
+        }
+        return 0;
+    }
 
-    mapper.exportMappingsToCSV(outputPath);
-    std::cout << "Résultats exportés dans : " << outputPath << "\n";
+    if (options.sortMemory > 0) {
+        // Résultats triés par position ; les pistes de couverture sont calculées pendant la fusion
+        CoverageTrack coverage(shards ? shards->getContigs() : mapper.getGenomeIndex().getContigs(),
+                               options.coverageBin);
+        if (!coverage.open(outputPrefix + "coverage.bedgraph", outputPrefix + "coverage_bins.csv") ||
+            !mapper.exportSortedMappingsToCSV(outputPath, options.sortMemory, &coverage) || !coverage.finish()) {
+            return 1;
+        }
+        std::cout << "Résultats triés par position exportés dans : " << outputPath
+                  << " (pistes de couverture : coverage.bedgraph, coverage_bins.csv)\n";
+    } else {
+        mapper.exportMappingsToCSV(outputPath);
+        std::cout << "Résultats exportés dans : " << outputPath << "\n";
+    }
+
+    if (options.pileup.enabled()) {
+        std::string variantsPath = outputPrefix + "variants.csv";
+        if (!mapper.exportVariants(variantsPath, options.pileup, pool.get())) {
+            return 1;
+        }
+        std::cout << "Sites variants exportés dans : " << variantsPath << "\n";
+    }
+
+    if (stats.isEnabled() && stats.writeJson(options.reportPath)) {
+        std::cout << "Rapport d'exécution écrit dans : " << options.reportPath << "\n";
+    }
 
     return 0;
 }
\ No newline at end of file
@@ -0,0 +1,172 @@
+/**
+ * @file map_eval.cpp
+ * @brief Évaluateur de justesse : compare les résultats du mapper à la vérité terrain des reads simulés.
+ *
+ * @code
+ * ./map_eval <mapping_results.csv> [--report <run.json>] [--tolerance <bp>]
+ *            [--min-sensitivity <f>] [--min-precision <f>]
+ * @endcode
+ *
+ * Un read est correctement placé si sa position de départ est à moins de --tolerance paires de bases
+ * (10 par défaut, pour absorber les indels) de sa position d'origine et, si le brin est exporté,
+ * si le brin concorde. La sensibilité est rapportée au nombre de reads simulés présents dans le CSV,
+ * la précision au nombre de reads placés. Le débit (reads/s) est lu dans le rapport JSON de my_program.
+ * Le code de retour est non nul si un seuil minimal n'est pas atteint (suivi des régressions).
+ */
+
+#include "SyntheticGenome.hpp"
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace {
+
+/**
+ * @brief Découpe une ligne CSV simple (sans guillemets)
+ */
+std::vector<std::string> splitCsv(const std::string& line) {
+    std::vector<std::string> fields;
+    std::stringstream stream(line);
+    std::string field;
+    while (std::getline(stream, field, ',')) fields.push_back(field);
+    return fields;
+}
+
+/**
+ * @brief Lit une valeur numérique "clé": valeur dans un rapport JSON, ou -1 si absente
+ */
+double readJsonNumber(const std::string& path, const std::string& key) {
+    std::ifstream in(path);
+    std::stringstream content;
+    content << in.rdbuf();
+    std::string text = content.str();
+    std::size_t pos = text.find("\"" + key + "\"");
+    if (pos == std::string::npos) return -1.0;
+    pos = text.find(':', pos);
+    if (pos == std::string::npos) return -1.0;
+    return std::strtod(text.c_str() + pos + 1, nullptr);
+}
+
+int columnIndex(const std::vector<std::string>& header, const std::string& name) {
+    for (std::size_t i = 0; i < header.size(); ++i) {
+        if (header[i] == name) return static_cast<int>(i);
+    }
+    return -1;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        std::cerr << "Usage: " << argv[0] << " <mapping_results.csv> [--report <run.json>] [--tolerance <bp>]"
+                  << " [--min-sensitivity <f>] [--min-precision <f>]\n";
+        return 1;
+    }
+
+    std::string csvPath = argv[1];
+    std::string reportPath;
+    long tolerance = 10;
+    double minSensitivity = 0.0, minPrecision = 0.0;
+    try {
+        for (int i = 2; i < argc; i += 2) {
+            std::string name = argv[i];
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Missing value for option " << name << "\n";
+                return 1;
+            }
+            std::string value = argv[i + 1];
+            if (name == "--report") reportPath = value;
+            else if (name == "--tolerance") tolerance = std::stol(value);
+            else if (name == "--min-sensitivity") minSensitivity = std::stod(value);
+            else if (name == "--min-precision") minPrecision = std::stod(value);
+            else {
+                std::cerr << "Error: Unknown option " << name << "\n";
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric value.\n";
+        return 1;
+    }
+
+    std::ifstream in(csvPath);
+    if (!in) {
+        std::cerr << "Error: Cannot open file " << csvPath << "\n";
+        return 1;
+    }
+
+    // Les lignes de résumé précèdent l'en-tête "read_id,..."
+    std::string line;
+    std::vector<std::string> header;
+    while (std::getline(in, line)) {
+        if (line.rfind("read_id,", 0) == 0) {
+            header = splitCsv(line);
+            break;
+        }
+    }
+    int idColumn = columnIndex(header, "read_id");
+    int startColumn = columnIndex(header, "start_position");
+    int strandColumn = columnIndex(header, "strand");
+    if (idColumn < 0 || startColumn < 0) {
+        std::cerr << "Error: " << csvPath << " has no read_id/start_position header.\n";
+        return 1;
+    }
+
+    std::size_t total = 0, ignored = 0, mapped = 0, correct = 0, wrongStrand = 0;
+    while (std::getline(in, line)) {
+        if (line.empty()) continue;
+        std::vector<std::string> fields = splitCsv(line);
+        if (static_cast<int>(fields.size()) <= startColumn) continue;
+
+        long truthStart;
+        char truthStrand;
+        if (!parseSimulatedReadName(fields[idColumn], truthStart, truthStrand)) {
+            ignored++;
+            continue;
+        }
+        total++;
+
+        long start = std::strtol(fields[startColumn].c_str(), nullptr, 10);
+        if (start < 0) continue;
+        mapped++;
+
+        bool strandOk = true;
+        if (strandColumn >= 0 && strandColumn < static_cast<int>(fields.size())) {
+            const std::string& strand = fields[strandColumn];
+            strandOk = strand.size() == 1 && strand[0] == truthStrand;
+        }
+        if (std::labs(start - truthStart) <= tolerance) {
+            if (strandOk) correct++;
+            else wrongStrand++;
+        }
+    }
+
+    double sensitivity = total > 0 ? static_cast<double>(correct) / total : 0.0;
+    double precision = mapped > 0 ? static_cast<double>(correct) / mapped : 0.0;
+
+    std::cout << "simulated reads," << total << "\n"
+              << "non-simulated reads ignored," << ignored << "\n"
+              << "mapped reads," << mapped << "\n"
+              << "correctly placed reads," << correct << "\n"
+              << "right position wrong strand," << wrongStrand << "\n"
+              << "sensitivity," << sensitivity << "\n"
+              << "precision," << precision << "\n";
+    if (!reportPath.empty()) {
+        std::cout << "reads per second," << readJsonNumber(reportPath, "reads_per_second") << "\n"
+                  << "peak rss kb," << readJsonNumber(reportPath, "peak_rss_kb") << "\n";
+    }
+
+    int status = 0;
+    if (sensitivity < minSensitivity) {
+        std::cerr << "Error: Sensitivity " << sensitivity << " is below " << minSensitivity << "\n";
+        status = 2;
+    }
+    if (precision < minPrecision) {
+        std::cerr << "Error: Precision " << precision << " is below " << minPrecision << "\n";
+        status = 2;
+    }
+    return status;
+}
@@ -0,0 +1,192 @@
+/**
+ * @file read_sim.cpp
+ * @brief Simulateur de reads avec vérité terrain, pour mesurer la justesse et le débit du mapper.
+ *
+ * @code
+ * ./read_sim <output_dir> (--reference <genome.fasta> | --synthetic <length>) [options]
+ * @endcode
+ *
+ * Les reads sont écrits dans <output_dir>/reads/ (reads.fastq, ou reads_1.fastq et reads_2.fastq en paired-end),
+ * dossier directement utilisable par my_program. Avec --synthetic, le génome généré est écrit dans
+ * <output_dir>/reference.fasta. Les séquences d'un FASTA de référence sont concaténées comme dans
+ * Mapper::loadReference, si bien que les positions encodées dans les noms de reads sont celles du mapper.
+ */
+
+#include "ReadFasta.hpp"
+#include "SyntheticGenome.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+namespace {
+
+void printUsage(const std::string& program) {
+    std::cerr << "Usage: " << program << " <output_dir> (--reference <genome.fasta> | --synthetic <length>) [options]\n"
+              << "Options :\n"
+              << "  --count <n>             nombre de reads (de paires en paired-end), défaut 100000\n"
+              << "  --length <n>            longueur des reads, défaut 100\n"
+              << "  --sub-rate <r>          taux de substitution par base, défaut 0.01\n"
+              << "  --indel-rate <r>        taux d'insertion + délétion par base, défaut 0\n"
+              << "  --quality-model <m>     constant | illumina | random, défaut illumina\n"
+              << "  --reverse-fraction <f>  proportion de reads sur le brin inverse, défaut 0.5\n"
+              << "  --paired                paires de reads (orientation FR)\n"
+              << "  --fragment-mean <n>     taille moyenne des fragments, défaut 300\n"
+              << "  --fragment-sd <n>       écart-type de la taille des fragments, défaut 30\n"
+              << "  --fasta                 écrit des reads FASTA plutôt que FASTQ\n"
+              << "  --gc <f>                taux de GC du génome synthétique, défaut 0.5\n"
+              << "  --repeat-fraction <f>   fraction répétée du génome synthétique, défaut 0\n"
+              << "  --seed <n>              graine, défaut 1\n";
+}
+
+/**
+ * @brief Écrit des reads au format FASTQ (ou FASTA s'ils n'ont pas de qualité)
+ */
+bool writeReads(const std::string& path, const std::vector<Sequence>& reads) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open output file " << path << "\n";
+        return false;
+    }
+    for (const auto& read : reads) {
+        read.write(out);
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Error: Cannot write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Écrit le génome synthétique au format FASTA (80 bases par ligne)
+ */
+bool writeReference(const std::string& path, const std::string& genome, std::uint64_t seed) {
+    std::ofstream out(path);
+    if (!out.is_open()) {
+        std::cerr << "Error: Cannot open output file " << path << "\n";
+        return false;
+    }
+    out << ">synthetic length=" << genome.length() << " seed=" << seed << "\n";
+    for (std::size_t i = 0; i < genome.length(); i += 80) {
+        out << genome.substr(i, 80) << "\n";
+    }
+    out.close();
+    if (!out) {
+        std::cerr << "Error: Cannot write " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if (argc < 2) {
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::string outputDir = argv[1];
+    std::string referencePath;
+    std::size_t syntheticLength = 0;
+    bool paired = false;
+    GenomeParams genomeParams;
+    ReadSimParams readParams;
+    readParams.count = 100000;
+    readParams.error_rate = 0.01;
+    readParams.quality_model = QualityModel::Illumina;
+    readParams.seed = 1;
+
+    try {
+        for (int i = 2; i < argc; ++i) {
+            std::string name = argv[i];
+            if (name == "--paired") { paired = true; continue; }
+            if (name == "--fasta") { readParams.with_quality = false; continue; }
+            if (i + 1 >= argc) {
+                std::cerr << "Error: Missing value for option " << name << "\n";
+                return 1;
+            }
+            std::string value = argv[++i];
+
+            if (name == "--reference") referencePath = value;
+            else if (name == "--synthetic") syntheticLength = std::stoull(value);
+            else if (name == "--count") readParams.count = std::stoull(value);
+            else if (name == "--length") readParams.length = std::stoi(value);
+            else if (name == "--sub-rate") readParams.error_rate = std::stod(value);
+            else if (name == "--indel-rate") readParams.indel_rate = std::stod(value);
+            else if (name == "--reverse-fraction") readParams.reverse_fraction = std::stod(value);
+            else if (name == "--fragment-mean") readParams.fragment_mean = std::stoi(value);
+            else if (name == "--fragment-sd") readParams.fragment_sd = std::stoi(value);
+            else if (name == "--gc") genomeParams.gc_content = std::stod(value);
+            else if (name == "--repeat-fraction") genomeParams.repeat_fraction = std::stod(value);
+            else if (name == "--seed") readParams.seed = std::stoull(value);
+            else if (name == "--quality-model") {
+                if (!parseQualityModel(value, readParams.quality_model)) {
+                    std::cerr << "Error: Unknown quality model " << value << "\n";
+                    return 1;
+                }
+            } else {
+                std::cerr << "Error: Unknown option " << name << "\n";
+                printUsage(argv[0]);
+                return 1;
+            }
+        }
+    } catch (const std::exception&) {
+        std::cerr << "Error: Invalid numeric value.\n";
+        return 1;
+    }
+
+    if (referencePath.empty() == (syntheticLength == 0)) {
+        std::cerr << "Error: Exactly one of --reference or --synthetic is required.\n";
+        printUsage(argv[0]);
+        return 1;
+    }
+
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(outputDir) / "reads", error);
+    if (error) {
+        std::cerr << "Error: Cannot create directory " << outputDir << "/reads: " << error.message() << "\n";
+        return 1;
+    }
+
+    std::string genome;
+    if (!referencePath.empty()) {
+        ReadFasta reader(referencePath);
+        reader.load();
+        for (const auto& seq : reader.getSequences()) {
+            genome += seq.getSequence();
+        }
+    } else {
+        genomeParams.length = syntheticLength;
+        genomeParams.seed = readParams.seed;
+        genome = generateGenome(genomeParams);
+        std::string path = (std::filesystem::path(outputDir) / "reference.fasta").string();
+        if (!writeReference(path, genome, genomeParams.seed)) return 1;
+        std::cout << "Génome synthétique écrit dans : " << path << "\n";
+    }
+
+    if (genome.length() < static_cast<std::size_t>(readParams.length)) {
+        std::cerr << "Error: Reference is shorter than the read length.\n";
+        return 1;
+    }
+
+    std::string extension = readParams.with_quality ? ".fastq" : ".fasta";
+    std::filesystem::path readsDir = std::filesystem::path(outputDir) / "reads";
+    if (paired) {
+        std::vector<Sequence> mates1, mates2;
+        samplePairedReads(genome, readParams, mates1, mates2);
+        if (!writeReads((readsDir / ("reads_1" + extension)).string(), mates1) ||
+            !writeReads((readsDir / ("reads_2" + extension)).string(), mates2)) {
+            return 1;
+        }
+        std::cout << mates1.size() << " paires de reads écrites dans : " << readsDir.string() << "\n";
+    } else {
+        std::vector<Sequence> reads = sampleReads(genome, readParams);
+        if (!writeReads((readsDir / ("reads" + extension)).string(), reads)) {
+            return 1;
+        }
+        std::cout << reads.size() << " reads écrits dans : " << readsDir.string() << "\n";
+    }
+    return 0;
+}